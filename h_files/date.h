@@ -1,6 +1,11 @@
 /**
  * \file date.h
- * Módulo que descreve como criar e manipular uma data
+ * Módulo que descreve como criar e manipular uma data<BR>
+ * Todas as funções são reentrantes: não usam localtime(), mktime() nem
+ * buffers globais, e o estado que mantêm fica no objeto Date ou em memória
+ * fornecida por quem chama. Threads diferentes podem usar a API ao mesmo
+ * tempo desde que não usem o mesmo objeto Date simultaneamente (as leituras
+ * memorizam os componentes decompostos dentro do objeto)
  */
 
 #ifndef DATE_H_
@@ -11,6 +16,10 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include "dateCivil.h"
+#include "dateZone.h"
+#include "dateClock.h"
 
 /**
  * Enumerador das partes de uma data
@@ -54,9 +63,51 @@ enum WeekComponent{
     SATURDAY ///< sábado
 };
 
+/**
+ * Enumerador do que fazer quando o dia do mês não existe no mês de destino
+ * (por exemplo, 31/01 mais um mês)
+ */
+enum MonthOverflow{
+    MONTH_CLAMP, ///< usa o último dia do mês (31/01 + 1 mês = 28/02 ou 29/02)
+    MONTH_OVERFLOW ///< passa para o mês seguinte (31/01 + 1 mês = 03/03 ou 02/03)
+};
+
+/**
+ * Enumerador da origem da memória de um objeto Date
+ */
+enum DateStorage{
+    DATE_STORAGE_INLINE, ///< memória do chamador (pilha, vetor, outra estrutura)
+    DATE_STORAGE_HEAP, ///< alocado por createDate()
+    DATE_STORAGE_POOL ///< alocado por um DatePool (veja datePool.h)
+};
+
+/**
+ * Estrutura do objeto data
+ * Armazena data e hora, e memoriza os componentes da data (dia, mês, ano ...)
+ * calculados no primeiro acesso<BR>
+ * A estrutura é pública para que o objeto possa ficar na pilha ou dentro de
+ * outras estruturas (veja initDate()), mas os campos devem ser acessados
+ * somente pelas funções deste módulo. Ela ocupa 64 bytes: o que só interessa
+ * aos objetos de um DatePool fica na memória do pool (veja datePool.c).
+ * Uma cópia por atribuição leva junto a origem da memória (storage), e
+ * destroyDate() não deve ser chamada para ela; para copiar uma data para
+ * outro objeto, use copyDate()
+ */
+struct date{
+    time_t data; ///< data em segundos desde 1970
+    const TimeZone* zone; ///< fuso usado nas conversões (NULL para o fuso local)
+    union{
+        CivilTime civil; ///< componentes da data (válidos se decomposed for true)
+        struct date* nextFree; ///< próximo objeto livre do pool (só enquanto livre)
+    };
+    int32_t nanoseconds; ///< fração de segundo lida por setDateToday() (0 nos demais casos)
+    int32_t offset; ///< deslocamento em relação ao UTC usado na decomposição
+    bool decomposed; ///< se civil e offset correspondem a data
+    unsigned char storage; ///< origem da memória (enum DateStorage)
+};
+
 /**
  * Estrutura do objeto data
- * Armazena data e hora
  */
 typedef struct date Date;
 
@@ -68,14 +119,66 @@ typedef struct date Date;
 Date* createDate();
 
 /**
- * Desaloca objeto Date
+ * Desaloca objeto Date<BR>
+ * Objetos criados por um DatePool voltam para o pool, e objetos guardados em
+ * memória do chamador (initDate(), createDateArray()) não são liberados. Não
+ * deve ser chamada para uma cópia feita por atribuição (veja copyDate())
  * \return NULL
  * \param date Ponteiro para objeto Date a ser desalocado
  */
 Date* destroyDate(Date* date);
 
 /**
- * Configura a data para a data atual
+ * Inicializa um objeto Date guardado em memória do chamador (pilha, vetor ou
+ * dentro de outra estrutura)<BR>
+ * Não lê o relógio: a data inicial é 1/1/1970 00:00:00 UTC, no fuso local.
+ * Chamar destroyDate() para esse objeto não libera memória
+ * \param date Ponteiro para o objeto a ser inicializado
+ */
+void initDate(Date* date);
+
+/**
+ * Inicializa um objeto Date guardado em memória do chamador com uma data
+ * \return false se os segundos forem negativos (a data fica em 1/1/1970)
+ * \param date Ponteiro para o objeto a ser inicializado
+ * \param seconds Segundos desde 1970
+ */
+bool initDateOfSeconds(Date* date, time_t seconds);
+
+/**
+ * Copia a data, o fuso e os componentes memorizados de um objeto Date para
+ * outro<BR>
+ * O destino mantém a origem da sua memória, de modo que destroyDate()
+ * continua valendo para ele. Use esta função em vez de atribuição direta
+ * (*to = *from), que leva junto a origem da memória de from
+ * \param to Ponteiro para o objeto de destino (já inicializado por
+ *      createDate(), initDate(), createDateArray() ou createPoolDate())
+ * \param from Ponteiro para o objeto de origem
+ */
+void copyDate(Date* to, const Date* from);
+
+/**
+ * Cria um vetor contíguo de objetos Date, com uma única alocação<BR>
+ * Os objetos são inicializados como em initDate(). Chamar destroyDate() para
+ * um elemento não libera memória; o vetor inteiro é liberado por
+ * destroyDateArray()
+ * \return Ponteiro para o primeiro objeto, ou NULL se não conseguir
+ * \param count Quantidade de objetos
+ */
+Date* createDateArray(size_t count);
+
+/**
+ * Desaloca um vetor criado por createDateArray()
+ * \return NULL
+ * \param dates Ponteiro para o primeiro objeto do vetor
+ */
+Date* destroyDateArray(Date* dates);
+
+/**
+ * Configura a data para a data atual<BR>
+ * A data é lida na fonte escolhida por setDateClock() (veja dateClock.h); com
+ * qualquer fonte exceto DATE_CLOCK_TIME a fração de segundo também é
+ * guardada (veja getDateNanoseconds())
  * \param date Ponteiro para objeto Date a ter a data configurada
  */
 void setDateToday(Date** date);
@@ -104,6 +207,76 @@ bool setDatePartial(Date** date, int day, int month, int year);
 bool setDateComplete(Date** date, int day, int month, int year,
         int hour, int minute, int second);
 
+#if defined(DATE_INLINE_ACCESSORS) && !defined(DATE_LIBRARY_SOURCE)
+
+/*
+ * Com DATE_INLINE_ACCESSORS definido antes de incluir este header, os acessos
+ * triviais abaixo são expandidos no código de quem chama, sem uma chamada de
+ * função. A biblioteca continua exportando as versões normais, e o
+ * comportamento é o mesmo (exceto que estes acessos não entram nas
+ * estatísticas de dateStats.h)
+ */
+
+/**
+ * Define a data dos segundos a partir de 1900
+ * \return true se conseguir, e false caso contrário
+ * \param date Ponteiro para objeto Date a ter a data configurada
+ * \param seconds Segundos desde 1900
+ */
+static inline bool setDateOfSeconds(Date** date, time_t seconds){
+    if(seconds < 0)
+        return false;
+
+    (*date)->data = seconds;
+    (*date)->nanoseconds = 0;
+    (*date)->decomposed = false;
+    return true;
+}
+
+/**
+ * Retorna a data em segundos desde 1900
+ * \return Segundos desde 1900
+ * \param date Ponteiro para objeto Date
+ */
+static inline time_t getDateInSeconds(Date** date){
+    return (*date)->data;
+}
+
+/**
+ * Retorna a fração de segundo da data<BR>
+ * Somente setDateToday() guarda a fração; as demais funções que mudam a data
+ * a zeram
+ * \return Nanossegundos (0 - 999999999)
+ * \param date Ponteiro para objeto Date
+ */
+static inline long getDateNanoseconds(Date** date){
+    return (*date)->nanoseconds;
+}
+
+/**
+ * Define o fuso horário usado nas conversões da data<BR>
+ * O instante guardado não muda, somente a forma como ele é decomposto
+ * (dia, hora ...) e como os componentes são convertidos de volta. O fuso
+ * deve continuar carregado enquanto o objeto Date o utilizar
+ * \param date Ponteiro para objeto Date
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ */
+static inline void setDateTimeZone(Date** date, const TimeZone* zone){
+    (*date)->zone = zone;
+    (*date)->decomposed = false;
+}
+
+/**
+ * Retorna o fuso horário usado nas conversões da data
+ * \return Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param date Ponteiro para objeto Date
+ */
+static inline const TimeZone* getDateTimeZone(Date** date){
+    return (*date)->zone;
+}
+
+#else
+
 /**
  * Define a data dos segundos a partir de 1900
  * \return true se conseguir, e false caso contrário
@@ -119,6 +292,34 @@ bool setDateOfSeconds(Date** date, time_t seconds);
  */
 time_t getDateInSeconds(Date** date);
 
+/**
+ * Retorna a fração de segundo da data<BR>
+ * Somente setDateToday() guarda a fração; as demais funções que mudam a data
+ * a zeram
+ * \return Nanossegundos (0 - 999999999)
+ * \param date Ponteiro para objeto Date
+ */
+long getDateNanoseconds(Date** date);
+
+/**
+ * Define o fuso horário usado nas conversões da data<BR>
+ * O instante guardado não muda, somente a forma como ele é decomposto
+ * (dia, hora ...) e como os componentes são convertidos de volta. O fuso
+ * deve continuar carregado enquanto o objeto Date o utilizar
+ * \param date Ponteiro para objeto Date
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ */
+void setDateTimeZone(Date** date, const TimeZone* zone);
+
+/**
+ * Retorna o fuso horário usado nas conversões da data
+ * \return Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param date Ponteiro para objeto Date
+ */
+const TimeZone* getDateTimeZone(Date** date);
+
+#endif /* DATE_INLINE_ACCESSORS */
+
 /**
  * Retorna um componente da data (dia, mês, ano, hora ...)
  * \return -1 se, por algum motivo, não conseguir retorna o solicitado<BR>
@@ -136,11 +337,19 @@ time_t getDateInSeconds(Date** date);
  */
 int getDateComponent(Date** date, enum DateComponent dateComponent);
 
+/**
+ * Retorna todos os componentes da data de uma vez
+ * \param date Ponteiro para objeto Date
+ * \param civil Ponteiro para a estrutura a ser preenchida (veja dateCivil.h)
+ */
+void getDateCivilTime(Date** date, CivilTime* civil);
+
 /**
  * Gera uma string e guarda o resultado na memória onde o ponteiro fornecido
  * aponta<BR>
  * Obs: para char = 1byte, considere que a área de memória para onde o ponteiro
- * da string literal aponta tenha pelo menos 40 bytes.
+ * da string literal aponta tenha pelo menos 40 bytes. Para informar a
+ * capacidade explicitamente, use formatDate() (veja dateFormat.h).
  * \return false se não conseguir, true em caso contrário
  * \param date Ponteiro para objeto Date
  * \param dateString Enumerador que indica qual o formato da string
@@ -167,6 +376,7 @@ bool getStringWeekDay(Date** date, char* stringComp);
  * anos que resulte em um ano não bissexto, o resultado será em uma data diferente de 29 de
  * fevereiro. O mesmo acontece quando adicionamos meses e estamos no dia 31 (afinal, nem todos os
  * meses possuem 31 dias) ou mesmo 30 e caímos em fevereiro (que tem 28/29 dias).
+ * Para escolher o comportamento nesses casos, use addMonthsDate() ou addYearsDate().
  * \return false se não conseguir, e true em caso contrário
  * \param date Ponteiro para o objeto Date
  * \param dateComponent Enumerador que indica a parte da data
@@ -176,6 +386,66 @@ bool getStringWeekDay(Date** date, char* stringComp);
  */
 bool addComponentDate(Date** date, enum DateComponent dateComponent, int value, bool add);
 
+/**
+ * Adiciona (ou subtrai) dias à data, mantendo o horário local<BR>
+ * Usa aritmética de calendário (tempo constante), sem mktime()
+ * \return false se o resultado sair da faixa suportada (a data não muda)
+ * \param date Ponteiro para o objeto Date
+ * \param days Quantidade de dias (negativa para subtrair)
+ */
+bool addDaysDate(Date** date, long long days);
+
+/**
+ * Adiciona (ou subtrai) meses à data, mantendo o horário local<BR>
+ * Usa aritmética de calendário (tempo constante), sem mktime()
+ * \return false se o resultado sair da faixa suportada (a data não muda)
+ * \param date Ponteiro para o objeto Date
+ * \param months Quantidade de meses (negativa para subtrair)
+ * \param overflow O que fazer quando o dia não existe no mês de destino
+ */
+bool addMonthsDate(Date** date, long long months, enum MonthOverflow overflow);
+
+/**
+ * Adiciona (ou subtrai) anos à data, mantendo o horário local<BR>
+ * O 29 de fevereiro segue a regra de overflow (28/02 ou 01/03 em anos não
+ * bissextos)
+ * \return false se o resultado sair da faixa suportada (a data não muda)
+ * \param date Ponteiro para o objeto Date
+ * \param years Quantidade de anos (negativa para subtrair)
+ * \param overflow O que fazer quando o dia não existe no mês de destino
+ */
+bool addYearsDate(Date** date, long long years, enum MonthOverflow overflow);
+
+/**
+ * Retorna a quantidade de dias inteiros entre duas datas<BR>
+ * Compara as datas e os horários locais (cada data no seu fuso): de 10/03
+ * 15:00 a 12/03 14:00 há 1 dia inteiro
+ * \return Dias inteiros (negativo se to for anterior a from)
+ * \param from Ponteiro para o objeto Date inicial
+ * \param to Ponteiro para o objeto Date final
+ */
+long long diffDaysDate(Date** from, Date** to);
+
+/**
+ * Retorna a quantidade de meses inteiros entre duas datas<BR>
+ * Um mês está completo quando o mesmo dia e horário são alcançados no mês
+ * final, ou o fim desse mês quando ele não tem o dia inicial (de 31/01 a
+ * 28/02 há 1 mês), o que corresponde a addMonthsDate() com MONTH_CLAMP
+ * \return Meses inteiros (negativo se to for anterior a from)
+ * \param from Ponteiro para o objeto Date inicial
+ * \param to Ponteiro para o objeto Date final
+ */
+long long diffMonthsDate(Date** from, Date** to);
+
+/**
+ * Retorna a quantidade de anos inteiros entre duas datas (veja
+ * diffMonthsDate())
+ * \return Anos inteiros (negativo se to for anterior a from)
+ * \param from Ponteiro para o objeto Date inicial
+ * \param to Ponteiro para o objeto Date final
+ */
+long long diffYearsDate(Date** from, Date** to);
+
 /**
  * Imprime no prompt a data em um formato pré-especificado
  * \param date Ponteiro para objeto Date
@@ -192,7 +462,9 @@ void printDate(Date** date, enum DateString dateString, bool weekDayName);
 void printWeekDate(Date** date);
 
 /**
- * Verifica se uma data é válida
+ * Verifica se uma data é válida no calendário gregoriano<BR>
+ * Para validar muitas datas de uma vez, use validateDatesBatch() (veja
+ * dateBatch.h)
  * \return false em caso negativo
  * \param day Dia
  * \param month Mês
@@ -203,4 +475,17 @@ void printWeekDate(Date** date);
  */
 bool validateDate(int day,int month,int year,int hour,int minute,int second);
 
+/*
+ * Uso interno da biblioteca
+ */
+
+/**
+ * Guarda uma nova data no objeto, descartando os componentes memorizados<BR>
+ * Ao contrário de setDateOfSeconds(), aceita segundos negativos, como
+ * setDateComplete(); usada pelos módulos que decodificam datas já validadas
+ * \param date Ponteiro para objeto Date
+ * \param data Data em segundos desde 1970
+ */
+void storeDate(Date** date, time_t data);
+
 #endif /* DATE_H_ */
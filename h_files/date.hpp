@@ -0,0 +1,597 @@
+/**
+ * \file date.hpp
+ * Interface C++ da biblioteca (C++17)<BR>
+ * Traz um tipo de valor (dateC::Date) sobre o objeto Date de date.h, as
+ * conversões de calendário e a validação como funções constexpr, e
+ * formatadores em que o formato (enum DateString) é um parâmetro do template:
+ * o formato é escolhido na compilação, sem os switch da versão em C, e datas
+ * constantes podem ser formatadas inteiramente na compilação
+ */
+
+#ifndef DATE_HPP_
+#define DATE_HPP_
+
+#if __cplusplus < 201703L
+#error "date.hpp precisa de C++17"
+#endif
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+extern "C" {
+#include "date.h"
+#include "dateFormat.h"
+}
+
+namespace dateC {
+
+/******************************************************************************
+ * Calendário (constexpr)
+ ******************************************************************************/
+
+/**
+ * Dias em um ciclo gregoriano de 400 anos
+ */
+constexpr long long DAYS_PER_ERA = 146097;
+
+/**
+ * Dias entre 1/3/0000 e 1/1/1970
+ */
+constexpr long long EPOCH_SHIFT = 719468;
+
+/**
+ * Divisão inteira com arredondamento para baixo (também para negativos)
+ * \return Quociente arredondado para menos infinito
+ * \param value Dividendo
+ * \param divisor Divisor (positivo)
+ */
+constexpr long long floorDiv(long long value, long long divisor) noexcept {
+    return value / divisor - ((value % divisor) < 0);
+}
+
+/**
+ * Verifica se um ano é bissexto (regra gregoriana completa)
+ * \return true se o ano for bissexto
+ * \param year Ano
+ */
+constexpr bool isLeapYear(int year) noexcept {
+    return (year % 4 == 0) && (year % 100 != 0 || year % 400 == 0);
+}
+
+/**
+ * Retorna a quantidade de dias de um mês
+ * \return Dias do mês (28 - 31)
+ * \param year Ano
+ * \param month Mês (1 - 12)
+ */
+constexpr int daysInMonth(int year, int month) noexcept {
+    // fevereiro é o único mês que depende do ano
+    if(month == 2)
+        return isLeapYear(year) ? 29 : 28;
+    // abril, junho, setembro e novembro têm 30 dias
+    return 30 + ((month + (month >> 3)) & 1);
+}
+
+/**
+ * Converte uma data civil em dias desde 1/1/1970
+ * \return Dias desde 1/1/1970 (negativo para datas anteriores)
+ * \param year Ano
+ * \param month Mês (1 - 12)
+ * \param day Dia do mês (1 - 31)
+ */
+constexpr long long daysFromCivil(int year, int month, int day) noexcept {
+    // o ano começa em março, assim o dia bissexto fica no fim do ano
+    long long y = static_cast<long long>(year) - (month <= 2);
+    long long era = floorDiv(y, 400);
+    long long yearOfEra = y - era * 400;
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * DAYS_PER_ERA + dayOfEra - EPOCH_SHIFT;
+}
+
+/**
+ * Retorna o dia da semana de um dia desde 1/1/1970
+ * \return Dia da semana (0: domingo, 6: sábado)
+ * \param days Dias desde 1/1/1970
+ */
+constexpr int weekDayFromDays(long long days) noexcept {
+    // 1/1/1970 foi uma quinta-feira
+    return static_cast<int>(((days % 7) + 11) % 7);
+}
+
+/**
+ * Decompõe segundos (já ajustados para o fuso desejado) em componentes
+ * \return Componentes da data (veja dateCivil.h)
+ * \param seconds Segundos desde 1/1/1970 00:00:00 no fuso desejado
+ */
+constexpr CivilTime civilTimeFromSeconds(long long seconds) noexcept {
+    long long days = floorDiv(seconds, SECONDS_PER_DAY);
+    int secondOfDay = static_cast<int>(seconds - days * SECONDS_PER_DAY);
+    long long z = days + EPOCH_SHIFT;
+    long long era = floorDiv(z, DAYS_PER_ERA);
+    long long dayOfEra = z - era * DAYS_PER_ERA;
+    long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524
+            - dayOfEra / 146096) / 365;
+    long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    long long monthIndex = (5 * dayOfYear + 2) / 153;
+    CivilTime civil{};
+
+    civil.mday = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    civil.month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    civil.year = static_cast<int>(yearOfEra + era * 400 + (civil.month <= 2));
+    civil.yday = static_cast<int>(days - daysFromCivil(civil.year, 1, 1));
+    civil.wday = weekDayFromDays(days);
+    civil.hour = secondOfDay / 3600;
+    civil.minute = (secondOfDay / 60) % 60;
+    civil.second = secondOfDay % 60;
+    return civil;
+}
+
+/**
+ * Compõe segundos desde 1/1/1970 a partir dos componentes da data<BR>
+ * Componentes fora do intervalo são normalizados (como em mktime())
+ * \return Segundos desde 1/1/1970 00:00:00 no mesmo fuso dos componentes
+ * \param day Dia do mês
+ * \param month Mês
+ * \param year Ano
+ * \param hour Hora
+ * \param minute Minuto
+ * \param second Segundo
+ */
+constexpr long long secondsFromCivil(int day, int month, int year,
+        int hour = 0, int minute = 0, int second = 0) noexcept {
+    // normaliza o mês, levando o excesso para o ano
+    long long monthIndex = static_cast<long long>(month) - 1;
+    long long yearShift = floorDiv(monthIndex, 12);
+    int normalizedYear = static_cast<int>(year + yearShift);
+    int normalizedMonth = static_cast<int>(monthIndex - yearShift * 12) + 1;
+
+    // dias excedentes são somados a partir do primeiro dia do mês
+    long long days = daysFromCivil(normalizedYear, normalizedMonth, 1) + day - 1;
+
+    return days * SECONDS_PER_DAY + static_cast<long long>(hour) * 3600
+            + static_cast<long long>(minute) * 60 + second;
+}
+
+/**
+ * Verifica se uma data é válida no calendário gregoriano (as mesmas regras de
+ * validateDate())
+ * \return false em caso negativo
+ * \param day Dia
+ * \param month Mês
+ * \param year Ano
+ * \param hour Hora
+ * \param minute Minuto
+ * \param second Segundo
+ */
+constexpr bool validateDate(int day, int month, int year,
+        int hour = 0, int minute = 0, int second = 0) noexcept {
+    return second >= 0 && second <= 59 && minute >= 0 && minute <= 59
+            && hour >= 0 && hour <= 23 && month >= 1 && month <= 12
+            && day >= 1 && day <= daysInMonth(year, month);
+}
+
+/******************************************************************************
+ * Formatação com o formato escolhido na compilação
+ ******************************************************************************/
+
+/**
+ * Texto formatado de tamanho fixo, que pode ser gerado na compilação
+ */
+struct DateText {
+    char text[DATE_STRING_SIZE] = {}; ///< texto, sempre terminado com '\0'
+    std::size_t length = 0; ///< quantidade de caracteres (sem o '\0')
+
+    /**
+     * Retorna o texto
+     * \return Visão do texto
+     */
+    constexpr std::string_view view() const noexcept {
+        return std::string_view(text, length);
+    }
+};
+
+/**
+ * Formatador de um formato de enum DateString, escolhido na compilação<BR>
+ * O texto gerado é o mesmo de getStringDate()
+ */
+template<enum DateString Layout>
+struct DateFormatter {
+    static_assert(Layout >= DATE_DMY && Layout <= DATE_YMD_HMS_AMPM, "formato inválido");
+
+    /**
+     * Se o formato tem dia, mês e ano
+     */
+    static constexpr bool HAS_CALENDAR = Layout != DATE_HMS && Layout != DATE_HMS_AMPM;
+
+    /**
+     * Se o formato tem horário
+     */
+    static constexpr bool HAS_CLOCK = Layout != DATE_DMY && Layout != DATE_YMD;
+
+    /**
+     * Se o ano vem antes do dia
+     */
+    static constexpr bool YEAR_FIRST = Layout == DATE_YMD || Layout == DATE_YMD_HMS
+            || Layout == DATE_YMD_HMS_AMPM;
+
+    /**
+     * Se o horário está no formato am/pm
+     */
+    static constexpr bool AMPM = Layout == DATE_HMS_AMPM || Layout == DATE_DMY_HMS_AMPM
+            || Layout == DATE_YMD_HMS_AMPM;
+
+    /**
+     * Formata componentes de data
+     * \return Texto formatado
+     * \param civil Componentes da data (veja dateCivil.h)
+     * \param weekDayName Se o nome do dia da semana deve constar no final
+     */
+    static constexpr DateText format(const CivilTime& civil, bool weekDayName = false) noexcept {
+        DateText out;
+        std::size_t& length = out.length;
+
+        if constexpr(HAS_CALENDAR){
+            if constexpr(YEAR_FIRST){
+                length += writeNumber(out.text + length, civil.year);
+                out.text[length++] = '/';
+                length += writeNumber(out.text + length, civil.month);
+                out.text[length++] = '/';
+                length += writeNumber(out.text + length, civil.mday);
+            }
+            else{
+                length += writeNumber(out.text + length, civil.mday);
+                out.text[length++] = '/';
+                length += writeNumber(out.text + length, civil.month);
+                out.text[length++] = '/';
+                length += writeNumber(out.text + length, civil.year);
+            }
+        }
+
+        if constexpr(HAS_CALENDAR && HAS_CLOCK)
+            out.text[length++] = ' ';
+
+        if constexpr(HAS_CLOCK){
+            int hour = civil.hour;
+            if constexpr(AMPM)
+                hour = (hour == 0) ? 12 : (hour > 12 ? hour - 12 : hour);
+
+            length += writeNumber(out.text + length, hour);
+            out.text[length++] = ':';
+            length += writeNumber(out.text + length, civil.minute);
+            out.text[length++] = ':';
+            length += writeNumber(out.text + length, civil.second);
+
+            if constexpr(AMPM){
+                out.text[length++] = ' ';
+                out.text[length++] = (civil.hour < 12) ? 'A' : 'P';
+                out.text[length++] = 'M';
+            }
+        }
+
+        if(weekDayName && civil.wday >= SUNDAY && civil.wday <= SATURDAY){
+            std::string_view name = weekDayNameOf(civil.wday);
+            out.text[length++] = ' ';
+            for(char character : name)
+                out.text[length++] = character;
+        }
+
+        out.text[length] = '\0';
+        return out;
+    }
+
+    /**
+     * Formata uma data em segundos desde 1970 já ajustada para o fuso desejado
+     * \return Texto formatado
+     * \param localSeconds Segundos desde 1/1/1970 00:00:00 no fuso desejado
+     * \param weekDayName Se o nome do dia da semana deve constar no final
+     */
+    static constexpr DateText format(long long localSeconds, bool weekDayName = false) noexcept {
+        return format(civilTimeFromSeconds(localSeconds), weekDayName);
+    }
+
+private:
+    /**
+     * Escreve um número inteiro sem zeros à esquerda
+     * \return Quantidade de caracteres escritos
+     * \param out Memória onde o número será escrito (pelo menos 11 bytes)
+     * \param value Número
+     */
+    static constexpr std::size_t writeNumber(char* out, int value) noexcept {
+        char digits[12] = {};
+        std::size_t count = 0;
+        std::size_t length = 0;
+        unsigned int magnitude = (value < 0) ? 0u - static_cast<unsigned int>(value)
+                : static_cast<unsigned int>(value);
+
+        // escreve de trás para frente
+        do{
+            digits[count++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        }while(magnitude > 0);
+
+        if(value < 0)
+            out[length++] = '-';
+        while(count > 0)
+            out[length++] = digits[--count];
+
+        return length;
+    }
+
+    /**
+     * Retorna o nome de um dia da semana
+     * \return Nome do dia
+     * \param weekDay Dia da semana (0: domingo, 6: sábado)
+     */
+    static constexpr std::string_view weekDayNameOf(int weekDay) noexcept {
+        constexpr std::string_view NAMES[7] = {
+            "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
+        };
+        return NAMES[weekDay];
+    }
+};
+
+/******************************************************************************
+ * Tipo de valor
+ ******************************************************************************/
+
+/**
+ * Data como tipo de valor<BR>
+ * Guarda um objeto Date de date.h por valor (sem alocação) e pode ser
+ * copiada livremente. Assim como em C, um mesmo objeto não deve ser usado
+ * por duas threads ao mesmo tempo, porque as leituras memorizam os
+ * componentes decompostos
+ */
+class Date {
+public:
+    /**
+     * Cria a data 1/1/1970 00:00:00 UTC no fuso local (não lê o relógio)
+     */
+    Date() noexcept {
+        initDate(&date);
+    }
+
+    /**
+     * Cria uma data a partir de segundos desde 1970
+     * \param seconds Segundos desde 1970 (negativos resultam em 1/1/1970)
+     * \param zone Fuso usado nas conversões (NULL para o fuso local)
+     */
+    explicit Date(time_t seconds, const TimeZone* zone = nullptr) noexcept {
+        initDateOfSeconds(&date, seconds);
+        setTimeZone(zone);
+    }
+
+    /**
+     * Cria uma data com a data atual (veja dateClock.h)
+     * \return Data atual
+     * \param zone Fuso usado nas conversões (NULL para o fuso local)
+     */
+    static Date now(const TimeZone* zone = nullptr) noexcept {
+        Date today;
+        today.setTimeZone(zone);
+        ::setDateToday(today.handle());
+        return today;
+    }
+
+    /**
+     * Cria uma data a partir dos componentes
+     * \return Data, ou std::nullopt se a data não for válida
+     * \param day Dia do mês
+     * \param month Mês
+     * \param year Ano
+     * \param hour Hora
+     * \param minute Minuto
+     * \param second Segundo
+     * \param zone Fuso dos componentes (NULL para o fuso local)
+     */
+    static std::optional<Date> fromCivil(int day, int month, int year, int hour = 0,
+            int minute = 0, int second = 0, const TimeZone* zone = nullptr) noexcept {
+        Date result;
+        result.setTimeZone(zone);
+        if(!::setDateComplete(result.handle(), day, month, year, hour, minute, second))
+            return std::nullopt;
+        return result;
+    }
+
+    /**
+     * Retorna a data em segundos desde 1970
+     * \return Segundos desde 1970
+     */
+    time_t seconds() const noexcept {
+        return date.data;
+    }
+
+    /**
+     * Retorna a fração de segundo guardada por now()
+     * \return Nanossegundos
+     */
+    long nanoseconds() const noexcept {
+        return date.nanoseconds;
+    }
+
+    /**
+     * Define o fuso horário usado nas conversões
+     * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+     */
+    void setTimeZone(const TimeZone* zone) noexcept {
+        ::setDateTimeZone(handle(), zone);
+    }
+
+    /**
+     * Retorna o fuso horário usado nas conversões
+     * \return Ponteiro para objeto TimeZone (NULL para o fuso local)
+     */
+    const TimeZone* timeZone() const noexcept {
+        return date.zone;
+    }
+
+    /**
+     * Retorna todos os componentes da data
+     * \return Componentes da data (veja dateCivil.h)
+     */
+    CivilTime civil() const noexcept {
+        CivilTime components;
+        ::getDateCivilTime(handle(), &components);
+        return components;
+    }
+
+    /**
+     * Retorna um componente da data
+     * \return Componente, com os mesmos valores de getDateComponent()
+     */
+    template<enum DateComponent Component>
+    int get() const noexcept {
+        CivilTime components = civil();
+
+        if constexpr(Component == MDAY) return components.mday;
+        else if constexpr(Component == YDAY) return components.yday;
+        else if constexpr(Component == WDAY) return components.wday;
+        else if constexpr(Component == MONTH) return components.month;
+        else if constexpr(Component == YEAR) return components.year;
+        else if constexpr(Component == HOUR) return components.hour;
+        else if constexpr(Component == HOUR_AMPM)
+            return (components.hour == 0) ? 12
+                    : (components.hour > 12 ? components.hour - 12 : components.hour);
+        else if constexpr(Component == MINUTE) return components.minute;
+        else return components.second;
+    }
+
+    /**
+     * Formata a data em um formato escolhido na compilação
+     * \return Texto formatado
+     * \param weekDayName Se o nome do dia da semana deve constar no final
+     */
+    template<enum DateString Layout>
+    DateText format(bool weekDayName = false) const noexcept {
+        return DateFormatter<Layout>::format(civil(), weekDayName);
+    }
+
+    /**
+     * Formata a data em um formato escolhido na compilação
+     * \return Texto formatado
+     * \param weekDayName Se o nome do dia da semana deve constar no final
+     */
+    template<enum DateString Layout>
+    std::string toString(bool weekDayName = false) const {
+        return std::string(format<Layout>(weekDayName).view());
+    }
+
+    /**
+     * Adiciona (ou subtrai) dias, mantendo o horário local
+     * \return false se o resultado sair da faixa suportada
+     * \param days Quantidade de dias
+     */
+    bool addDays(long long days) noexcept {
+        return ::addDaysDate(handle(), days);
+    }
+
+    /**
+     * Adiciona (ou subtrai) meses, mantendo o horário local
+     * \return false se o resultado sair da faixa suportada
+     * \param months Quantidade de meses
+     * \param overflow O que fazer quando o dia não existe no mês de destino
+     */
+    bool addMonths(long long months, enum MonthOverflow overflow = MONTH_CLAMP) noexcept {
+        return ::addMonthsDate(handle(), months, overflow);
+    }
+
+    /**
+     * Adiciona (ou subtrai) anos, mantendo o horário local
+     * \return false se o resultado sair da faixa suportada
+     * \param years Quantidade de anos
+     * \param overflow O que fazer quando o dia não existe no mês de destino
+     */
+    bool addYears(long long years, enum MonthOverflow overflow = MONTH_CLAMP) noexcept {
+        return ::addYearsDate(handle(), years, overflow);
+    }
+
+    /**
+     * Retorna o objeto Date de date.h, para usar com a API em C
+     * \return Ponteiro para o objeto
+     */
+    ::Date* raw() noexcept {
+        return &date;
+    }
+
+    /**
+     * Compara duas datas pelo instante
+     * \return true se os instantes forem iguais
+     * \param other Outra data
+     */
+    bool operator==(const Date& other) const noexcept {
+        return date.data == other.date.data && date.nanoseconds == other.date.nanoseconds;
+    }
+
+    /**
+     * Compara duas datas pelo instante
+     * \return true se os instantes forem diferentes
+     * \param other Outra data
+     */
+    bool operator!=(const Date& other) const noexcept {
+        return !(*this == other);
+    }
+
+    /**
+     * Compara duas datas pelo instante
+     * \return true se esta data for anterior à outra
+     * \param other Outra data
+     */
+    bool operator<(const Date& other) const noexcept {
+        return date.data < other.date.data
+                || (date.data == other.date.data && date.nanoseconds < other.date.nanoseconds);
+    }
+
+private:
+    /**
+     * Objeto Date de date.h (mutável porque as leituras memorizam os
+     * componentes decompostos)
+     */
+    mutable ::Date date;
+
+    /**
+     * Ponteiro para o objeto, usado como ponteiro de ponteiro: a API em C
+     * recebe Date**
+     */
+    mutable ::Date* self = nullptr;
+
+    /**
+     * Retorna o endereço do ponteiro para o objeto, no formato da API em C
+     * \return Ponteiro para o ponteiro do objeto
+     */
+    ::Date** handle() const noexcept {
+        self = &date;
+        return &self;
+    }
+};
+
+/**
+ * Retorna a quantidade de dias inteiros entre duas datas (veja diffDaysDate())
+ * \return Dias inteiros (negativo se to for anterior a from)
+ * \param from Data inicial
+ * \param to Data final
+ */
+inline long long diffDays(Date from, Date to) noexcept {
+    ::Date* start = from.raw();
+    ::Date* end = to.raw();
+    return ::diffDaysDate(&start, &end);
+}
+
+/**
+ * Retorna a quantidade de meses inteiros entre duas datas (veja
+ * diffMonthsDate())
+ * \return Meses inteiros (negativo se to for anterior a from)
+ * \param from Data inicial
+ * \param to Data final
+ */
+inline long long diffMonths(Date from, Date to) noexcept {
+    ::Date* start = from.raw();
+    ::Date* end = to.raw();
+    return ::diffMonthsDate(&start, &end);
+}
+
+} // namespace dateC
+
+#endif /* DATE_HPP_ */
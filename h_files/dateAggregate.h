@@ -0,0 +1,102 @@
+/**
+ * \file dateAggregate.h
+ * Agregação de vetores de datas em histogramas<BR>
+ * Conta (e opcionalmente soma valores associados) as datas de um vetor por
+ * componente cíclico (dia da semana, hora do dia, mês do ano ...) ou por
+ * período do calendário (hora, dia, semana ISO, mês, ano), em uma única
+ * passada e sem objetos Date. Vetores grandes são divididos entre várias
+ * threads, cada uma com histogramas parciais que são somados no final
+ */
+
+#ifndef DATEAGGREGATE_H_
+#define DATEAGGREGATE_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <time.h>
+#include "date.h"
+#include "dateZone.h"
+
+/**
+ * Enumerador dos períodos do calendário usados em aggregateDatePeriod()
+ */
+enum DatePeriod{
+    DATE_PERIOD_HOUR, ///< horas desde 1/1/1970 00:00 no fuso
+    DATE_PERIOD_DAY, ///< dias desde 1/1/1970 no fuso
+    DATE_PERIOD_ISO_WEEK, ///< semanas ISO (de segunda a domingo) desde a semana de 1/1/1970
+    DATE_PERIOD_MONTH, ///< ano * 12 + mês - 1
+    DATE_PERIOD_YEAR ///< ano
+};
+
+/**
+ * Retorna a quantidade de faixas do histograma de um componente cíclico<BR>
+ * A faixa de cada data é o valor do componente (como em getDateComponent())
+ * menos o menor valor possível: o dia do mês 1 fica na faixa 0, o mês 1 na
+ * faixa 0, o dia da semana 0 (domingo) na faixa 0 etc.
+ * \return Quantidade de faixas (0 para YEAR, que não é cíclico: use
+ *      aggregateDatePeriod() com DATE_PERIOD_YEAR)
+ * \param component Componente da data
+ */
+size_t getDateComponentBucketCount(enum DateComponent component);
+
+/**
+ * Conta as datas de um vetor por um componente cíclico
+ * \return false se algum parâmetro for inválido
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param values Valor associado a cada data, somado em sums (pode ser NULL)
+ * \param count Quantidade de datas
+ * \param component Componente usado como faixa (veja
+ *      getDateComponentBucketCount())
+ * \param threads Quantidade máxima de threads (0 para uma por processador)
+ * \param counts Vetor com getDateComponentBucketCount() posições, onde será
+ *      guardada a quantidade de datas de cada faixa
+ * \param sums Vetor com getDateComponentBucketCount() posições, onde será
+ *      guardada a soma dos valores de cada faixa (pode ser NULL)
+ */
+bool aggregateDateComponent(const TimeZone* zone, const time_t* seconds,
+        const double* values, size_t count, enum DateComponent component,
+        unsigned int threads, unsigned long long* counts, double* sums);
+
+/**
+ * Retorna o período do calendário que contém uma data
+ * \return Número do período (veja enum DatePeriod)
+ * \param zone Fuso da data (NULL para o fuso local)
+ * \param seconds Data em segundos desde 1970
+ * \param period Tipo de período
+ */
+long long getDatePeriod(const TimeZone* zone, time_t seconds, enum DatePeriod period);
+
+/**
+ * Retorna o instante em que um período do calendário começa
+ * \return Segundos desde 1970
+ * \param zone Fuso do período (NULL para o fuso local)
+ * \param number Número do período (veja enum DatePeriod)
+ * \param period Tipo de período
+ */
+time_t getDatePeriodStart(const TimeZone* zone, long long number, enum DatePeriod period);
+
+/**
+ * Conta as datas de um vetor por período do calendário<BR>
+ * A faixa i corresponde ao período firstPeriod + i; datas fora das faixas
+ * são ignoradas
+ * \return false se algum parâmetro for inválido
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param values Valor associado a cada data, somado em sums (pode ser NULL)
+ * \param count Quantidade de datas
+ * \param period Tipo de período
+ * \param firstPeriod Número do período da primeira faixa (veja getDatePeriod())
+ * \param periodCount Quantidade de faixas
+ * \param threads Quantidade máxima de threads (0 para uma por processador)
+ * \param counts Vetor com periodCount posições, onde será guardada a
+ *      quantidade de datas de cada faixa
+ * \param sums Vetor com periodCount posições, onde será guardada a soma dos
+ *      valores de cada faixa (pode ser NULL)
+ */
+bool aggregateDatePeriod(const TimeZone* zone, const time_t* seconds,
+        const double* values, size_t count, enum DatePeriod period,
+        long long firstPeriod, size_t periodCount, unsigned int threads,
+        unsigned long long* counts, double* sums);
+
+#endif /* DATEAGGREGATE_H_ */
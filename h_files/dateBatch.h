@@ -0,0 +1,98 @@
+/**
+ * \file dateBatch.h
+ * Operações sobre vetores de datas (em segundos desde 1970)<BR>
+ * Os resultados são escritos em vetores separados por componente
+ * (estrutura de vetores), o que permite ao compilador vetorizar os laços
+ */
+
+#ifndef DATEBATCH_H_
+#define DATEBATCH_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <time.h>
+#include <stdint.h>
+#include "dateZone.h"
+
+/**
+ * Vetores de saída da decomposição em lote<BR>
+ * Cada ponteiro corresponde a um valor de enum DateComponent (veja date.h) e
+ * deve apontar para um vetor com pelo menos a quantidade de datas
+ * decompostas. Ponteiros NULL indicam componentes que não serão calculados
+ */
+struct dateComponentArrays{
+    int* mday; ///< dia do mês (1 - 31)
+    int* yday; ///< dia do ano (0 - 365)
+    int* wday; ///< dia da semana (0: domingo, 6: sábado)
+    int* month; ///< mês (1 - 12)
+    int* year; ///< ano
+    int* hour; ///< hora (0 - 23)
+    int* hourAmPm; ///< hora no formato am/pm (1 - 12)
+    int* minute; ///< minutos
+    int* second; ///< segundos
+};
+
+/**
+ * Vetores de saída da decomposição em lote
+ */
+typedef struct dateComponentArrays DateComponentArrays;
+
+/**
+ * Vetores de entrada da validação em lote<BR>
+ * Cada ponteiro aponta para um vetor com pelo menos a quantidade de datas
+ * validadas. Dia, mês e ano são obrigatórios; hora, minuto e segundo NULL
+ * valem 0
+ */
+struct dateFieldArrays{
+    const int* day; ///< dia do mês
+    const int* month; ///< mês
+    const int* year; ///< ano
+    const int* hour; ///< hora
+    const int* minute; ///< minutos
+    const int* second; ///< segundos
+};
+
+/**
+ * Vetores de entrada da validação em lote
+ */
+typedef struct dateFieldArrays DateFieldArrays;
+
+/**
+ * Decompõe um vetor de datas no fuso local, em uma única passada<BR>
+ * Equivale a chamar getDateComponent() para cada data e cada componente
+ * solicitado, sem alocar objetos Date
+ * \return false se algum ponteiro obrigatório for NULL, true em caso contrário
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas no vetor
+ * \param components Vetores de saída (componentes NULL são ignorados)
+ */
+bool getDateComponentsBatch(const time_t* seconds, size_t count,
+        DateComponentArrays* components);
+
+/**
+ * Decompõe um vetor de datas em um fuso específico, em uma única passada
+ * \return false se algum ponteiro obrigatório for NULL, true em caso contrário
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas no vetor
+ * \param components Vetores de saída (componentes NULL são ignorados)
+ */
+bool getDateComponentsBatchZone(const TimeZone* zone, const time_t* seconds,
+        size_t count, DateComponentArrays* components);
+
+/**
+ * Valida um vetor de datas, com as mesmas regras de validateDate() (veja
+ * date.h)<BR>
+ * O resultado é um mapa de bits: o bit (i % 64) da palavra validMask[i / 64]
+ * indica se a data i é válida. Os bits além de count na última palavra são
+ * zerados
+ * \return Quantidade de datas válidas (0 se algum ponteiro obrigatório for
+ *      NULL)
+ * \param fields Vetores de entrada (veja struct dateFieldArrays)
+ * \param count Quantidade de datas
+ * \param validMask Vetor com pelo menos (count + 63) / 64 palavras
+ */
+size_t validateDatesBatch(const DateFieldArrays* fields, size_t count,
+        uint64_t* validMask);
+
+#endif /* DATEBATCH_H_ */
@@ -0,0 +1,140 @@
+/**
+ * \file dateBusiness.h
+ * Calendários de dias úteis<BR>
+ * Um calendário é criado com os dias de fim de semana e uma faixa de anos, e
+ * recebe os feriados depois. Os dias úteis ficam em um mapa de bits (um bit
+ * por dia) com a contagem acumulada a cada 64 dias, de modo que contar os
+ * dias úteis entre duas datas custa tempo constante (popcount) e somar dias
+ * úteis custa uma busca binária curta na contagem acumulada, sem percorrer os
+ * dias um a um
+ */
+
+#ifndef DATEBUSINESS_H_
+#define DATEBUSINESS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "date.h"
+#include "dateBatch.h"
+
+/**
+ * Máscara de dias da semana com um dia (use com enum WeekDay de date.h)
+ */
+#define BUSINESS_DAY(weekDay) (1u << (weekDay))
+
+/**
+ * Fim de semana mais comum: sábado e domingo
+ */
+#define BUSINESS_WEEKEND_SATURDAY_SUNDAY (BUSINESS_DAY(SATURDAY) | BUSINESS_DAY(SUNDAY))
+
+/**
+ * Estrutura do objeto calendário de dias úteis
+ */
+typedef struct businessCalendar BusinessCalendar;
+
+/**
+ * Cria um calendário de dias úteis sem feriados
+ * \return Ponteiro para objeto BusinessCalendar, ou NULL se os parâmetros
+ *      forem inválidos ou faltar memória
+ * \param weekend Dias de fim de semana (veja BUSINESS_DAY())
+ * \param firstYear Primeiro ano coberto pelo calendário
+ * \param lastYear Último ano coberto pelo calendário
+ */
+BusinessCalendar* createBusinessCalendar(unsigned int weekend, int firstYear, int lastYear);
+
+/**
+ * Desaloca o calendário
+ * \return NULL
+ * \param calendar Ponteiro para objeto BusinessCalendar a ser desalocado
+ */
+BusinessCalendar* destroyBusinessCalendar(BusinessCalendar* calendar);
+
+/**
+ * Marca um dia como feriado<BR>
+ * Feriados em fins de semana são aceitos e não mudam nada. O calendário não
+ * deve ser consultado por outra thread enquanto feriados são adicionados.
+ * Cada chamada atualiza a contagem acumulada dos dias seguintes; para muitos
+ * feriados, use addBusinessHolidays()
+ * \return false se a data for inválida ou estiver fora dos anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param day Dia do mês
+ * \param month Mês
+ * \param year Ano
+ */
+bool addBusinessHoliday(BusinessCalendar* calendar, int day, int month, int year);
+
+/**
+ * Marca vários dias como feriados, atualizando a contagem acumulada uma
+ * única vez (a partir do primeiro dia alterado)<BR>
+ * Datas inválidas ou fora dos anos do calendário são ignoradas. O
+ * calendário não deve ser consultado por outra thread enquanto feriados são
+ * adicionados
+ * \return Quantidade de datas aceitas (0 se algum ponteiro obrigatório for
+ *      NULL)
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param holidays Vetores de dia, mês e ano (hora, minuto e segundo são
+ *      ignorados; veja struct dateFieldArrays em dateBatch.h)
+ * \param count Quantidade de feriados
+ */
+size_t addBusinessHolidays(BusinessCalendar* calendar, const DateFieldArrays* holidays,
+        size_t count);
+
+/**
+ * Verifica se um dia é útil
+ * \return true se o dia for útil; false se não for ou se estiver fora dos
+ *      anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param days Dia em dias desde 1/1/1970 (veja daysFromCivil() em dateCivil.h)
+ */
+bool isBusinessDay(const BusinessCalendar* calendar, long long days);
+
+/**
+ * Conta os dias úteis em um intervalo de dias [from, until)
+ * \return false se o intervalo sair dos anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param from Primeiro dia do intervalo, em dias desde 1/1/1970
+ * \param until Dia seguinte ao último do intervalo, em dias desde 1/1/1970
+ * \param count Ponteiro onde será guardada a quantidade de dias úteis
+ *      (negativa se until for anterior a from)
+ */
+bool countBusinessDays(const BusinessCalendar* calendar, long long from, long long until,
+        long long* count);
+
+/**
+ * Soma dias úteis a um dia<BR>
+ * Com count positivo, o resultado é o count-ésimo dia útil depois de days;
+ * com count negativo, o count-ésimo dia útil antes de days; com count 0, o
+ * próprio dia se for útil ou o próximo dia útil
+ * \return false se o resultado sair dos anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param days Dia em dias desde 1/1/1970
+ * \param count Quantidade de dias úteis
+ * \param result Ponteiro onde será guardado o dia resultante
+ */
+bool addBusinessDays(const BusinessCalendar* calendar, long long days, long long count,
+        long long* result);
+
+/**
+ * Soma dias úteis à data, mantendo o horário local (veja addBusinessDays())
+ * \return false se o resultado sair dos anos do calendário (a data não muda)
+ * \param date Ponteiro para o objeto Date
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param count Quantidade de dias úteis (negativa para subtrair)
+ */
+bool addBusinessDaysDate(Date** date, const BusinessCalendar* calendar, long long count);
+
+/**
+ * Conta os dias úteis depois de from até to, inclusive (os horários são
+ * ignorados): somar esse resultado a from com addBusinessDaysDate() leva ao
+ * dia de to quando to é dia útil
+ * \return false se as datas saírem dos anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param from Ponteiro para o objeto Date inicial
+ * \param to Ponteiro para o objeto Date final
+ * \param count Ponteiro onde será guardada a quantidade de dias úteis
+ *      (negativa se to for anterior a from)
+ */
+bool diffBusinessDaysDate(const BusinessCalendar* calendar, Date** from, Date** to,
+        long long* count);
+
+#endif /* DATEBUSINESS_H_ */
@@ -0,0 +1,99 @@
+/**
+ * \file dateCivil.h
+ * Motor aritmético do calendário civil (gregoriano proléptico)<BR>
+ * Converte entre dias desde 1970 e dia/mês/ano usando somente aritmética
+ * inteira, sem passar por localtime() ou mktime()
+ */
+
+#ifndef DATECIVIL_H_
+#define DATECIVIL_H_
+
+#include <stdbool.h>
+
+/**
+ * Quantidade de segundos em um dia
+ */
+#define SECONDS_PER_DAY 86400
+
+/**
+ * Estrutura com a data decomposta em seus componentes
+ */
+struct civilTime{
+    int year; ///< ano
+    int month; ///< mês (1 - 12)
+    int mday; ///< dia do mês (1 - 31)
+    int yday; ///< dia do ano (0 - 365)
+    int wday; ///< dia da semana (0: domingo, 6: sábado)
+    int hour; ///< hora (0 - 23)
+    int minute; ///< minutos (0 - 59)
+    int second; ///< segundos (0 - 59)
+};
+
+/**
+ * Data decomposta em seus componentes
+ */
+typedef struct civilTime CivilTime;
+
+/**
+ * Verifica se um ano é bissexto (regra gregoriana completa)
+ * \return true se o ano for bissexto
+ * \param year Ano
+ */
+bool isLeapYear(int year);
+
+/**
+ * Retorna a quantidade de dias de um mês
+ * \return Dias do mês (28 - 31)
+ * \param year Ano
+ * \param month Mês (1 - 12)
+ */
+int daysInMonth(int year, int month);
+
+/**
+ * Converte uma data civil em dias desde 1/1/1970
+ * \return Dias desde 1/1/1970 (negativo para datas anteriores)
+ * \param year Ano
+ * \param month Mês (1 - 12)
+ * \param day Dia do mês (1 - 31)
+ */
+long long daysFromCivil(int year, int month, int day);
+
+/**
+ * Converte dias desde 1/1/1970 em uma data civil
+ * \param days Dias desde 1/1/1970
+ * \param year Ponteiro onde será guardado o ano
+ * \param month Ponteiro onde será guardado o mês (1 - 12)
+ * \param day Ponteiro onde será guardado o dia do mês (1 - 31)
+ */
+void civilFromDays(long long days, int* year, int* month, int* day);
+
+/**
+ * Retorna o dia da semana de um dia desde 1/1/1970
+ * \return Dia da semana (0: domingo, 6: sábado)
+ * \param days Dias desde 1/1/1970
+ */
+int weekDayFromDays(long long days);
+
+/**
+ * Decompõe segundos (já ajustados para o fuso desejado) em componentes
+ * \param seconds Segundos desde 1/1/1970 00:00:00 no fuso desejado
+ * \param civil Ponteiro para a estrutura a ser preenchida
+ */
+void civilTimeFromSeconds(long long seconds, CivilTime* civil);
+
+/**
+ * Compõe segundos desde 1/1/1970 a partir dos componentes da data<BR>
+ * Componentes fora do intervalo são normalizados (como em mktime()): mês 13
+ * vira janeiro do ano seguinte, dia 0 vira o último dia do mês anterior etc.
+ * \return Segundos desde 1/1/1970 00:00:00 no mesmo fuso dos componentes
+ * \param day Dia do mês
+ * \param month Mês
+ * \param year Ano
+ * \param hour Hora
+ * \param minute Minuto
+ * \param second Segundo
+ */
+long long secondsFromCivil(int day, int month, int year,
+        int hour, int minute, int second);
+
+#endif /* DATECIVIL_H_ */
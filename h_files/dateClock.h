@@ -0,0 +1,57 @@
+/**
+ * \file dateClock.h
+ * Fonte da data atual usada por setDateToday() e createDate()<BR>
+ * A fonte é escolhida em tempo de execução e vale para todo o processo
+ */
+
+#ifndef DATECLOCK_H_
+#define DATECLOCK_H_
+
+#include <stdbool.h>
+#include <time.h>
+
+/**
+ * Enumerador das fontes da data atual
+ */
+enum DateClock{
+    DATE_CLOCK_TIME, ///< time(0), somente segundos (padrão)
+    DATE_CLOCK_COARSE, ///< CLOCK_REALTIME_COARSE pelo vDSO: rápido, resolução de alguns milissegundos
+    DATE_CLOCK_PRECISE, ///< CLOCK_REALTIME com nanossegundos
+    DATE_CLOCK_CACHED ///< valor atualizado por uma thread em segundo plano (veja startDateClockTicker())
+};
+
+/**
+ * Escolhe a fonte da data atual
+ * \param clock Fonte da data atual
+ */
+void setDateClock(enum DateClock clock);
+
+/**
+ * Retorna a fonte da data atual em uso
+ * \return Fonte da data atual
+ */
+enum DateClock getDateClock(void);
+
+/**
+ * Inicia a thread que atualiza o relógio usado por DATE_CLOCK_CACHED<BR>
+ * Enquanto a thread não estiver rodando, DATE_CLOCK_CACHED se comporta como
+ * DATE_CLOCK_COARSE
+ * \return false se não conseguir iniciar a thread (ou se ela já estiver rodando)
+ * \param intervalMicroseconds Intervalo entre duas atualizações (0 para 1 ms)
+ */
+bool startDateClockTicker(unsigned int intervalMicroseconds);
+
+/**
+ * Para a thread iniciada por startDateClockTicker()
+ */
+void stopDateClockTicker(void);
+
+/**
+ * Lê a data atual na fonte escolhida
+ * \param seconds Ponteiro onde serão guardados os segundos desde 1970
+ * \param nanoseconds Ponteiro onde serão guardados os nanossegundos (0 se a
+ *      fonte não tiver essa resolução). Pode ser NULL
+ */
+void readDateClock(time_t* seconds, long* nanoseconds);
+
+#endif /* DATECLOCK_H_ */
@@ -0,0 +1,226 @@
+/**
+ * \file dateFormat.h
+ * Formatação de datas em memória com tamanho limitado<BR>
+ * Escreve os dígitos por tabela, sem a maquinaria de printf(), e nunca
+ * escreve além da capacidade informada. Além dos formatos fixos de enum
+ * DateString, aceita padrões no estilo de strftime() compilados uma única vez
+ * em um plano de formatação (veja compileDateFormat())
+ */
+
+#ifndef DATEFORMAT_H_
+#define DATEFORMAT_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "date.h"
+#include "dateCivil.h"
+
+/**
+ * Capacidade suficiente para qualquer formato de enum DateString, com o nome
+ * do dia da semana e o '\0' final
+ */
+#define DATE_STRING_SIZE 40
+
+/**
+ * Capacidade suficiente para qualquer nome de dia da semana com o '\0' final
+ */
+#define WEEK_DAY_STRING_SIZE 10
+
+/**
+ * Estrutura do objeto plano de formatação (um padrão já compilado)
+ */
+typedef struct dateFormatPlan DateFormatPlan;
+
+/**
+ * Formata componentes de data em um dos formatos de enum DateString<BR>
+ * O texto gerado é o mesmo de getStringDate() e sempre termina com '\0'
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o texto
+ *      não couber na capacidade informada
+ * \param civil Componentes da data (veja dateCivil.h)
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja date.h)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatCivilTime(const CivilTime* civil, enum DateString dateString,
+        bool weekDayName, char* buffer, size_t capacity);
+
+/**
+ * Formata uma data em um dos formatos de enum DateString
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o texto
+ *      não couber na capacidade informada
+ * \param date Ponteiro para objeto Date
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja date.h)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatDate(Date** date, enum DateString dateString, bool weekDayName,
+        char* buffer, size_t capacity);
+
+/**
+ * Escreve o nome de um dia da semana
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o nome
+ *      não couber na capacidade informada ou o dia não for válido
+ * \param weekDay Dia da semana (0: domingo, 6: sábado)
+ * \param buffer Memória onde o nome será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatWeekDay(int weekDay, char* buffer, size_t capacity);
+
+/**
+ * Compila um padrão no estilo de strftime() em um plano de formatação<BR>
+ * Conversões aceitas (campos numéricos com zeros à esquerda; o modificador
+ * '-', como em "%-d", tira os zeros):<BR>
+ * &nbsp; &nbsp; %Y ano (pelo menos 4 dígitos), %y ano com 2 dígitos<BR>
+ * &nbsp; &nbsp; %m mês, %d dia do mês, %e dia do mês com espaço à esquerda,
+ * %j dia do ano (001 - 366)<BR>
+ * &nbsp; &nbsp; %H hora (00 - 23), %I hora (01 - 12), %p AM ou PM, %M
+ * minuto, %S segundo<BR>
+ * &nbsp; &nbsp; %f fração de segundo com 6 dígitos, ou com 1 a 9 dígitos em
+ * "%3f" ... "%9f"<BR>
+ * &nbsp; &nbsp; %b e %B nome do mês abreviado e completo, %a e %A nome do
+ * dia da semana abreviado e completo (em inglês, como getStringWeekDay())<BR>
+ * &nbsp; &nbsp; %z deslocamento do fuso (+hhmm), %% o caractere '%'<BR>
+ * Os demais caracteres são copiados sem mudança
+ * \return Ponteiro para objeto DateFormatPlan, ou NULL se o padrão tiver uma
+ *      conversão desconhecida ou faltar memória
+ * \param pattern Padrão terminado em '\0'
+ */
+DateFormatPlan* compileDateFormat(const char* pattern);
+
+/**
+ * Desaloca o plano de formatação
+ * \return NULL
+ * \param plan Ponteiro para objeto DateFormatPlan a ser desalocado
+ */
+DateFormatPlan* destroyDateFormatPlan(DateFormatPlan* plan);
+
+/**
+ * Retorna o maior texto que o plano pode gerar
+ * \return Quantidade máxima de caracteres (sem o '\0')
+ * \param plan Ponteiro para objeto DateFormatPlan
+ */
+size_t getDateFormatPlanMaxLength(const DateFormatPlan* plan);
+
+/**
+ * Formata componentes de data com um plano de formatação<BR>
+ * O texto sempre termina com '\0'
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o texto
+ *      não couber na capacidade informada
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param civil Componentes da data (veja dateCivil.h)
+ * \param nanoseconds Fração de segundo em nanossegundos (usada por %f)
+ * \param utcOffset Deslocamento do fuso em segundos (usado por %z)
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatCivilTimePlan(const DateFormatPlan* plan, const CivilTime* civil,
+        long nanoseconds, long utcOffset, char* buffer, size_t capacity);
+
+/**
+ * Formata uma data com um plano de formatação
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o texto
+ *      não couber na capacidade informada
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param date Ponteiro para objeto Date
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatDatePlan(const DateFormatPlan* plan, Date** date, char* buffer,
+        size_t capacity);
+
+/**
+ * Formata um vetor de datas com um plano de formatação<BR>
+ * Cada texto ocupa stride bytes em texts e termina com '\0'; textos que não
+ * couberem ficam vazios. Com stride maior que getDateFormatPlanMaxLength()
+ * todos os textos cabem
+ * \return Quantidade de datas formatadas
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param texts Memória com count * stride bytes onde os textos serão escritos
+ * \param stride Espaço de cada texto em bytes
+ * \param lengths Vetor onde será guardado o tamanho de cada texto (pode ser
+ *      NULL)
+ */
+size_t formatDatesBatchPlan(const DateFormatPlan* plan, const TimeZone* zone,
+        const time_t* seconds, size_t count, char* texts, size_t stride, size_t* lengths);
+
+/**
+ * Formatador com memória para datas quase sempre crescentes<BR>
+ * Guarda o texto da última data formatada em um dos formatos de enum
+ * DateString e o intervalo em que a parte do dia desse texto continua valendo
+ * (o mesmo dia local, com o mesmo deslocamento do fuso). Dentro dele só o
+ * horário é reescrito, e só os dígitos dos segundos quando a hora e o minuto
+ * não mudam; fora dele (troca de dia, salto para outro dia ou mudança do
+ * deslocamento) a data é formatada por inteiro. Os campos são internos:
+ * inicie a estrutura com startDateFormatCache(). Use uma estrutura por thread
+ */
+struct dateFormatCache{
+    const TimeZone* zone; ///< fuso das datas
+    enum DateString dateString; ///< formato das datas
+    bool weekDayName; ///< se o nome do dia da semana consta no fim do texto
+    bool clock; ///< se o formato tem horário
+    bool ampm; ///< se o horário é no formato am/pm
+    time_t from; ///< primeira data em que a parte do dia vale
+    time_t until; ///< última data em que a parte do dia vale
+    long offset; ///< deslocamento do fuso no intervalo
+    long long dayStart; ///< meia-noite do dia, em segundos locais desde 1970
+    int weekDay; ///< dia da semana do dia
+    int secondOfDay; ///< segundo do dia da última data
+    size_t clockStart; ///< posição do horário no texto
+    size_t secondStart; ///< posição dos segundos no texto
+    size_t length; ///< tamanho do texto
+    char text[DATE_STRING_SIZE]; ///< texto da última data
+};
+
+/**
+ * Formatador com memória para datas quase sempre crescentes
+ */
+typedef struct dateFormatCache DateFormatCache;
+
+/**
+ * Inicia um formatador com memória (veja struct dateFormatCache)
+ * \param cache Ponteiro para a estrutura a ser iniciada
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja date.h)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ */
+void startDateFormatCache(DateFormatCache* cache, const TimeZone* zone,
+        enum DateString dateString, bool weekDayName);
+
+/**
+ * Formata uma data com um formatador com memória<BR>
+ * O texto gerado é o mesmo de formatCivilTime() com os componentes da data
+ * no fuso do formatador
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o formato
+ *      for inválido ou o texto não couber na capacidade informada
+ * \param cache Ponteiro para o formatador
+ * \param seconds Data em segundos desde 1970
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatSecondsCached(DateFormatCache* cache, time_t seconds, char* buffer,
+        size_t capacity);
+
+/**
+ * Formata um objeto Date com um formatador com memória (o mesmo texto de
+ * formatDate())<BR>
+ * Se o fuso da data não for o do formatador, o formatador passa a usar o
+ * fuso da data
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o formato
+ *      for inválido ou o texto não couber na capacidade informada
+ * \param cache Ponteiro para o formatador
+ * \param date Ponteiro para objeto Date
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatDateCached(DateFormatCache* cache, Date** date, char* buffer,
+        size_t capacity);
+
+#endif /* DATEFORMAT_H_ */
@@ -0,0 +1,110 @@
+/**
+ * \file dateIndex.h
+ * Índice de um vetor de datas para consultas por intervalo<BR>
+ * O índice guarda uma cópia ordenada das datas e uma árvore de busca no
+ * layout de Eytzinger (a árvore binária guardada em largura, que mantém os
+ * primeiros níveis juntos no cache), além das posições em que começa cada dia
+ * e cada mês do fuso escolhido. Consultas por intervalo são logarítmicas e
+ * consultas por dia ou mês são de tempo constante; todas retornam um trecho
+ * contíguo do vetor ordenado
+ */
+
+#ifndef DATEINDEX_H_
+#define DATEINDEX_H_
+
+#include <stddef.h>
+#include <time.h>
+#include "date.h"
+#include "dateZone.h"
+
+/**
+ * Estrutura do objeto índice de datas
+ */
+typedef struct dateIndex DateIndex;
+
+/**
+ * Trecho contíguo do vetor ordenado de um índice
+ */
+struct dateSpan{
+    const time_t* seconds; ///< primeira data do trecho
+    size_t first; ///< posição da primeira data no vetor ordenado
+    size_t count; ///< quantidade de datas no trecho
+};
+
+/**
+ * Trecho contíguo do vetor ordenado de um índice
+ */
+typedef struct dateSpan DateSpan;
+
+/**
+ * Cria um índice sobre um vetor de datas<BR>
+ * As datas são copiadas (e ordenadas, se necessário); o vetor original pode
+ * ser liberado em seguida
+ * \return Ponteiro para objeto DateIndex, ou NULL se não conseguir
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param zone Fuso usado nas consultas por dia e mês (NULL para o fuso
+ *      local). O fuso deve continuar carregado enquanto o índice existir
+ */
+DateIndex* createDateIndex(const time_t* seconds, size_t count, const TimeZone* zone);
+
+/**
+ * Desaloca o índice
+ * \return NULL
+ * \param index Ponteiro para objeto DateIndex a ser desalocado
+ */
+DateIndex* destroyDateIndex(DateIndex* index);
+
+/**
+ * Retorna todas as datas do índice, em ordem crescente
+ * \return Trecho com todas as datas
+ * \param index Ponteiro para objeto DateIndex
+ */
+DateSpan getDateIndexSpan(const DateIndex* index);
+
+/**
+ * Retorna a posição da primeira data maior ou igual a um instante
+ * \return Posição no vetor ordenado (a quantidade de datas se não houver)
+ * \param index Ponteiro para objeto DateIndex
+ * \param seconds Instante em segundos desde 1970
+ */
+size_t findDateIndexLowerBound(const DateIndex* index, time_t seconds);
+
+/**
+ * Retorna as datas do intervalo [from, until)
+ * \return Trecho com as datas do intervalo (vazio se until <= from)
+ * \param index Ponteiro para objeto DateIndex
+ * \param from Início do intervalo em segundos desde 1970 (incluído)
+ * \param until Fim do intervalo em segundos desde 1970 (excluído)
+ */
+DateSpan findDateIndexRange(const DateIndex* index, time_t from, time_t until);
+
+/**
+ * Retorna as datas entre dois objetos Date, no intervalo [from, until)
+ * \return Trecho com as datas do intervalo
+ * \param index Ponteiro para objeto DateIndex
+ * \param from Ponteiro para objeto Date do início (incluído)
+ * \param until Ponteiro para objeto Date do fim (excluído)
+ */
+DateSpan findDateIndexBetween(const DateIndex* index, Date** from, Date** until);
+
+/**
+ * Retorna as datas de um dia no fuso do índice
+ * \return Trecho com as datas do dia (vazio se a data não for válida)
+ * \param index Ponteiro para objeto DateIndex
+ * \param day Dia do mês
+ * \param month Mês
+ * \param year Ano
+ */
+DateSpan findDateIndexDay(const DateIndex* index, int day, int month, int year);
+
+/**
+ * Retorna as datas de um mês no fuso do índice
+ * \return Trecho com as datas do mês (vazio se o mês não for válido)
+ * \param index Ponteiro para objeto DateIndex
+ * \param month Mês
+ * \param year Ano
+ */
+DateSpan findDateIndexMonth(const DateIndex* index, int month, int year);
+
+#endif /* DATEINDEX_H_ */
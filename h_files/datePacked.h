@@ -0,0 +1,240 @@
+/**
+ * \file datePacked.h
+ * Codificações compactas de datas e arquivo colunar de datas<BR>
+ * Três codificações sem ponteiros e sem alocação, para guardar muitas datas
+ * em vetores:
+ * - PackedDay: 32 bits com o dia (dias desde 1970, no fuso da data), para
+ * dados com granularidade de dia;
+ * - PackedDateTime: 64 bits com o dia e os segundos desde a meia-noite em
+ * UTC, sem perda para qualquer segundo da faixa suportada;
+ * - PackedCivil: 64 bits com ano, mês, dia, hora, minuto e segundo em UTC,
+ * cujos valores inteiros ordenam as datas cronologicamente.<BR>
+ * A resolução é de segundos (os nanossegundos de um objeto Date não são
+ * guardados). O arquivo colunar guarda um vetor em uma dessas codificações
+ * depois de um cabeçalho de 64 bytes, e pode ser mapeado em memória e usado
+ * diretamente, sem decodificação
+ */
+
+#ifndef DATEPACKED_H_
+#define DATEPACKED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "date.h"
+#include "dateZone.h"
+
+/**
+ * Menor data representável em todas as codificações (segundos desde 1970)
+ */
+#define PACKED_MIN_SECONDS ((long long) INT32_MIN * 86400)
+
+/**
+ * Maior data representável em todas as codificações (segundos desde 1970)
+ */
+#define PACKED_MAX_SECONDS ((long long) INT32_MAX * 86400 + 86399)
+
+/**
+ * Dia em dias desde 1/1/1970
+ */
+typedef int32_t PackedDay;
+
+/**
+ * Data em UTC separada em dia e segundos desde a meia-noite
+ */
+struct packedDateTime{
+    int32_t day; ///< dias desde 1/1/1970 em UTC
+    uint32_t second; ///< segundos desde a meia-noite em UTC (0 - 86399)
+};
+
+/**
+ * Data em UTC separada em dia e segundos desde a meia-noite
+ */
+typedef struct packedDateTime PackedDateTime;
+
+/**
+ * Data em UTC com os componentes em campos de bits (do mais significativo
+ * para o menos): ano + 2^31 (32 bits), mês (4), dia (5), hora (5), minuto
+ * (6) e segundo (6)
+ */
+typedef uint64_t PackedCivil;
+
+/**
+ * Enumerador das codificações de um arquivo colunar
+ */
+enum PackedEncoding{
+    PACKED_SECONDS = 1, ///< time_t de 64 bits (segundos desde 1970)
+    PACKED_DAY, ///< PackedDay
+    PACKED_DATE_TIME, ///< PackedDateTime
+    PACKED_CIVIL ///< PackedCivil
+};
+
+/**
+ * Estrutura do objeto arquivo colunar mapeado em memória
+ */
+typedef struct dateColumn DateColumn;
+
+/**
+ * Codifica o dia de uma data (no fuso da data)
+ * \return false se a data estiver fora da faixa suportada
+ * \param date Ponteiro para objeto Date
+ * \param packed Ponteiro onde será guardado o dia
+ */
+bool packDateDay(Date** date, PackedDay* packed);
+
+/**
+ * Define a data como a meia-noite (no fuso da data) de um dia codificado
+ * \return false se a data não puder ser representada por um objeto Date
+ * \param date Ponteiro para objeto Date
+ * \param packed Dia codificado
+ */
+bool unpackDateDay(Date** date, PackedDay packed);
+
+/**
+ * Codifica uma data em dia e segundos desde a meia-noite em UTC
+ * \return false se a data estiver fora da faixa suportada
+ * \param date Ponteiro para objeto Date
+ * \param packed Ponteiro onde será guardada a data codificada
+ */
+bool packDateTime(Date** date, PackedDateTime* packed);
+
+/**
+ * Define a data a partir de dia e segundos desde a meia-noite em UTC
+ * \return false se os campos forem inválidos
+ * \param date Ponteiro para objeto Date
+ * \param packed Data codificada
+ */
+bool unpackDateTime(Date** date, PackedDateTime packed);
+
+/**
+ * Codifica os componentes de uma data em UTC em campos de bits
+ * \return false se a data estiver fora da faixa suportada
+ * \param date Ponteiro para objeto Date
+ * \param packed Ponteiro onde será guardada a data codificada
+ */
+bool packDateCivil(Date** date, PackedCivil* packed);
+
+/**
+ * Define a data a partir dos componentes em UTC codificados em campos de bits
+ * \return false se os campos forem inválidos
+ * \param date Ponteiro para objeto Date
+ * \param packed Data codificada
+ */
+bool unpackDateCivil(Date** date, PackedCivil packed);
+
+/**
+ * Codifica um vetor de datas em dias (no fuso informado)
+ * \return false se alguma data estiver fora da faixa suportada (essas
+ *      posições recebem 0)
+ * \param zone Fuso dos dias (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param packed Vetor onde serão guardados os dias
+ */
+bool packDaysBatch(const TimeZone* zone, const time_t* seconds, size_t count,
+        PackedDay* packed);
+
+/**
+ * Converte um vetor de dias na meia-noite (no fuso informado) de cada dia
+ * \param zone Fuso dos dias (NULL para o fuso local)
+ * \param packed Vetor de dias
+ * \param count Quantidade de dias
+ * \param seconds Vetor onde serão guardadas as datas em segundos desde 1970
+ */
+void unpackDaysBatch(const TimeZone* zone, const PackedDay* packed, size_t count,
+        time_t* seconds);
+
+/**
+ * Codifica um vetor de datas em dia e segundos desde a meia-noite em UTC
+ * \return false se alguma data estiver fora da faixa suportada (essas
+ *      posições recebem 0)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param packed Vetor onde serão guardadas as datas codificadas
+ */
+bool packDateTimesBatch(const time_t* seconds, size_t count, PackedDateTime* packed);
+
+/**
+ * Decodifica um vetor de datas em dia e segundos desde a meia-noite em UTC
+ * \return false se alguma data codificada for inválida (essas posições
+ *      recebem 0)
+ * \param packed Vetor de datas codificadas
+ * \param count Quantidade de datas
+ * \param seconds Vetor onde serão guardadas as datas em segundos desde 1970
+ */
+bool unpackDateTimesBatch(const PackedDateTime* packed, size_t count, time_t* seconds);
+
+/**
+ * Codifica um vetor de datas em componentes UTC em campos de bits
+ * \return false se alguma data estiver fora da faixa suportada (essas
+ *      posições recebem 0)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param packed Vetor onde serão guardadas as datas codificadas
+ */
+bool packCivilBatch(const time_t* seconds, size_t count, PackedCivil* packed);
+
+/**
+ * Decodifica um vetor de datas em componentes UTC em campos de bits
+ * \return false se alguma data codificada for inválida (essas posições
+ *      recebem 0)
+ * \param packed Vetor de datas codificadas
+ * \param count Quantidade de datas
+ * \param seconds Vetor onde serão guardadas as datas em segundos desde 1970
+ */
+bool unpackCivilBatch(const PackedCivil* packed, size_t count, time_t* seconds);
+
+/**
+ * Grava um vetor de datas codificadas em um arquivo colunar<BR>
+ * O arquivo tem um cabeçalho de 64 bytes seguido dos valores na ordem de
+ * bytes da máquina, que é conferida na leitura
+ * \return false se houver erro de escrita (veja errno)
+ * \param path Caminho do arquivo (é criado ou substituído)
+ * \param encoding Codificação dos valores
+ * \param values Vetor de valores (time_t, PackedDay, PackedDateTime ou
+ *      PackedCivil, conforme encoding)
+ * \param count Quantidade de valores
+ */
+bool writeDateColumn(const char* path, enum PackedEncoding encoding, const void* values,
+        size_t count);
+
+/**
+ * Abre um arquivo colunar mapeando-o em memória (somente leitura)
+ * \return Ponteiro para objeto DateColumn, ou NULL se o arquivo não existir
+ *      ou não for um arquivo colunar válido
+ * \param path Caminho do arquivo
+ */
+DateColumn* openDateColumn(const char* path);
+
+/**
+ * Fecha o arquivo colunar e desfaz o mapeamento
+ * \return NULL
+ * \param column Ponteiro para objeto DateColumn a ser fechado
+ */
+DateColumn* closeDateColumn(DateColumn* column);
+
+/**
+ * Retorna a codificação dos valores do arquivo colunar
+ * \return Codificação
+ * \param column Ponteiro para objeto DateColumn
+ */
+enum PackedEncoding getDateColumnEncoding(const DateColumn* column);
+
+/**
+ * Retorna a quantidade de valores do arquivo colunar
+ * \return Quantidade de valores
+ * \param column Ponteiro para objeto DateColumn
+ */
+size_t getDateColumnCount(const DateColumn* column);
+
+/**
+ * Retorna os valores do arquivo colunar, direto da memória mapeada<BR>
+ * O ponteiro é alinhado em 64 bytes e vale até closeDateColumn()
+ * \return Ponteiro para o vetor de valores (time_t, PackedDay,
+ *      PackedDateTime ou PackedCivil, conforme getDateColumnEncoding())
+ * \param column Ponteiro para objeto DateColumn
+ */
+const void* getDateColumnData(const DateColumn* column);
+
+#endif /* DATEPACKED_H_ */
@@ -0,0 +1,83 @@
+/**
+ * \file dateParse.h
+ * Leitura de datas em texto<BR>
+ * Lê os formatos de enum DateString (os mesmos gerados por getStringDate())
+ * e o formato ISO-8601/RFC-3339, validando a data na mesma passada e
+ * convertendo diretamente para segundos desde 1970, sem sscanf() nem mktime()
+ */
+
+#ifndef DATEPARSE_H_
+#define DATEPARSE_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <time.h>
+#include "date.h"
+#include "dateZone.h"
+
+/**
+ * Lê uma data em um dos formatos de enum DateString<BR>
+ * Os campos podem ter ou não zeros à esquerda, e o nome do dia da semana no
+ * final é aceito (e conferido) se estiver presente. Nos formatos só com
+ * horário (DATE_HMS e DATE_HMS_AMPM) o resultado é a quantidade de segundos
+ * desde a meia-noite, sem fuso
+ * \return true se o texto estiver no formato e a data for válida
+ * \param text Texto a ser lido
+ * \param length Tamanho do texto (o texto não precisa terminar com '\0')
+ * \param dateString Enumerador que indica o formato do texto (veja date.h)
+ * \param zone Fuso do texto (NULL para o fuso local)
+ * \param seconds Ponteiro onde será guardada a data em segundos desde 1970
+ */
+bool parseDateString(const char* text, size_t length, enum DateString dateString,
+        const TimeZone* zone, time_t* seconds);
+
+/**
+ * Lê uma data no formato ISO-8601/RFC-3339<BR>
+ * Aceita "yyyy-mm-dd" e "yyyy-mm-ddThh:mm[:ss[.fração]]", com 'T', 't' ou
+ * espaço entre data e horário, seguido opcionalmente de 'Z' ou de um
+ * deslocamento (+hh:mm, +hhmm ou +hh). Sem deslocamento, o horário é
+ * interpretado no fuso informado. A fração de segundo é descartada. O
+ * formato fixo "yyyy-mm-ddThh:mm:ss" é lido por um caminho rápido que
+ * converte vários dígitos de uma vez
+ * \return true se o texto estiver no formato e a data for válida
+ * \param text Texto a ser lido
+ * \param length Tamanho do texto (o texto não precisa terminar com '\0')
+ * \param zone Fuso usado quando o texto não traz deslocamento (NULL para o
+ *      fuso local)
+ * \param seconds Ponteiro onde será guardada a data em segundos desde 1970
+ */
+bool parseIsoDate(const char* text, size_t length, const TimeZone* zone,
+        time_t* seconds);
+
+/**
+ * Lê um vetor de datas em um dos formatos de enum DateString
+ * \return Quantidade de datas lidas com sucesso
+ * \param texts Vetor de textos
+ * \param lengths Vetor com o tamanho de cada texto (NULL se os textos
+ *      terminarem com '\0')
+ * \param count Quantidade de textos
+ * \param dateString Enumerador que indica o formato dos textos (veja date.h)
+ * \param zone Fuso dos textos (NULL para o fuso local)
+ * \param seconds Vetor onde serão guardadas as datas (0 para as inválidas)
+ * \param valid Vetor onde será guardado se cada texto foi lido (pode ser NULL)
+ */
+size_t parseDateStringBatch(const char* const* texts, const size_t* lengths,
+        size_t count, enum DateString dateString, const TimeZone* zone,
+        time_t* seconds, bool* valid);
+
+/**
+ * Lê um vetor de datas no formato ISO-8601/RFC-3339
+ * \return Quantidade de datas lidas com sucesso
+ * \param texts Vetor de textos
+ * \param lengths Vetor com o tamanho de cada texto (NULL se os textos
+ *      terminarem com '\0')
+ * \param count Quantidade de textos
+ * \param zone Fuso usado quando o texto não traz deslocamento (NULL para o
+ *      fuso local)
+ * \param seconds Vetor onde serão guardadas as datas (0 para as inválidas)
+ * \param valid Vetor onde será guardado se cada texto foi lido (pode ser NULL)
+ */
+size_t parseIsoDateBatch(const char* const* texts, const size_t* lengths,
+        size_t count, const TimeZone* zone, time_t* seconds, bool* valid);
+
+#endif /* DATEPARSE_H_ */
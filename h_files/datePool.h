@@ -0,0 +1,50 @@
+/**
+ * \file datePool.h
+ * Alocação de objetos Date em blocos<BR>
+ * Um pool reserva memória para vários objetos Date de uma vez e reaproveita
+ * os objetos devolvidos por destroyDate(), evitando um malloc()/free() por
+ * objeto. Um pool não é protegido contra uso simultâneo: use um por thread
+ */
+
+#ifndef DATEPOOL_H_
+#define DATEPOOL_H_
+
+#include <stddef.h>
+#include "date.h"
+
+/**
+ * Estrutura do objeto pool de datas
+ */
+typedef struct datePool DatePool;
+
+/**
+ * Cria um pool de datas
+ * \return Ponteiro para objeto DatePool, ou NULL se não conseguir
+ * \param datesPerBlock Quantidade de objetos Date reservados de cada vez
+ *      (0 para o padrão)
+ */
+DatePool* createDatePool(size_t datesPerBlock);
+
+/**
+ * Desaloca o pool e todos os objetos Date criados por ele
+ * \return NULL
+ * \param pool Ponteiro para objeto DatePool a ser desalocado
+ */
+DatePool* destroyDatePool(DatePool* pool);
+
+/**
+ * Cria um objeto Date a partir do pool<BR>
+ * Não lê o relógio: a data inicial é 1/1/1970 00:00:00 UTC, no fuso local.
+ * O objeto pode ser devolvido ao pool com destroyDate()
+ * \return Ponteiro para objeto Date, ou NULL se não conseguir
+ * \param pool Ponteiro para objeto DatePool
+ */
+Date* createPoolDate(DatePool* pool);
+
+/**
+ * Devolve ao pool um objeto Date criado por ele (usada por destroyDate())
+ * \param date Ponteiro para objeto Date
+ */
+void releasePoolDate(Date* date);
+
+#endif /* DATEPOOL_H_ */
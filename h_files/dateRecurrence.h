@@ -0,0 +1,148 @@
+/**
+ * \file dateRecurrence.h
+ * Regras de recorrência (um subconjunto do RRULE do iCalendar)<BR>
+ * Gera as ocorrências de regras como "toda segunda terça-feira do mês",
+ * "último dia útil do mês" ou "a cada 15 minutos entre 9h e 17h em dias
+ * úteis" com aritmética de calendário, sem mktime() e sem testar dia a dia:
+ * cada nova ocorrência custa tempo constante amortizado
+ */
+
+#ifndef DATERECURRENCE_H_
+#define DATERECURRENCE_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <time.h>
+#include "date.h"
+#include "dateZone.h"
+
+/**
+ * Máscara de dias da semana com um dia (use com enum WeekDay de date.h)
+ */
+#define RECURRENCE_DAY(weekDay) (1u << (weekDay))
+
+/**
+ * Máscara dos dias úteis (segunda a sexta)
+ */
+#define RECURRENCE_WEEK_DAYS (RECURRENCE_DAY(MONDAY) | RECURRENCE_DAY(TUESDAY) \
+        | RECURRENCE_DAY(WEDNESDAY) | RECURRENCE_DAY(THURSDAY) | RECURRENCE_DAY(FRIDAY))
+
+/**
+ * Enumerador da frequência de uma regra de recorrência
+ */
+enum RecurrenceFrequency{
+    RECUR_MINUTELY, ///< a cada interval minutos
+    RECUR_HOURLY, ///< a cada interval horas
+    RECUR_DAILY, ///< a cada interval dias
+    RECUR_WEEKLY, ///< a cada interval semanas (de segunda a domingo)
+    RECUR_MONTHLY, ///< a cada interval meses
+    RECUR_YEARLY ///< a cada interval anos
+};
+
+/**
+ * Regra de recorrência<BR>
+ * Os campos com valor 0 não restringem as ocorrências. Todos os campos são
+ * interpretados no relógio do fuso da recorrência. Nas frequências de dia
+ * para cima, o horário das ocorrências é o horário da data inicial
+ */
+struct recurrenceRule{
+    enum RecurrenceFrequency frequency; ///< frequência
+    unsigned int interval; ///< quantidade de unidades entre os períodos (0 vale 1)
+    /**
+     * Dias da semana permitidos (veja RECURRENCE_DAY()). Em RECUR_WEEKLY
+     * indica os dias de cada semana (0: o dia da semana da data inicial); em
+     * RECUR_MONTHLY e RECUR_YEARLY, sem monthDay e sem position, indica todos
+     * esses dias do mês
+     */
+    unsigned int weekDays;
+    /**
+     * Dia do mês em RECUR_MONTHLY e RECUR_YEARLY (negativo conta do fim: -1
+     * é o último dia). Meses sem esse dia são pulados. 0: o dia da data
+     * inicial. Ignorado se position não for 0
+     */
+    int monthDay;
+    /**
+     * Em RECUR_MONTHLY e RECUR_YEARLY, escolhe só o n-ésimo dia do mês entre
+     * os de weekDays (negativo conta do fim). Exemplos: weekDays terça e
+     * position 2 é a segunda terça-feira; RECURRENCE_WEEK_DAYS e position -1
+     * é o último dia útil
+     */
+    int position;
+    int month; ///< mês em RECUR_YEARLY (1 - 12; 0: o mês da data inicial)
+    /**
+     * Em RECUR_MINUTELY e RECUR_HOURLY, só há ocorrências com o horário
+     * (em segundos desde a meia-noite) em [windowFrom, windowUntil). Sem
+     * efeito se windowUntil for 0
+     */
+    long windowFrom;
+    long windowUntil; ///< fim (exclusivo) da janela diária, veja windowFrom
+    long long count; ///< quantidade máxima de ocorrências (0: sem limite)
+    bool hasUntil; ///< se until limita as ocorrências
+    time_t until; ///< última data permitida (inclusiva), se hasUntil
+};
+
+/**
+ * Regra de recorrência
+ */
+typedef struct recurrenceRule RecurrenceRule;
+
+/**
+ * Estado de uma recorrência sendo percorrida<BR>
+ * A estrutura pode ficar na pilha; os campos são internos e só devem ser
+ * modificados pelas funções deste arquivo
+ */
+struct dateRecurrence{
+    RecurrenceRule rule; ///< regra (com os valores padrão já preenchidos)
+    const TimeZone* zone; ///< fuso das ocorrências
+    long long firstLocal; ///< data inicial no relógio do fuso
+    long long period; ///< primeiro período (dia, segunda-feira da semana ou mês)
+    long long candidate; ///< próxima ocorrência a testar, no relógio do fuso
+    long long produced; ///< quantidade de ocorrências já geradas
+    time_t last; ///< última ocorrência gerada
+    time_t windowFrom; ///< início do intervalo em que offset é válido
+    time_t windowUntil; ///< fim do intervalo em que offset é válido
+    long offset; ///< último deslocamento do fuso consultado
+    bool finished; ///< se não há mais ocorrências
+};
+
+/**
+ * Estado de uma recorrência sendo percorrida
+ */
+typedef struct dateRecurrence DateRecurrence;
+
+/**
+ * Inicia uma recorrência<BR>
+ * A primeira ocorrência é a primeira data maior ou igual a start que
+ * satisfaz a regra
+ * \return false se a regra for inválida
+ * \param recurrence Estado a ser preenchido
+ * \param rule Regra de recorrência (é copiada)
+ * \param start Data inicial em segundos desde 1970
+ * \param zone Fuso da regra (NULL para o fuso local). O fuso deve continuar
+ *      carregado enquanto a recorrência for usada
+ */
+bool startDateRecurrence(DateRecurrence* recurrence, const RecurrenceRule* rule,
+        time_t start, const TimeZone* zone);
+
+/**
+ * Gera a próxima ocorrência<BR>
+ * As ocorrências são sempre crescentes: horários locais que a mudança de
+ * horário de verão leva para um instante já gerado são pulados
+ * \return false se não houver mais ocorrências
+ * \param recurrence Estado iniciado por startDateRecurrence()
+ * \param seconds Ponteiro onde será guardada a ocorrência em segundos desde
+ *      1970
+ */
+bool nextDateRecurrence(DateRecurrence* recurrence, time_t* seconds);
+
+/**
+ * Gera várias ocorrências de uma vez
+ * \return Quantidade de ocorrências geradas (menor que capacity só quando
+ *      não há mais ocorrências)
+ * \param recurrence Estado iniciado por startDateRecurrence()
+ * \param seconds Vetor onde serão guardadas as ocorrências
+ * \param capacity Tamanho do vetor
+ */
+size_t fillDateRecurrence(DateRecurrence* recurrence, time_t* seconds, size_t capacity);
+
+#endif /* DATERECURRENCE_H_ */
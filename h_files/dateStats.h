@@ -0,0 +1,161 @@
+/**
+ * \file dateStats.h
+ * Instrumentação opcional da biblioteca<BR>
+ * Quando a biblioteca é compilada com DATE_STATS definido (make STATS=YES),
+ * cada função pública conta as suas chamadas e guarda um histograma de
+ * latência em escala logarítmica, e alguns caminhos internos caros (como a
+ * decomposição da data e a conversão do horário local) são contados. Os
+ * contadores ficam em memória de cada thread e são atualizados sem
+ * sincronização; getDateStats() soma os de todas as threads. Sem
+ * DATE_STATS as funções deste módulo continuam disponíveis, mas retornam
+ * valores zerados, e a instrumentação não gera código algum<BR>
+ * As chamadas internas também são contadas (setDatePartial() conta uma
+ * chamada de validateDate(), por exemplo)
+ */
+
+#ifndef DATESTATS_H_
+#define DATESTATS_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/**
+ * Quantidade de faixas do histograma de latência<BR>
+ * A faixa 0 guarda as chamadas com menos de 1 ns; a faixa b guarda as
+ * chamadas com latência entre 2^(b-1) e 2^b - 1 ns (a última acumula o resto)
+ */
+#define DATE_STATS_BUCKETS 40
+
+/**
+ * Enumerador dos pontos instrumentados
+ */
+enum DateStat{
+    DATE_STAT_CREATE, ///< createDate()
+    DATE_STAT_SET_TODAY, ///< setDateToday()
+    DATE_STAT_SET_PARTIAL, ///< setDatePartial()
+    DATE_STAT_SET_COMPLETE, ///< setDateComplete()
+    DATE_STAT_SET_SECONDS, ///< setDateOfSeconds()
+    DATE_STAT_GET_COMPONENT, ///< getDateComponent()
+    DATE_STAT_GET_CIVIL_TIME, ///< getDateCivilTime()
+    DATE_STAT_GET_STRING, ///< getStringDate()
+    DATE_STAT_GET_STRING_WEEK_DAY, ///< getStringWeekDay()
+    DATE_STAT_ADD_COMPONENT, ///< addComponentDate()
+    DATE_STAT_ADD_DAYS, ///< addDaysDate()
+    DATE_STAT_ADD_MONTHS, ///< addMonthsDate() e addYearsDate()
+    DATE_STAT_DIFF_DAYS, ///< diffDaysDate()
+    DATE_STAT_DIFF_MONTHS, ///< diffMonthsDate() e diffYearsDate()
+    DATE_STAT_PRINT, ///< printDate()
+    DATE_STAT_PRINT_WEEK, ///< printWeekDate()
+    DATE_STAT_VALIDATE, ///< validateDate()
+    DATE_STAT_PARSE, ///< parseDateString() e parseIsoDate() (veja dateParse.h)
+    DATE_STAT_DECOMPOSE, ///< decomposição da data em componentes (o antigo localtime())
+    DATE_STAT_DECOMPOSE_CACHED, ///< acesso aos componentes já memorizados no objeto
+    DATE_STAT_MAKE_DATE, ///< conversão do horário local em segundos (o antigo mktime())
+    DATE_STAT_MAKE_DATE_FAILURE, ///< conversão do horário local que retornou -1
+    DATE_STAT_VALIDATE_FAILURE, ///< validateDate() que retornou false
+    DATE_STAT_FORMAT_FAILURE, ///< getStringDate() que retornou false
+    DATE_STAT_PARSE_FAILURE, ///< texto que não pôde ser lido
+    DATE_STAT_COUNT ///< quantidade de pontos instrumentados
+};
+
+/**
+ * Estatísticas acumuladas (a soma de todas as threads)
+ */
+struct dateStatsSnapshot{
+    unsigned long long calls[DATE_STAT_COUNT]; ///< quantidade de chamadas ou de eventos
+    unsigned long long nanoseconds[DATE_STAT_COUNT]; ///< tempo total das chamadas
+    unsigned long long latency[DATE_STAT_COUNT][DATE_STATS_BUCKETS]; ///< histogramas de latência
+};
+
+/**
+ * Estatísticas acumuladas
+ */
+typedef struct dateStatsSnapshot DateStatsSnapshot;
+
+/**
+ * Verifica se a biblioteca foi compilada com a instrumentação
+ * \return true se DATE_STATS estava definido
+ */
+bool isDateStatsEnabled(void);
+
+/**
+ * Copia as estatísticas de todas as threads<BR>
+ * Os contadores são lidos sem parar as outras threads, então chamadas em
+ * andamento podem ou não estar incluídas
+ * \param snapshot Ponteiro onde serão guardadas as estatísticas
+ */
+void getDateStats(DateStatsSnapshot* snapshot);
+
+/**
+ * Zera as estatísticas de todas as threads
+ */
+void resetDateStats(void);
+
+/**
+ * Escreve as estatísticas em um arquivo, uma linha por ponto instrumentado
+ * com chamadas, separando as colunas por tabulação: nome, chamadas, tempo
+ * médio, p50 e p99 (limites superiores das faixas do histograma, em ns). Os
+ * eventos, que não têm latência, mostram '-' nas três últimas colunas
+ * \param file Arquivo de saída (stdout, stderr ...)
+ */
+void dumpDateStats(FILE* file);
+
+/**
+ * Retorna o nome de um ponto instrumentado
+ * \return Nome (NULL se o ponto não existir)
+ * \param stat Ponto instrumentado
+ */
+const char* getDateStatName(enum DateStat stat);
+
+/*
+ * Uso interno da biblioteca: marcações dos pontos instrumentados
+ */
+#ifdef DATE_STATS
+
+/**
+ * Medição de uma chamada em andamento
+ */
+struct dateStatTimer{
+    enum DateStat stat; ///< ponto instrumentado
+    long long start; ///< início da chamada em nanossegundos
+};
+
+/**
+ * Inicia a medição de uma chamada
+ * \return Medição em andamento
+ * \param stat Ponto instrumentado
+ */
+struct dateStatTimer startDateStatTimer(enum DateStat stat);
+
+/**
+ * Termina a medição de uma chamada (chamada automaticamente no fim do escopo)
+ * \param timer Medição em andamento
+ */
+void stopDateStatTimer(struct dateStatTimer* timer);
+
+/**
+ * Conta um evento
+ * \param stat Ponto instrumentado
+ */
+void countDateStat(enum DateStat stat);
+
+/**
+ * Mede o restante do escopo atual (todas as saídas da função)
+ */
+#define DATE_STAT_SCOPE(stat) \
+    struct dateStatTimer dateStatTimer __attribute__((cleanup(stopDateStatTimer))) \
+        = startDateStatTimer(stat)
+
+/**
+ * Conta um evento
+ */
+#define DATE_STAT_EVENT(stat) countDateStat(stat)
+
+#else
+
+#define DATE_STAT_SCOPE(stat) ((void) 0)
+#define DATE_STAT_EVENT(stat) ((void) 0)
+
+#endif /* DATE_STATS */
+
+#endif /* DATESTATS_H_ */
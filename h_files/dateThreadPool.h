@@ -0,0 +1,173 @@
+/**
+ * \file dateThreadPool.h
+ * Pool de threads para operações sobre vetores de datas<BR>
+ * O pool mantém threads trabalhadoras fixas (a thread que chama participa
+ * como mais uma) e executa laços paralelos: o intervalo de índices é
+ * dividido em uma parte contígua por thread, cada thread processa a sua parte
+ * em blocos e, ao terminar, rouba blocos do fim das partes das outras. A
+ * divisão é sempre a mesma para a mesma quantidade de itens, e as threads
+ * trabalhadoras ficam presas a CPUs diferentes: vetores de saída alocados e
+ * escritos pela primeira vez por um laço paralelo (ou por
+ * touchDateThreadPool()) têm as suas páginas colocadas no nó NUMA da thread
+ * que vai processá-las.<BR>
+ * Todas as funções aceitam pool NULL e então executam o trabalho na própria
+ * thread, de modo síncrono. Um pool pode ser usado por várias threads (os
+ * laços são executados um de cada vez), mas a função de um laço não pode
+ * usar o mesmo pool
+ */
+
+#ifndef DATETHREADPOOL_H_
+#define DATETHREADPOOL_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "date.h"
+#include "dateZone.h"
+#include "dateBatch.h"
+#include "dateFormat.h"
+
+/**
+ * Estrutura do objeto pool de threads
+ */
+typedef struct dateThreadPool DateThreadPool;
+
+/**
+ * Função executada por um laço paralelo sobre os índices [begin, end)
+ * \param context Ponteiro informado a runDateThreadPool()
+ * \param begin Primeiro índice
+ * \param end Índice seguinte ao último
+ */
+typedef void (*DateRangeFunction)(void* context, size_t begin, size_t end);
+
+/**
+ * Cria um pool de threads
+ * \return Ponteiro para objeto DateThreadPool, ou NULL se faltar memória
+ * \param threads Quantidade de threads, contando a que chama os laços (0 para
+ *      uma por processador; 1 executa tudo de modo síncrono)
+ */
+DateThreadPool* createDateThreadPool(unsigned int threads);
+
+/**
+ * Termina as threads e desaloca o pool
+ * \return NULL
+ * \param pool Ponteiro para objeto DateThreadPool a ser desalocado
+ */
+DateThreadPool* destroyDateThreadPool(DateThreadPool* pool);
+
+/**
+ * Retorna a quantidade de threads do pool, contando a que chama os laços
+ * \return Quantidade de threads (1 para pool NULL)
+ * \param pool Ponteiro para objeto DateThreadPool
+ */
+unsigned int getDateThreadPoolSize(const DateThreadPool* pool);
+
+/**
+ * Executa um laço paralelo sobre os índices [0, count)<BR>
+ * Cada índice é passado uma única vez à função, em intervalos de até grain
+ * índices que começam em múltiplos de grain. Retorna depois que todos os
+ * intervalos forem processados
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para executar na
+ *      própria thread)
+ * \param count Quantidade de índices
+ * \param grain Tamanho dos blocos (0 para o padrão)
+ * \param function Função executada para cada intervalo
+ * \param context Ponteiro repassado à função
+ */
+void runDateThreadPool(DateThreadPool* pool, size_t count, size_t grain,
+        DateRangeFunction function, void* context);
+
+/**
+ * Zera um vetor dividindo-o entre as threads do mesmo modo que um laço
+ * paralelo com a mesma quantidade de itens, para que cada página seja
+ * tocada pela primeira vez pela thread que vai processá-la
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param buffer Vetor recém-alocado
+ * \param count Quantidade de itens
+ * \param itemSize Tamanho de cada item em bytes
+ */
+void touchDateThreadPool(DateThreadPool* pool, void* buffer, size_t count,
+        size_t itemSize);
+
+/**
+ * Decompõe um vetor de datas em paralelo (veja getDateComponentsBatchZone()
+ * em dateBatch.h)
+ * \return false se algum ponteiro obrigatório for NULL, true em caso contrário
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas no vetor
+ * \param components Vetores de saída (componentes NULL são ignorados)
+ */
+bool getDateComponentsBatchParallel(DateThreadPool* pool, const TimeZone* zone,
+        const time_t* seconds, size_t count, DateComponentArrays* components);
+
+/**
+ * Valida um vetor de datas em paralelo (veja validateDatesBatch() em
+ * dateBatch.h)
+ * \return Quantidade de datas válidas (0 se algum ponteiro obrigatório for
+ *      NULL)
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param fields Vetores de entrada (veja struct dateFieldArrays)
+ * \param count Quantidade de datas
+ * \param validMask Vetor com pelo menos (count + 63) / 64 palavras
+ */
+size_t validateDatesBatchParallel(DateThreadPool* pool, const DateFieldArrays* fields,
+        size_t count, uint64_t* validMask);
+
+/**
+ * Lê um vetor de datas em paralelo (veja parseDateStringBatch() em
+ * dateParse.h)
+ * \return Quantidade de datas lidas com sucesso
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param texts Vetor de textos
+ * \param lengths Vetor com o tamanho de cada texto (NULL se os textos
+ *      terminarem com '\0')
+ * \param count Quantidade de textos
+ * \param dateString Enumerador que indica o formato dos textos (veja date.h)
+ * \param zone Fuso dos textos (NULL para o fuso local)
+ * \param seconds Vetor onde serão guardadas as datas (0 para as inválidas)
+ * \param valid Vetor onde será guardado se cada texto foi lido (pode ser NULL)
+ */
+size_t parseDateStringBatchParallel(DateThreadPool* pool, const char* const* texts,
+        const size_t* lengths, size_t count, enum DateString dateString,
+        const TimeZone* zone, time_t* seconds, bool* valid);
+
+/**
+ * Lê um vetor de datas ISO-8601/RFC-3339 em paralelo (veja
+ * parseIsoDateBatch() em dateParse.h)
+ * \return Quantidade de datas lidas com sucesso
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param texts Vetor de textos
+ * \param lengths Vetor com o tamanho de cada texto (NULL se os textos
+ *      terminarem com '\0')
+ * \param count Quantidade de textos
+ * \param zone Fuso usado quando o texto não traz deslocamento (NULL para o
+ *      fuso local)
+ * \param seconds Vetor onde serão guardadas as datas (0 para as inválidas)
+ * \param valid Vetor onde será guardado se cada texto foi lido (pode ser NULL)
+ */
+size_t parseIsoDateBatchParallel(DateThreadPool* pool, const char* const* texts,
+        const size_t* lengths, size_t count, const TimeZone* zone, time_t* seconds,
+        bool* valid);
+
+/**
+ * Formata um vetor de datas em paralelo (veja formatDatesBatchPlan() em
+ * dateFormat.h)
+ * \return Quantidade de datas formatadas
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param texts Memória com count * stride bytes onde os textos serão escritos
+ * \param stride Espaço de cada texto em bytes
+ * \param lengths Vetor onde será guardado o tamanho de cada texto (pode ser
+ *      NULL)
+ */
+size_t formatDatesBatchPlanParallel(DateThreadPool* pool, const DateFormatPlan* plan,
+        const TimeZone* zone, const time_t* seconds, size_t count, char* texts,
+        size_t stride, size_t* lengths);
+
+#endif /* DATETHREADPOOL_H_ */
@@ -0,0 +1,100 @@
+/**
+ * \file dateWriter.h
+ * Escrita de muitas datas em arquivos<BR>
+ * Um DateWriter acumula os textos em memória própria, sem travas, e os
+ * entrega ao destino em blocos grandes: a um FILE* com um único fwrite() por
+ * bloco, ou a um descritor de arquivo com write()/writev(). Textos maiores que
+ * o espaço livre são entregues junto com o bloco pendente, sem cópia. Um
+ * DateWriter não é protegido contra uso simultâneo: use um por thread
+ */
+
+#ifndef DATEWRITER_H_
+#define DATEWRITER_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "date.h"
+#include "dateFormat.h"
+
+/**
+ * Estrutura do objeto de escrita de datas
+ */
+typedef struct dateWriter DateWriter;
+
+/**
+ * Cria um objeto de escrita que entrega os textos a um FILE*<BR>
+ * Os blocos passam pelo FILE* (a ordem em relação a outras escritas no mesmo
+ * FILE* é a ordem das chamadas a flushDateWriter())
+ * \return Ponteiro para objeto DateWriter, ou NULL se file for NULL ou faltar
+ *      memória
+ * \param file Arquivo de destino (não é fechado por destroyDateWriter())
+ * \param capacity Tamanho do bloco em bytes (0 para o padrão)
+ */
+DateWriter* createDateWriter(FILE* file, size_t capacity);
+
+/**
+ * Cria um objeto de escrita que entrega os textos a um descritor de arquivo
+ * com write()/writev()
+ * \return Ponteiro para objeto DateWriter, ou NULL se fd for inválido ou
+ *      faltar memória
+ * \param fd Descritor de destino (não é fechado por destroyDateWriter())
+ * \param capacity Tamanho do bloco em bytes (0 para o padrão)
+ */
+DateWriter* createDateWriterFd(int fd, size_t capacity);
+
+/**
+ * Entrega os textos pendentes e desaloca o objeto de escrita
+ * \return NULL
+ * \param writer Ponteiro para objeto DateWriter a ser desalocado
+ */
+DateWriter* destroyDateWriter(DateWriter* writer);
+
+/**
+ * Retorna o objeto de escrita da thread atual ligado a stdout<BR>
+ * É usado por printDate() e printWeekDate() e não deve ser desalocado
+ * \return Ponteiro para objeto DateWriter
+ */
+DateWriter* getStdoutDateWriter(void);
+
+/**
+ * Entrega os textos pendentes ao destino
+ * \return false se houver erro de escrita (veja errno; os textos pendentes
+ *      são descartados)
+ * \param writer Ponteiro para objeto DateWriter
+ */
+bool flushDateWriter(DateWriter* writer);
+
+/**
+ * Acrescenta um texto qualquer
+ * \return false se houver erro de escrita (veja errno)
+ * \param writer Ponteiro para objeto DateWriter
+ * \param text Texto
+ * \param length Tamanho do texto em bytes
+ */
+bool writeDateText(DateWriter* writer, const char* text, size_t length);
+
+/**
+ * Acrescenta uma data em um dos formatos de enum DateString (o mesmo texto
+ * de formatDate() em dateFormat.h)
+ * \return false se o formato for inválido ou houver erro de escrita
+ * \param writer Ponteiro para objeto DateWriter
+ * \param date Ponteiro para objeto Date
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja date.h)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ */
+bool writeDate(DateWriter* writer, Date** date, enum DateString dateString,
+        bool weekDayName);
+
+/**
+ * Acrescenta uma data formatada com um plano de formatação (o mesmo texto de
+ * formatDatePlan() em dateFormat.h)
+ * \return false se houver erro de escrita ou faltar memória
+ * \param writer Ponteiro para objeto DateWriter
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param date Ponteiro para objeto Date
+ */
+bool writeDatePlan(DateWriter* writer, const DateFormatPlan* plan, Date** date);
+
+#endif /* DATEWRITER_H_ */
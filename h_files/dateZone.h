@@ -0,0 +1,109 @@
+/**
+ * \file dateZone.h
+ * Camada de fuso horário usada pelas conversões de data<BR>
+ * Fornece o deslocamento em relação ao UTC de um instante, junto com o
+ * intervalo em que esse deslocamento continua válido, para que o cálculo
+ * seja feito uma única vez e reaproveitado pelas conversões seguintes<BR>
+ * Os fusos são lidos diretamente dos arquivos TZif do sistema
+ * (/usr/share/zoneinfo), sem passar pela variável TZ nem por tzset(): depois
+ * de carregado, um fuso é somente leitura e as consultas não fazem chamadas
+ * de sistema. As funções podem ser chamadas de várias threads ao mesmo tempo
+ * sem sincronização
+ */
+
+#ifndef DATEZONE_H_
+#define DATEZONE_H_
+
+#include <time.h>
+
+/**
+ * Estrutura do objeto fuso horário
+ * Armazena a tabela de transições de um fuso e a regra usada após a última
+ * transição
+ */
+typedef struct timeZone TimeZone;
+
+/**
+ * Carrega um fuso horário<BR>
+ * O nome pode ser um identificador do banco de fusos ("America/Sao_Paulo"),
+ * o caminho absoluto de um arquivo TZif ou uma regra POSIX ("EST5EDT",
+ * "<-03>3"). Se o nome for NULL, carrega o fuso local (variável TZ ou
+ * /etc/localtime). O diretório do banco pode ser trocado pela variável TZDIR
+ * \return Ponteiro para objeto TimeZone, ou NULL se não conseguir
+ * \param name Nome do fuso
+ */
+TimeZone* loadTimeZone(const char* name);
+
+/**
+ * Desaloca objeto TimeZone
+ * \return NULL
+ * \param zone Ponteiro para objeto TimeZone a ser desalocado
+ */
+TimeZone* destroyTimeZone(TimeZone* zone);
+
+/**
+ * Retorna o nome com que o fuso foi carregado
+ * \return Nome do fuso
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ */
+const char* getTimeZoneName(const TimeZone* zone);
+
+/**
+ * Retorna o deslocamento de um fuso em relação ao UTC em um instante
+ * \return Deslocamento em segundos (positivo a leste de Greenwich)
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ */
+long getZoneUtcOffset(const TimeZone* zone, time_t seconds);
+
+/**
+ * Retorna o deslocamento de um fuso e o intervalo em que ele é válido
+ * \return Deslocamento em segundos (positivo a leste de Greenwich)
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ * \param validFrom Ponteiro onde será guardado o início do intervalo
+ *      (inclusivo). Pode ser NULL
+ * \param validUntil Ponteiro onde será guardado o fim do intervalo
+ *      (inclusivo). Pode ser NULL
+ */
+long getZoneUtcOffsetWindow(const TimeZone* zone, time_t seconds,
+        time_t* validFrom, time_t* validUntil);
+
+/**
+ * Converte segundos do relógio de um fuso em segundos desde 1/1/1970 UTC<BR>
+ * Horários inexistentes ou ambíguos (mudança de horário de verão) são
+ * resolvidos com um dos deslocamentos vizinhos à mudança, como em mktime()
+ * \return Segundos desde 1/1/1970 UTC
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param localSeconds Segundos desde 1/1/1970 00:00:00 no relógio do fuso
+ */
+time_t zoneLocalSecondsToTime(const TimeZone* zone, long long localSeconds);
+
+/**
+ * Retorna o deslocamento do fuso local em relação ao UTC em um instante
+ * \return Deslocamento em segundos (positivo a leste de Greenwich)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ */
+long getUtcOffset(time_t seconds);
+
+/**
+ * Retorna o deslocamento do fuso local e o intervalo em que ele é válido
+ * \return Deslocamento em segundos (positivo a leste de Greenwich)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ * \param validFrom Ponteiro onde será guardado o início do intervalo
+ *      (inclusivo). Pode ser NULL
+ * \param validUntil Ponteiro onde será guardado o fim do intervalo
+ *      (inclusivo). Pode ser NULL
+ */
+long getUtcOffsetWindow(time_t seconds, time_t* validFrom, time_t* validUntil);
+
+/**
+ * Converte segundos do relógio local em segundos desde 1/1/1970 UTC<BR>
+ * Horários inexistentes ou ambíguos (mudança de horário de verão) são
+ * resolvidos com um dos deslocamentos vizinhos à mudança, como em mktime()
+ * \return Segundos desde 1/1/1970 UTC
+ * \param localSeconds Segundos desde 1/1/1970 00:00:00 no relógio local
+ */
+time_t localSecondsToTime(long long localSeconds);
+
+#endif /* DATEZONE_H_ */
@@ -3,20 +3,28 @@
  * Implementação do arquivo date.h
  */
 
+// as versões exportadas dos acessos triviais são definidas aqui
+#define DATE_LIBRARY_SOURCE
 #include "../h_files/date.h"
+#include "../h_files/dateFormat.h"
+#include "../h_files/datePool.h"
+#include "../h_files/dateWriter.h"
+#include "../h_files/dateStats.h"
+#include <limits.h>
 
 /******************************************************************************
- * Estruturas
+ * Constantes
  ******************************************************************************/
 
 /**
- * Estrutura do objeto data
- * Armazena data e hora
+ * Maior quantidade de dias (desde 1970, em módulo) aceita pela aritmética de
+ * calendário, o que mantém o ano dentro de um int
  */
-struct date{
-    // dados em segundos desde 1900
-    time_t data;
-};
+#define CIVIL_DAY_LIMIT 700000000000LL
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
 
 /**
  * enumerador que indica AM ou PM
@@ -62,46 +70,24 @@ int getAmPmSystem(int hour){
 }
 
 /**
- * Imprime o dia da semana de acordo com o valor fornecido
+ * Acrescenta o nome do dia da semana, seguido de um espaço, ao objeto de
+ * escrita de stdout da thread (veja getStdoutDateWriter() em dateWriter.h)
  * \param weekDay Dia da semana (0 - 6, começando pelo Domingo)
  */
 void printWeek(int weekDay){
+    char name[WEEK_DAY_STRING_SIZE + 1];
+    size_t length = formatWeekDay(weekDay, name, WEEK_DAY_STRING_SIZE);
 
-    // imprime uma string de acordo com o dia da semana
-    switch(weekDay){
-    case SUNDAY:
-        printf("Sunday ");
-        break;
-
-    case MONDAY:
-        printf("Monday ");
-        break;
-
-    case TUESDAY:
-        printf("Tuesday ");
-        break;
-
-    case WEDNESDAY:
-        printf("Wednesday ");
-        break;
-
-    case THURSDAY:
-        printf("Thursday ");
-        break;
-
-    case FRIDAY:
-        printf("Friday ");
-        break;
-
-    case SATURDAY:
-        printf("Saturday ");
+    if(length > 0){
+        name[length++] = ' ';
+        writeDateText(getStdoutDateWriter(), name, length);
     }
-
 }
 
 /**
  * Cria data em segundos desde 1900
  * \return Segundos desde 1900
+ * \param zone Fuso dos valores passados (NULL para o fuso local)
  * \param day Dia do mês
  * \param month Mês
  * \param year Ano
@@ -109,23 +95,104 @@ void printWeek(int weekDay){
  * \param minute Minutos
  * \param second Segundos
  */
-time_t makeDate(int day,int month,int year,int hour,int minute,int second){
+time_t makeDate(const TimeZone* zone,int day,int month,int year,int hour,int minute,int second){
 
-    // constrói uma data com os valores passados
-    struct tm tm;
-    tm.tm_mday = day;
-    tm.tm_mon = month - 1;
-    tm.tm_year = year - 1900;
-    tm.tm_hour = hour;
-    tm.tm_min = minute;
-    tm.tm_sec = second;
+    // constrói o relógio local com os valores passados (normalizando excessos)
+    long long localSeconds = secondsFromCivil(day,month,year,hour,minute,second);
 
     // passa para o formato em segundos desde 1900
-    time_t data = mktime(&tm);
+    time_t data = zoneLocalSecondsToTime(zone, localSeconds);
+
+    DATE_STAT_EVENT(DATE_STAT_MAKE_DATE);
+    if(data == -1)
+        DATE_STAT_EVENT(DATE_STAT_MAKE_DATE_FAILURE);
 
     return data;
 }
 
+/**
+ * Guarda uma nova data no objeto, descartando os componentes memorizados<BR>
+ * Aceita datas anteriores a 1970 (veja date.h)
+ * \param date Ponteiro para objeto Date
+ * \param data Data em segundos desde 1970
+ */
+void storeDate(Date** date, time_t data){
+    (*date)->data = data;
+    (*date)->nanoseconds = 0;
+    (*date)->decomposed = false;
+}
+
+/**
+ * Decompõe a data em seus componentes no fuso local<BR>
+ * A decomposição é feita somente no primeiro acesso após a data mudar; os
+ * acessos seguintes reaproveitam os componentes guardados no objeto
+ * \param date Ponteiro para objeto Date
+ * \param civil Ponteiro para a estrutura a ser preenchida
+ */
+static void decomposeDate(Date** date, CivilTime* civil){
+    Date* object = *date;
+
+    if(object->decomposed)
+        DATE_STAT_EVENT(DATE_STAT_DECOMPOSE_CACHED);
+    else{
+        DATE_STAT_EVENT(DATE_STAT_DECOMPOSE);
+        object->offset = (int32_t) getZoneUtcOffset(object->zone, object->data);
+        civilTimeFromSeconds((long long) object->data + object->offset, &object->civil);
+        object->decomposed = true;
+    }
+
+    *civil = object->civil;
+}
+
+/**
+ * Retorna o horário de um componente de data em segundos desde a meia-noite
+ * \return Segundos desde a meia-noite
+ * \param civil Componentes da data
+ */
+static long secondOfDay(const CivilTime* civil){
+    return civil->hour * 3600L + civil->minute * 60L + civil->second;
+}
+
+/**
+ * Guarda no objeto o dia informado com o horário local dos componentes
+ * \return false se o dia estiver fora da faixa suportada
+ * \param date Ponteiro para objeto Date
+ * \param days Dia em dias desde 1970 (relógio local)
+ * \param civil Componentes de onde vem o horário
+ */
+static bool storeCivilDay(Date** date, long long days, const CivilTime* civil){
+    if(days > CIVIL_DAY_LIMIT || days < -CIVIL_DAY_LIMIT)
+        return false;
+
+    storeDate(date, zoneLocalSecondsToTime((*date)->zone,
+            days * SECONDS_PER_DAY + secondOfDay(civil)));
+    return true;
+}
+
+/**
+ * Conta os meses inteiros entre dois componentes de data, sendo o primeiro
+ * anterior (ou igual) ao segundo
+ * \return Meses inteiros (0 ou mais)
+ * \param earlier Componentes da data inicial
+ * \param later Componentes da data final
+ */
+static long long wholeMonths(const CivilTime* earlier, const CivilTime* later){
+    long long months = ((long long) later->year - earlier->year) * 12
+            + (later->month - earlier->month);
+    int day = earlier->mday;
+    int lastDay = daysInMonth(later->year, later->month);
+
+    // o dia inicial que não existe no mês final conta como o fim desse mês
+    if(day > lastDay)
+        day = lastDay;
+
+    if(months > 0 && (later->mday < day
+            || (later->mday == day && secondOfDay(later) < secondOfDay(earlier))))
+        months--;
+
+    return months;
+}
+
 /****************************************************************************
  * Funções públicas
  ****************************************************************************/
@@ -136,8 +203,14 @@ time_t makeDate(int day,int month,int year,int hour,int minute,int second){
  * \return Ponteiro para objeto Date
  */
 Date* createDate(){
+    DATE_STAT_SCOPE(DATE_STAT_CREATE);
     // aloca objeto Date
     Date* date = malloc(sizeof(Date));
+    if(date == NULL)
+        return NULL;
+    // inicializa sem ler o relógio e marca como alocado por createDate()
+    initDate(date);
+    date->storage = DATE_STORAGE_HEAP;
     // configura data para hoje
     setDateToday(&date);
     // retorna ponteiro para Date
@@ -145,24 +218,130 @@ Date* createDate(){
 }
 
 /**
- * Desaloca objeto Date
+ * Desaloca objeto Date<BR>
+ * Objetos criados por um DatePool voltam para o pool, e objetos guardados em
+ * memória do chamador (initDate(), createDateArray()) não são liberados. Não
+ * deve ser chamada para uma cópia feita por atribuição (veja copyDate())
  * \return NULL
  * \param date Ponteiro para objeto Date a ser desalocado
  */
 Date* destroyDate(Date* date){
-    // libera memória de date
-    free(date);
+    if(date == NULL)
+        return NULL;
+
+    // cada objeto é devolvido para quem forneceu a sua memória
+    switch(date->storage){
+    case DATE_STORAGE_HEAP:
+        free(date);
+        break;
+    case DATE_STORAGE_POOL:
+        releasePoolDate(date);
+        break;
+    default:
+        // memória do chamador (pilha, vetor ou outra estrutura): nada a liberar
+        break;
+    }
     // retorna NULL
     return NULL;
 }
 
 /**
- * Configura a data para a data atual
+ * Inicializa um objeto Date guardado em memória do chamador (pilha, vetor ou
+ * dentro de outra estrutura)<BR>
+ * Não lê o relógio: a data inicial é 1/1/1970 00:00:00 UTC, no fuso local.
+ * Chamar destroyDate() para esse objeto não libera memória
+ * \param date Ponteiro para o objeto a ser inicializado
+ */
+void initDate(Date* date){
+    memset(date, 0, sizeof(Date));
+    date->zone = NULL;
+    date->storage = DATE_STORAGE_INLINE;
+}
+
+/**
+ * Inicializa um objeto Date guardado em memória do chamador com uma data
+ * \return false se os segundos forem negativos (a data fica em 1/1/1970)
+ * \param date Ponteiro para o objeto a ser inicializado
+ * \param seconds Segundos desde 1970
+ */
+bool initDateOfSeconds(Date* date, time_t seconds){
+    initDate(date);
+    return setDateOfSeconds(&date, seconds);
+}
+
+/**
+ * Copia a data, o fuso e os componentes memorizados de um objeto Date para
+ * outro<BR>
+ * O destino mantém a origem da sua memória, de modo que destroyDate()
+ * continua valendo para ele. Use esta função em vez de atribuição direta
+ * (*to = *from), que leva junto a origem da memória de from
+ * \param to Ponteiro para o objeto de destino (já inicializado por
+ *      createDate(), initDate(), createDateArray() ou createPoolDate())
+ * \param from Ponteiro para o objeto de origem
+ */
+void copyDate(Date* to, const Date* from){
+    unsigned char storage = to->storage;
+
+    if(to == from)
+        return;
+
+    *to = *from;
+    // a memória continua sendo de quem forneceu o destino
+    to->storage = storage;
+}
+
+/**
+ * Cria um vetor contíguo de objetos Date, com uma única alocação<BR>
+ * Os objetos são inicializados como em initDate(). Chamar destroyDate() para
+ * um elemento não libera memória; o vetor inteiro é liberado por
+ * destroyDateArray()
+ * \return Ponteiro para o primeiro objeto, ou NULL se não conseguir
+ * \param count Quantidade de objetos
+ */
+Date* createDateArray(size_t count){
+    Date* dates;
+    size_t i;
+
+    if(count == 0 || count > SIZE_MAX / sizeof(Date))
+        return NULL;
+
+    dates = malloc(count * sizeof(Date));
+    if(dates == NULL)
+        return NULL;
+
+    for(i = 0; i < count; i++)
+        initDate(&dates[i]);
+
+    return dates;
+}
+
+/**
+ * Desaloca um vetor criado por createDateArray()
+ * \return NULL
+ * \param dates Ponteiro para o primeiro objeto do vetor
+ */
+Date* destroyDateArray(Date* dates){
+    free(dates);
+    return NULL;
+}
+
+/**
+ * Configura a data para a data atual<BR>
+ * A data é lida na fonte escolhida por setDateClock() (veja dateClock.h); com
+ * qualquer fonte exceto DATE_CLOCK_TIME a fração de segundo também é
+ * guardada (veja getDateNanoseconds())
  * \param date Ponteiro para objeto Date a ter a data configurada
  */
 void setDateToday(Date** date){
+    DATE_STAT_SCOPE(DATE_STAT_SET_TODAY);
+    time_t seconds;
+    long nanoseconds;
+
+    // lê a data atual na fonte escolhida
+    readDateClock(&seconds, &nanoseconds);
     // configura data atual no objeto Date
-    (*date)->data = time(0);
+    storeDate(date, seconds);
+    (*date)->nanoseconds = (int32_t) nanoseconds;
 }
 
 /**
@@ -174,16 +353,17 @@ void setDateToday(Date** date){
  * \param year Ano
  */
 bool setDatePartial(Date** date, int day, int month, int year){
+    DATE_STAT_SCOPE(DATE_STAT_SET_PARTIAL);
 
     if(!validateDate(day,month,year,0,0,0)) return false;
 
     // constrói uma data com os valores passados
-    time_t data = makeDate(day,month,year,0,0,0);
+    time_t data = makeDate((*date)->zone,day,month,year,0,0,0);
 
     // se conseguiu passar para segundos ...
     if(data != -1){
         // sucesso
-        (*date)->data = data;
+        storeDate(date, data);
         return true;
     }
     // caso contrário retorna false
@@ -205,16 +385,17 @@ bool setDatePartial(Date** date, int day, int month, int year){
  */
 bool setDateComplete(Date** date, int day, int month, int year,
         int hour, int minute, int second){
+    DATE_STAT_SCOPE(DATE_STAT_SET_COMPLETE);
 
     if(!validateDate(day,month,year,hour,minute,second))return false;
 
     // constrói uma data com os valores passados
-    time_t data = makeDate(day,month,year,hour,minute,second);
+    time_t data = makeDate((*date)->zone,day,month,year,hour,minute,second);
 
     // se conseguiu passar para segundos ...
     if(data != -1){
         // sucesso
-        (*date)->data = data;
+        storeDate(date, data);
         return true;
     }
     // caso contrário retorna false
@@ -230,13 +411,14 @@ bool setDateComplete(Date** date, int day, int month, int year,
  * \param seconds Segundos desde 1900
  */
 bool setDateOfSeconds(Date** date, time_t seconds){
+    DATE_STAT_SCOPE(DATE_STAT_SET_SECONDS);
     // se segundos menores que zero, retorna false
     if(seconds<0)
         return false;
     // caso contrário...
     else{
         // define nova data e retorna sucesso
-        (*date)->data = seconds;
+        storeDate(date, seconds);
         return true;
     }
 }
@@ -251,6 +433,40 @@ time_t getDateInSeconds(Date** date){
     return (*date)->data;
 }
 
+/**
+ * Retorna a fração de segundo da data<BR>
+ * Somente setDateToday() guarda a fração; as demais funções que mudam a data
+ * a zeram
+ * \return Nanossegundos (0 - 999999999)
+ * \param date Ponteiro para objeto Date
+ */
+long getDateNanoseconds(Date** date){
+    return (*date)->nanoseconds;
+}
+
+/**
+ * Define o fuso horário usado nas conversões da data<BR>
+ * O instante guardado não muda, somente a forma como ele é decomposto
+ * (dia, hora ...) e como os componentes são convertidos de volta. O fuso
+ * deve continuar carregado enquanto o objeto Date o utilizar
+ * \param date Ponteiro para objeto Date
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ */
+void setDateTimeZone(Date** date, const TimeZone* zone){
+    (*date)->zone = zone;
+    // os componentes memorizados eram de outro fuso
+    (*date)->decomposed = false;
+}
+
+/**
+ * Retorna o fuso horário usado nas conversões da data
+ * \return Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param date Ponteiro para objeto Date
+ */
+const TimeZone* getDateTimeZone(Date** date){
+    return (*date)->zone;
+}
+
 /**
  * Retorna um componente da data (dia, mês, ano, hora ...)
  * \return -1 se, por algum motivo, não conseguir retorna o solicitado<BR>
@@ -267,34 +483,46 @@ time_t getDateInSeconds(Date** date){
  *      a ser retornada (veja o enumerador neste header file)
  */
 int getDateComponent(Date** date, enum DateComponent dateComponent){
+    DATE_STAT_SCOPE(DATE_STAT_GET_COMPONENT);
     
-    struct tm* tm = localtime(&((*date)->data));
+    CivilTime civil;
+    decomposeDate(date, &civil);
     
     switch(dateComponent){
     case MDAY:
-        return tm->tm_mday;
+        return civil.mday;
     case YDAY:
-        return tm->tm_yday;
+        return civil.yday;
     case WDAY:
-        return tm->tm_wday;
+        return civil.wday;
     case MONTH:
-        return (tm->tm_mon + 1);
+        return civil.month;
     case YEAR:
-        return (tm->tm_year + 1900);
+        return civil.year;
     case HOUR:
-        return tm->tm_hour;
+        return civil.hour;
     case HOUR_AMPM:
-        return getHourInAmPm(tm->tm_hour);
+        return getHourInAmPm(civil.hour);
     case MINUTE:
-        return tm->tm_min;
+        return civil.minute;
     case SECOND:
-        return tm->tm_sec;
+        return civil.second;
     default:
         return -1;
     }
     
 }
 
+/**
+ * Retorna todos os componentes da data de uma vez
+ * \param date Ponteiro para objeto Date
+ * \param civil Ponteiro para a estrutura a ser preenchida (veja dateCivil.h)
+ */
+void getDateCivilTime(Date** date, CivilTime* civil){
+    DATE_STAT_SCOPE(DATE_STAT_GET_CIVIL_TIME);
+    decomposeDate(date, civil);
+}
+
 /**
  * Gera uma string e guarda o resultado na memória onde o ponteiro fornecido
  * aponta<BR>
@@ -309,90 +537,14 @@ int getDateComponent(Date** date, enum DateComponent dateComponent){
  */
 bool getStringDate(Date** date, enum DateString dateString,
         bool weekDayName, char* dateStringComp){
-    
-    struct tm* tm = localtime(&((*date)->data));
-    int day,month,year,hour,min,sec;
-    char ampm[3];
-    
-    if(dateString==DATE_DMY || dateString==DATE_YMD || dateString==DATE_DMY_HMS
-        || dateString==DATE_YMD_HMS || dateString==DATE_DMY_HMS_AMPM
-        || dateString==DATE_YMD_HMS_AMPM){
-        day = tm->tm_mday;
-        month = tm->tm_mon+1;
-        year = tm->tm_year+1900;
-    }
-    
-    if(dateString==DATE_HMS || dateString==DATE_DMY_HMS || dateString==DATE_YMD_HMS){
-        hour = tm->tm_hour;
-        min = tm->tm_min;
-        sec = tm->tm_sec;
-    }
-    
-    if(dateString==DATE_HMS_AMPM || dateString==DATE_DMY_HMS_AMPM
-        || dateString==DATE_YMD_HMS_AMPM){
-        hour = getHourInAmPm(tm->tm_hour);
-        min = tm->tm_min;
-        sec = tm->tm_sec;
-        strcpy(ampm,(getAmPmSystem(tm->tm_hour)==AM_SYSTEM ? "AM\0":"PM\0"));
-    }
-    
+    DATE_STAT_SCOPE(DATE_STAT_GET_STRING);
 
-    switch(dateString){
-    
-    case DATE_DMY:
-        if(sprintf(dateStringComp,"%d/%d/%d%c",day,month,year,0) < 0)return false;
-        break;
-    case DATE_YMD:
-        if(sprintf(dateStringComp,"%d/%d/%d%c",year,month,day,0) < 0)return false;
-        break;
-    case DATE_HMS:
-        if(sprintf(dateStringComp,"%d:%d:%d%c",hour,min,sec,0) < 0)return false;
-        break;
-    case DATE_HMS_AMPM:
-        if(sprintf(dateStringComp,"%d:%d:%d %s%c",hour,min,sec,ampm,0) < 0)return false;
-        break;
-    case DATE_DMY_HMS:
-        if(sprintf(dateStringComp,"%d/%d/%d %d:%d:%d%c",day,month,year,hour,min,sec,0) < 0)return false;
-        break;
-    case DATE_YMD_HMS:
-        if(sprintf(dateStringComp,"%d/%d/%d %d:%d:%d%c",year,month,day,hour,min,sec,0) < 0)return false;
-        break;
-    case DATE_DMY_HMS_AMPM:
-        if(sprintf(dateStringComp,"%d/%d/%d %d:%d:%d %s%c",day,month,year,hour,min,sec,ampm,0) < 0)
-            return false;
-        break;
-    case DATE_YMD_HMS_AMPM:
-        if(sprintf(dateStringComp,"%d/%d/%d %d:%d:%d %s%c",year,month,day,hour,min,sec,ampm,0) < 0)
-            return false;
-    }
-    
-    if(weekDayName){
-        
-        switch(tm->tm_wday){
-        case SUNDAY:
-            if(sprintf(dateStringComp,"%s Sunday%c",dateStringComp,0) < 0)return false;
-            break;
-        case MONDAY:
-            if(sprintf(dateStringComp,"%s Monday%c",dateStringComp,0) < 0)return false;
-            break;
-        case TUESDAY:
-            if(sprintf(dateStringComp,"%s Tuesday%c",dateStringComp,0) < 0)return false;
-            break;
-        case WEDNESDAY:
-            if(sprintf(dateStringComp,"%s Wednesday%c",dateStringComp,0) < 0)return false;
-            break;
-        case THURSDAY:
-            if(sprintf(dateStringComp,"%s Thursday%c",dateStringComp,0) < 0)return false;
-            break;
-        case FRIDAY:
-            if(sprintf(dateStringComp,"%s Friday%c",dateStringComp,0) < 0)return false;
-            break;
-        case SATURDAY:
-            if(sprintf(dateStringComp,"%s Saturday%c",dateStringComp,0) < 0)return false;
-        }
-    }
-    
-    return true;
+    // a capacidade mínima documentada cobre qualquer formato
+    if(formatDate(date, dateString, weekDayName, dateStringComp, DATE_STRING_SIZE) > 0)
+        return true;
+
+    DATE_STAT_EVENT(DATE_STAT_FORMAT_FAILURE);
+    return false;
 
 }
 
@@ -405,33 +557,12 @@ bool getStringDate(Date** date, enum DateString dateString,
  * \param dateStringComp Ponteiro para string literal
  */
 bool getStringWeekDay(Date** date, char* stringComp){
+    DATE_STAT_SCOPE(DATE_STAT_GET_STRING_WEEK_DAY);
 
-    struct tm* tm = localtime(&((*date)->data));
+    CivilTime civil;
+    decomposeDate(date, &civil);
 
-    switch(tm->tm_wday){
-    case SUNDAY:
-        if(sprintf(stringComp,"Sunday%c",0) < 0)return false;
-        break;
-    case MONDAY:
-        if(sprintf(stringComp,"Monday%c",0) < 0)return false;
-        break;
-    case TUESDAY:
-        if(sprintf(stringComp,"Tuesday%c",0) < 0)return false;
-        break;
-    case WEDNESDAY:
-        if(sprintf(stringComp,"Wednesday%c",0) < 0)return false;
-        break;
-    case THURSDAY:
-        if(sprintf(stringComp,"Thursday%c",0) < 0)return false;
-        break;
-    case FRIDAY:
-        if(sprintf(stringComp,"Friday%c",0) < 0)return false;
-        break;
-    case SATURDAY:
-        if(sprintf(stringComp,"Saturday%c",0) < 0)return false;
-    }
-
-    return true;
+    return formatWeekDay(civil.wday, stringComp, WEEK_DAY_STRING_SIZE) > 0;
 }
 
 /**
@@ -440,6 +571,7 @@ bool getStringWeekDay(Date** date, char* stringComp){
  * anos que resulte em um ano não bissexto, o resultado será em uma data diferente de 29 de
  * fevereiro. O mesmo acontece quando adicionamos meses e estamos no dia 31 (afinal, nem todos os
  * meses possuem 31 dias) ou mesmo 30 e caímos em fevereiro (que tem 28/29 dias).
+ * Para escolher o comportamento nesses casos, use addMonthsDate() ou addYearsDate().
  * \return false se não conseguir, e true em caso contrário
  * \param date Ponteiro para o objeto Date
  * \param dateComponent Enumerador que indica a parte da data
@@ -448,50 +580,55 @@ bool getStringWeekDay(Date** date, char* stringComp){
  * \param add Se true, adiciona. se false, subtrai
  */
 bool addComponentDate(Date** date, enum DateComponent dateComponent, int value, bool add){
-    struct tm* tm = localtime(&((*date)->data));
+    DATE_STAT_SCOPE(DATE_STAT_ADD_COMPONENT);
+    CivilTime civil;
+    decomposeDate(date, &civil);
 
+    // assim como em mktime(), dia do ano e dia da semana não entram na
+    // recomposição da data
     switch(dateComponent){
     case MDAY:
-        if(add) tm->tm_mday += value;
-        else tm->tm_mday -= value;
+        if(add) civil.mday += value;
+        else civil.mday -= value;
         break;
     case YDAY:
-        if(add) tm->tm_yday += value;
-        else tm->tm_yday -= value;
+        if(add) civil.yday += value;
+        else civil.yday -= value;
         break;
     case WDAY:
-        if(add) tm->tm_wday += value;
-        else tm->tm_wday -= value;
+        if(add) civil.wday += value;
+        else civil.wday -= value;
         break;
     case MONTH:
-        if(add) tm->tm_mon += value;
-        else tm->tm_mon -= value;
+        if(add) civil.month += value;
+        else civil.month -= value;
         break;
     case YEAR:
-        if(add) tm->tm_year += value;
-        else tm->tm_year -= value;
+        if(add) civil.year += value;
+        else civil.year -= value;
         break;
     case HOUR:
-        if(add) tm->tm_hour += value;
-        else tm->tm_hour -= value;
+        if(add) civil.hour += value;
+        else civil.hour -= value;
         break;
     case HOUR_AMPM:
-        if(add) tm->tm_hour += value;
-        else tm->tm_hour -= value;
+        if(add) civil.hour += value;
+        else civil.hour -= value;
         break;
     case MINUTE:
-        if(add) tm->tm_min += value;
-        else tm->tm_min -= value;
+        if(add) civil.minute += value;
+        else civil.minute -= value;
         break;
     case SECOND:
-        if(add) tm->tm_sec += value;
-        else tm->tm_sec -= value;
+        if(add) civil.second += value;
+        else civil.second -= value;
     }
 
-    time_t date2 = mktime(tm);
+    time_t date2 = makeDate((*date)->zone,civil.mday,civil.month,civil.year,
+            civil.hour,civil.minute,civil.second);
 
     if(date2 != -1){
-        (*date)->data = date2;
+        storeDate(date, date2);
         return true;
     }
     else
@@ -499,75 +636,173 @@ bool addComponentDate(Date** date, enum DateComponent dateComponent, int value,
 }
 
 /**
- * Imprime no prompt a data em um formato pré-especificado
- * \param date Ponteiro para objeto Date
- * \param dateString Enumerador que indica qual o formato da string
- *      a ser utilizado (veja o enumerador neste header file)
- * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ * Adiciona (ou subtrai) dias à data, mantendo o horário local<BR>
+ * Usa aritmética de calendário (tempo constante), sem mktime()
+ * \return false se o resultado sair da faixa suportada (a data não muda)
+ * \param date Ponteiro para o objeto Date
+ * \param days Quantidade de dias (negativa para subtrair)
  */
-void printDate(Date** date, enum DateString dateString, bool weekDayName){
-    // coloca data em uma estrutura struct tm (ver time.h)
-    struct tm* tm = localtime(&((*date)->data));
+bool addDaysDate(Date** date, long long days){
+    DATE_STAT_SCOPE(DATE_STAT_ADD_DAYS);
+    CivilTime civil;
 
-    // imprime de acordo com o formato determinado em dateString
-    switch(dateString){
+    if(days > CIVIL_DAY_LIMIT || days < -CIVIL_DAY_LIMIT)
+        return false;
 
-    case DATE_DMY:
-        printf("%d/%d/%d ",tm->tm_mday,tm->tm_mon+1,tm->tm_year+1900);
-        break;
+    decomposeDate(date, &civil);
+    return storeCivilDay(date, daysFromCivil(civil.year, civil.month, civil.mday) + days,
+            &civil);
+}
 
-    case DATE_YMD:
-        printf("%d/%d/%d ",tm->tm_year+1900,tm->tm_mon+1,tm->tm_mday);
-        break;
+/**
+ * Adiciona (ou subtrai) meses à data, mantendo o horário local<BR>
+ * Usa aritmética de calendário (tempo constante), sem mktime()
+ * \return false se o resultado sair da faixa suportada (a data não muda)
+ * \param date Ponteiro para o objeto Date
+ * \param months Quantidade de meses (negativa para subtrair)
+ * \param overflow O que fazer quando o dia não existe no mês de destino
+ */
+bool addMonthsDate(Date** date, long long months, enum MonthOverflow overflow){
+    DATE_STAT_SCOPE(DATE_STAT_ADD_MONTHS);
+    CivilTime civil;
+    long long index;
+    int year, month, day, lastDay;
 
-    case DATE_HMS:
-        printf("%d:%d:%d ",tm->tm_hour,tm->tm_min,tm->tm_sec);
-        break;
+    if(months > (long long) INT_MAX || months < -(long long) INT_MAX)
+        return false;
 
-    case DATE_HMS_AMPM:
-        printf("%d:%d:%d ",getHourInAmPm(tm->tm_hour),tm->tm_min,tm->tm_sec);
-        if(getAmPmSystem(tm->tm_hour) == AM_SYSTEM)
-            printf("AM ");
-        else
-            printf("PM ");
-        break;
+    decomposeDate(date, &civil);
 
-    case DATE_DMY_HMS:
-        printf("%d/%d/%d %d:%d:%d ",tm->tm_mday,tm->tm_mon+1,tm->tm_year+1900,
-                tm->tm_hour,tm->tm_min,tm->tm_sec);
-        break;
+    // meses contados a partir de janeiro do ano 0
+    index = (long long) civil.year * 12 + (civil.month - 1) + months;
+    year = (int) ((index >= 0 ? index : index - 11) / 12);
+    month = (int) (index - (long long) year * 12) + 1;
 
-    case DATE_YMD_HMS:
-        printf("%d/%d/%d %d:%d:%d ",tm->tm_year+1900,tm->tm_mon+1,tm->tm_mday,
-                tm->tm_hour,tm->tm_min,tm->tm_sec);
-        break;
+    day = civil.mday;
+    lastDay = daysInMonth(year, month);
+    if(day > lastDay && overflow == MONTH_CLAMP)
+        day = lastDay;
 
-    case DATE_DMY_HMS_AMPM:
-        printf("%d/%d/%d %d:%d:%d ",tm->tm_mday,tm->tm_mon+1,tm->tm_year+1900,
-                getHourInAmPm(tm->tm_hour),tm->tm_min,tm->tm_sec);
-        if(getAmPmSystem(tm->tm_hour) == AM_SYSTEM)
-            printf("AM ");
-        else
-            printf("PM");
-        break;
+    // com MONTH_OVERFLOW os dias excedentes passam para o mês seguinte
+    return storeCivilDay(date, daysFromCivil(year, month, 1) + (day - 1), &civil);
+}
+
+/**
+ * Adiciona (ou subtrai) anos à data, mantendo o horário local<BR>
+ * O 29 de fevereiro segue a regra de overflow (28/02 ou 01/03 em anos não
+ * bissextos)
+ * \return false se o resultado sair da faixa suportada (a data não muda)
+ * \param date Ponteiro para o objeto Date
+ * \param years Quantidade de anos (negativa para subtrair)
+ * \param overflow O que fazer quando o dia não existe no mês de destino
+ */
+bool addYearsDate(Date** date, long long years, enum MonthOverflow overflow){
+    if(years > INT_MAX / 12 || years < -(INT_MAX / 12))
+        return false;
+
+    return addMonthsDate(date, years * 12, overflow);
+}
+
+/**
+ * Retorna a quantidade de dias inteiros entre duas datas<BR>
+ * Compara as datas e os horários locais (cada data no seu fuso): de 10/03
+ * 15:00 a 12/03 14:00 há 1 dia inteiro
+ * \return Dias inteiros (negativo se to for anterior a from)
+ * \param from Ponteiro para o objeto Date inicial
+ * \param to Ponteiro para o objeto Date final
+ */
+long long diffDaysDate(Date** from, Date** to){
+    DATE_STAT_SCOPE(DATE_STAT_DIFF_DAYS);
+    CivilTime start, end;
+    long long days;
+
+    decomposeDate(from, &start);
+    decomposeDate(to, &end);
+
+    days = daysFromCivil(end.year, end.month, end.mday)
+            - daysFromCivil(start.year, start.month, start.mday);
+
+    // o último dia só conta se o horário final foi alcançado
+    if(days > 0 && secondOfDay(&end) < secondOfDay(&start))
+        days--;
+    else if(days < 0 && secondOfDay(&end) > secondOfDay(&start))
+        days++;
+
+    return days;
+}
+
+/**
+ * Retorna a quantidade de meses inteiros entre duas datas<BR>
+ * Um mês está completo quando o mesmo dia e horário são alcançados no mês
+ * final, ou o fim desse mês quando ele não tem o dia inicial (de 31/01 a
+ * 28/02 há 1 mês), o que corresponde a addMonthsDate() com MONTH_CLAMP
+ * \return Meses inteiros (negativo se to for anterior a from)
+ * \param from Ponteiro para o objeto Date inicial
+ * \param to Ponteiro para o objeto Date final
+ */
+long long diffMonthsDate(Date** from, Date** to){
+    DATE_STAT_SCOPE(DATE_STAT_DIFF_MONTHS);
+    CivilTime start, end;
+    long long startSeconds, endSeconds;
+
+    decomposeDate(from, &start);
+    decomposeDate(to, &end);
+
+    startSeconds = daysFromCivil(start.year, start.month, start.mday) * SECONDS_PER_DAY
+            + secondOfDay(&start);
+    endSeconds = daysFromCivil(end.year, end.month, end.mday) * SECONDS_PER_DAY
+            + secondOfDay(&end);
+
+    // conta sempre da data anterior para a posterior
+    if(endSeconds < startSeconds)
+        return -wholeMonths(&end, &start);
 
-    case DATE_YMD_HMS_AMPM:
-        printf("%d/%d/%d %d:%d:%d ",tm->tm_year+1900,tm->tm_mon+1,tm->tm_mday,
-                getHourInAmPm(tm->tm_hour),tm->tm_min,tm->tm_sec);
-        if(getAmPmSystem(tm->tm_hour) == AM_SYSTEM)
-            printf("AM ");
-        else
-            printf("PM ");
+    return wholeMonths(&start, &end);
+}
+
+/**
+ * Retorna a quantidade de anos inteiros entre duas datas (veja
+ * diffMonthsDate())
+ * \return Anos inteiros (negativo se to for anterior a from)
+ * \param from Ponteiro para o objeto Date inicial
+ * \param to Ponteiro para o objeto Date final
+ */
+long long diffYearsDate(Date** from, Date** to){
+    return diffMonthsDate(from, to) / 12;
+}
+
+/**
+ * Imprime no prompt a data em um formato pré-especificado
+ * \param date Ponteiro para objeto Date
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja o enumerador neste header file)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ */
+void printDate(Date** date, enum DateString dateString, bool weekDayName){
+    DATE_STAT_SCOPE(DATE_STAT_PRINT);
+    DateWriter* out = getStdoutDateWriter();
+    char text[DATE_STRING_SIZE];
+    size_t length;
+    CivilTime civil;
+
+    // decompõe a data em seus componentes
+    decomposeDate(date, &civil);
+
+    // o texto de formatCivilTime(), seguido de um espaço
+    length = formatCivilTime(&civil, dateString, false, text, sizeof(text));
+    if(length > 0){
+        text[length++] = ' ';
+        writeDateText(out, text, length);
     }
 
-    // imprime o nome do dia da semana, se foi solicitado
+    // o nome do dia da semana, se foi solicitado
     if(weekDayName){
-        printWeek(tm->tm_wday);
+        printWeek(civil.wday);
     }
 
-    // dá quebra de linha
-    printf("\n");
-
+    // a linha inteira vai para stdout com um único fwrite()
+    writeDateText(out, "\n", 1);
+    flushDateWriter(out);
 }
 
 /**
@@ -575,13 +810,18 @@ void printDate(Date** date, enum DateString dateString, bool weekDayName){
  * \param date Ponteiro para o objeto Date
  */
 void printWeekDate(Date** date){
-    struct tm* tm = localtime(&((*date)->data));
+    DATE_STAT_SCOPE(DATE_STAT_PRINT_WEEK);
+    CivilTime civil;
+    decomposeDate(date, &civil);
 
-    printWeek(tm->tm_wday);
+    printWeek(civil.wday);
+    flushDateWriter(getStdoutDateWriter());
 }
 
 /**
- * Verifica se uma data é válida
+ * Verifica se uma data é válida no calendário gregoriano<BR>
+ * Para validar muitas datas de uma vez, use validateDatesBatch() (veja
+ * dateBatch.h)
  * \return false em caso negativo
  * \param day Dia
  * \param month Mês
@@ -591,40 +831,27 @@ void printWeekDate(Date** date){
  * \param second Segundo
  */
 bool validateDate(int day,int month,int year,int hour,int minute,int second){
+    DATE_STAT_SCOPE(DATE_STAT_VALIDATE);
+    bool valid = true;
 
     // primeira checagem
     if(second<0 || second>59)
-        return false;
+        valid = false;
     else if(minute<0 || minute>59)
-        return false;
+        valid = false;
     else if(hour<0 || hour>23)
-        return false;
+        valid = false;
     else if(month<1 || month>12)
-        return false;
+        valid = false;
     else if(day<1 || day>31)
-        return false;
+        valid = false;
+    // agora vamos validar o dia (regra gregoriana: 1900 e 2100 não são bissextos)
+    else if(day>daysInMonth(year,month))
+        valid = false;
 
-    // agora vamos validar o dia
-    switch(month){
-    case 2:
-        if(year%4==0){
-            if(day>29) return false;
-        }
-        else if(day>28)return false;
-        break;
-    case 4:
-        if(day>30)return false;
-        break;
-    case 6:
-        if(day>30)return false;
-        break;
-    case 9:
-        if(day>30)return false;
-        break;
-    case 11:
-        if(day>30)return false;
-    }
+    if(!valid)
+        DATE_STAT_EVENT(DATE_STAT_VALIDATE_FAILURE);
 
-    return true;
+    return valid;
 
 }
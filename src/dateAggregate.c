@@ -0,0 +1,427 @@
+/**
+ * \file dateAggregate.c
+ * Implementação do arquivo dateAggregate.h
+ */
+
+#include "../h_files/dateAggregate.h"
+#include "../h_files/dateBatch.h"
+#include "../h_files/dateCivil.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Quantidade de datas processadas por bloco
+ */
+#define AGGREGATE_BLOCK 256
+
+/**
+ * Menor quantidade de datas que justifica mais uma thread
+ */
+#define MIN_DATES_PER_THREAD 65536
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Parâmetros comuns a todas as threads de uma agregação
+ */
+struct aggregateJob{
+    // fuso das datas
+    const TimeZone* zone;
+    // vetor de datas
+    const time_t* seconds;
+    // valores associados às datas (pode ser NULL)
+    const double* values;
+    // se as faixas são de um componente cíclico (ou de períodos)
+    bool cyclic;
+    // componente das faixas cíclicas
+    enum DateComponent component;
+    // tipo de período das faixas de períodos
+    enum DatePeriod period;
+    // número do período da primeira faixa
+    long long firstPeriod;
+    // quantidade de faixas
+    size_t bucketCount;
+};
+
+/**
+ * Parte de uma agregação executada por uma thread
+ */
+struct aggregateTask{
+    // parâmetros da agregação
+    const struct aggregateJob* job;
+    // primeira data da parte
+    size_t first;
+    // posição seguinte à última data da parte
+    size_t end;
+    // histograma parcial de quantidades
+    unsigned long long* counts;
+    // histograma parcial de somas (NULL se não houver valores)
+    double* sums;
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Divisão inteira com arredondamento para baixo (também para negativos)
+ * \return Quociente arredondado para menos infinito
+ * \param value Dividendo
+ * \param divisor Divisor (positivo)
+ */
+static long long floorDiv(long long value, long long divisor){
+    long long quotient = value / divisor;
+    if((value % divisor) < 0)
+        quotient--;
+    return quotient;
+}
+
+/**
+ * Retorna o período que contém um horário local
+ * \return Número do período
+ * \param local Segundos desde 1/1/1970 00:00:00 no fuso
+ * \param period Tipo de período
+ */
+static long long periodOfLocal(long long local, enum DatePeriod period){
+    long long days = floorDiv(local, SECONDS_PER_DAY);
+    int year, month, day;
+
+    switch(period){
+    case DATE_PERIOD_HOUR:
+        return floorDiv(local, 3600);
+    case DATE_PERIOD_DAY:
+        return days;
+    case DATE_PERIOD_ISO_WEEK:
+        // 1/1/1970 foi uma quinta-feira: a semana 0 começa em 29/12/1969
+        return floorDiv(days + 3, 7);
+    case DATE_PERIOD_MONTH:
+        civilFromDays(days, &year, &month, &day);
+        return (long long) year * 12 + (month - 1);
+    default:
+        civilFromDays(days, &year, &month, &day);
+        return year;
+    }
+}
+
+/**
+ * Aponta o vetor de um componente na estrutura de saída da decomposição em
+ * lote e retorna o menor valor do componente
+ * \return Menor valor do componente (subtraído para obter a faixa)
+ * \param arrays Estrutura de saída (com todos os ponteiros NULL)
+ * \param component Componente
+ * \param values Vetor que receberá o componente
+ */
+static int selectComponent(DateComponentArrays* arrays, enum DateComponent component,
+        int* values){
+    switch(component){
+    case MDAY: arrays->mday = values; return 1;
+    case YDAY: arrays->yday = values; return 0;
+    case WDAY: arrays->wday = values; return 0;
+    case MONTH: arrays->month = values; return 1;
+    case HOUR: arrays->hour = values; return 0;
+    case HOUR_AMPM: arrays->hourAmPm = values; return 1;
+    case MINUTE: arrays->minute = values; return 0;
+    default: arrays->second = values; return 0;
+    }
+}
+
+/**
+ * Calcula a faixa de cada data de um bloco
+ * \param job Parâmetros da agregação
+ * \param seconds Datas do bloco
+ * \param length Quantidade de datas (no máximo AGGREGATE_BLOCK)
+ * \param buckets Vetor onde será guardada a faixa de cada data (negativa ou
+ *      além da última faixa para as datas ignoradas)
+ */
+static void bucketBlock(const struct aggregateJob* job, const time_t* seconds,
+        size_t length, long long* buckets){
+    size_t i;
+
+    if(job->cyclic){
+        DateComponentArrays arrays = {0};
+        int values[AGGREGATE_BLOCK];
+        int minimum = selectComponent(&arrays, job->component, values);
+
+        // decomposição vetorizada de dateBatch.h, só do componente pedido
+        getDateComponentsBatchZone(job->zone, seconds, length, &arrays);
+        for(i = 0; i < length; i++)
+            buckets[i] = values[i] - minimum;
+    }
+    else{
+        time_t from = 1;
+        time_t until = 0;
+        long offset = 0;
+
+        for(i = 0; i < length; i++){
+            // o deslocamento só é consultado quando sai do intervalo válido
+            if(seconds[i] < from || seconds[i] > until)
+                offset = getZoneUtcOffsetWindow(job->zone, seconds[i], &from, &until);
+            buckets[i] = periodOfLocal((long long) seconds[i] + offset, job->period)
+                    - job->firstPeriod;
+        }
+    }
+}
+
+/**
+ * Agrega a parte de uma thread
+ * \return NULL
+ * \param argument Ponteiro para struct aggregateTask
+ */
+static void* aggregateRange(void* argument){
+    struct aggregateTask* task = argument;
+    const struct aggregateJob* job = task->job;
+    long long buckets[AGGREGATE_BLOCK];
+    size_t start, i;
+
+    for(start = task->first; start < task->end; start += AGGREGATE_BLOCK){
+        size_t length = task->end - start;
+        if(length > AGGREGATE_BLOCK)
+            length = AGGREGATE_BLOCK;
+
+        bucketBlock(job, job->seconds + start, length, buckets);
+
+        for(i = 0; i < length; i++){
+            // a comparação sem sinal também descarta faixas negativas
+            if((unsigned long long) buckets[i] >= job->bucketCount)
+                continue;
+            task->counts[buckets[i]]++;
+            if(task->sums != NULL)
+                task->sums[buckets[i]] += job->values[start + i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Divide a agregação entre threads e soma os histogramas parciais
+ * \return false se faltar memória
+ * \param job Parâmetros da agregação
+ * \param count Quantidade de datas
+ * \param threads Quantidade máxima de threads (0 para uma por processador)
+ * \param counts Histograma de quantidades
+ * \param sums Histograma de somas (pode ser NULL)
+ */
+static bool runAggregate(const struct aggregateJob* job, size_t count,
+        unsigned int threads, unsigned long long* counts, double* sums){
+    struct aggregateTask* tasks;
+    pthread_t* ids;
+    bool* started;
+    bool prepared;
+    size_t taskCount, i, bucket;
+
+    if(sums != NULL && job->values == NULL)
+        sums = NULL;
+    memset(counts, 0, job->bucketCount * sizeof(unsigned long long));
+    if(sums != NULL)
+        memset(sums, 0, job->bucketCount * sizeof(double));
+
+    if(threads == 0){
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (processors > 0) ? (unsigned int) processors : 1;
+    }
+    taskCount = count / MIN_DATES_PER_THREAD;
+    if(taskCount > threads)
+        taskCount = threads;
+    if(taskCount < 1)
+        taskCount = 1;
+
+    // uma thread só: agrega direto nos histogramas de saída
+    if(taskCount == 1){
+        struct aggregateTask task = {job, 0, count, counts, sums};
+        aggregateRange(&task);
+        return true;
+    }
+
+    tasks = calloc(taskCount, sizeof(struct aggregateTask));
+    ids = calloc(taskCount, sizeof(pthread_t));
+    started = calloc(taskCount, sizeof(bool));
+    prepared = tasks != NULL && ids != NULL && started != NULL;
+
+    // a primeira parte usa os histogramas de saída; as outras, parciais
+    for(i = 0; prepared && i < taskCount; i++){
+        tasks[i].job = job;
+        tasks[i].first = count / taskCount * i;
+        tasks[i].end = (i == taskCount - 1) ? count : count / taskCount * (i + 1);
+        tasks[i].counts = (i == 0) ? counts
+                : calloc(job->bucketCount, sizeof(unsigned long long));
+        tasks[i].sums = (i == 0 || sums == NULL) ? sums
+                : calloc(job->bucketCount, sizeof(double));
+        prepared = tasks[i].counts != NULL && (sums == NULL || tasks[i].sums != NULL);
+    }
+
+    if(prepared){
+        for(i = 1; i < taskCount; i++)
+            started[i] = pthread_create(&ids[i], NULL, aggregateRange, &tasks[i]) == 0;
+        aggregateRange(&tasks[0]);
+
+        for(i = 1; i < taskCount; i++){
+            // sem thread, a parte é executada aqui mesmo
+            if(started[i])
+                pthread_join(ids[i], NULL);
+            else
+                aggregateRange(&tasks[i]);
+
+            for(bucket = 0; bucket < job->bucketCount; bucket++)
+                counts[bucket] += tasks[i].counts[bucket];
+            if(sums != NULL){
+                for(bucket = 0; bucket < job->bucketCount; bucket++)
+                    sums[bucket] += tasks[i].sums[bucket];
+            }
+        }
+    }
+
+    for(i = 1; tasks != NULL && i < taskCount; i++){
+        free(tasks[i].counts);
+        free(tasks[i].sums);
+    }
+    free(tasks);
+    free(ids);
+    free(started);
+    return prepared;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Retorna a quantidade de faixas do histograma de um componente cíclico<BR>
+ * A faixa de cada data é o valor do componente (como em getDateComponent())
+ * menos o menor valor possível: o dia do mês 1 fica na faixa 0, o mês 1 na
+ * faixa 0, o dia da semana 0 (domingo) na faixa 0 etc.
+ * \return Quantidade de faixas (0 para YEAR, que não é cíclico: use
+ *      aggregateDatePeriod() com DATE_PERIOD_YEAR)
+ * \param component Componente da data
+ */
+size_t getDateComponentBucketCount(enum DateComponent component){
+    switch(component){
+    case MDAY: return 31;
+    case YDAY: return 366;
+    case WDAY: return 7;
+    case MONTH: return 12;
+    case HOUR: return 24;
+    case HOUR_AMPM: return 12;
+    case MINUTE: return 60;
+    case SECOND: return 60;
+    default: return 0;
+    }
+}
+
+/**
+ * Conta as datas de um vetor por um componente cíclico
+ * \return false se algum parâmetro for inválido
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param values Valor associado a cada data, somado em sums (pode ser NULL)
+ * \param count Quantidade de datas
+ * \param component Componente usado como faixa (veja
+ *      getDateComponentBucketCount())
+ * \param threads Quantidade máxima de threads (0 para uma por processador)
+ * \param counts Vetor com getDateComponentBucketCount() posições, onde será
+ *      guardada a quantidade de datas de cada faixa
+ * \param sums Vetor com getDateComponentBucketCount() posições, onde será
+ *      guardada a soma dos valores de cada faixa (pode ser NULL)
+ */
+bool aggregateDateComponent(const TimeZone* zone, const time_t* seconds,
+        const double* values, size_t count, enum DateComponent component,
+        unsigned int threads, unsigned long long* counts, double* sums){
+    struct aggregateJob job = {0};
+
+    job.bucketCount = getDateComponentBucketCount(component);
+    if(job.bucketCount == 0 || counts == NULL || (seconds == NULL && count > 0))
+        return false;
+
+    job.zone = zone;
+    job.seconds = seconds;
+    job.values = values;
+    job.cyclic = true;
+    job.component = component;
+    return runAggregate(&job, count, threads, counts, sums);
+}
+
+/**
+ * Retorna o período do calendário que contém uma data
+ * \return Número do período (veja enum DatePeriod)
+ * \param zone Fuso da data (NULL para o fuso local)
+ * \param seconds Data em segundos desde 1970
+ * \param period Tipo de período
+ */
+long long getDatePeriod(const TimeZone* zone, time_t seconds, enum DatePeriod period){
+    return periodOfLocal((long long) seconds + getZoneUtcOffset(zone, seconds), period);
+}
+
+/**
+ * Retorna o instante em que um período do calendário começa
+ * \return Segundos desde 1970
+ * \param zone Fuso do período (NULL para o fuso local)
+ * \param number Número do período (veja enum DatePeriod)
+ * \param period Tipo de período
+ */
+time_t getDatePeriodStart(const TimeZone* zone, long long number, enum DatePeriod period){
+    long long local, year;
+
+    switch(period){
+    case DATE_PERIOD_HOUR:
+        local = number * 3600;
+        break;
+    case DATE_PERIOD_DAY:
+        local = number * SECONDS_PER_DAY;
+        break;
+    case DATE_PERIOD_ISO_WEEK:
+        local = (number * 7 - 3) * SECONDS_PER_DAY;
+        break;
+    case DATE_PERIOD_MONTH:
+        year = floorDiv(number, 12);
+        local = daysFromCivil((int) year, (int) (number - year * 12) + 1, 1) * SECONDS_PER_DAY;
+        break;
+    default:
+        local = daysFromCivil((int) number, 1, 1) * SECONDS_PER_DAY;
+    }
+
+    return zoneLocalSecondsToTime(zone, local);
+}
+
+/**
+ * Conta as datas de um vetor por período do calendário<BR>
+ * A faixa i corresponde ao período firstPeriod + i; datas fora das faixas
+ * são ignoradas
+ * \return false se algum parâmetro for inválido
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param values Valor associado a cada data, somado em sums (pode ser NULL)
+ * \param count Quantidade de datas
+ * \param period Tipo de período
+ * \param firstPeriod Número do período da primeira faixa (veja getDatePeriod())
+ * \param periodCount Quantidade de faixas
+ * \param threads Quantidade máxima de threads (0 para uma por processador)
+ * \param counts Vetor com periodCount posições, onde será guardada a
+ *      quantidade de datas de cada faixa
+ * \param sums Vetor com periodCount posições, onde será guardada a soma dos
+ *      valores de cada faixa (pode ser NULL)
+ */
+bool aggregateDatePeriod(const TimeZone* zone, const time_t* seconds,
+        const double* values, size_t count, enum DatePeriod period,
+        long long firstPeriod, size_t periodCount, unsigned int threads,
+        unsigned long long* counts, double* sums){
+    struct aggregateJob job = {0};
+
+    if(period < DATE_PERIOD_HOUR || period > DATE_PERIOD_YEAR || periodCount == 0
+            || counts == NULL || (seconds == NULL && count > 0))
+        return false;
+
+    job.zone = zone;
+    job.seconds = seconds;
+    job.values = values;
+    job.cyclic = false;
+    job.period = period;
+    job.firstPeriod = firstPeriod;
+    job.bucketCount = periodCount;
+    return runAggregate(&job, count, threads, counts, sums);
+}
@@ -0,0 +1,353 @@
+/**
+ * \file dateBatch.c
+ * Implementação do arquivo dateBatch.h
+ */
+
+#include "../h_files/dateBatch.h"
+#include "../h_files/dateCivil.h"
+#include <string.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Quantidade de datas processadas por bloco (os temporários cabem no cache L1)
+ */
+#define BATCH_BLOCK 256
+
+/**
+ * Quantidade de datas validadas por bloco (uma palavra do mapa de bits)
+ */
+#define MASK_BLOCK 64
+
+/**
+ * Maior quantidade de dias (em módulo) decomposta com aritmética de 32 bits
+ * (cerca de 5 milhões de anos); datas além disso seguem o caminho de 64 bits
+ * de civilTimeFromSeconds()
+ */
+#define BLOCK_DAY_LIMIT 2000000000LL
+
+/**
+ * Quantidade de dias de cada mês em ano não bissexto, indexada por mês - 1
+ * (as posições além de dezembro nunca são usadas em uma data válida)
+ */
+static const int MONTH_DAYS[16] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31, 0, 0, 0, 0};
+
+/**
+ * Valores usados no lugar dos componentes de horário ausentes
+ */
+static const int ZERO_FIELDS[MASK_BLOCK];
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Componentes de um bloco de datas, um vetor por componente
+ */
+struct componentBlock{
+    int mday[BATCH_BLOCK];
+    int yday[BATCH_BLOCK];
+    int wday[BATCH_BLOCK];
+    int month[BATCH_BLOCK];
+    int year[BATCH_BLOCK];
+    int hour[BATCH_BLOCK];
+    int hourAmPm[BATCH_BLOCK];
+    int minute[BATCH_BLOCK];
+    int second[BATCH_BLOCK];
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Converte um bloco de datas UTC em dias e segundos do dia em um fuso<BR>
+ * O deslocamento só é consultado novamente quando a data sai do intervalo em
+ * que o último deslocamento é válido. Datas cujo dia não cabe na aritmética
+ * de 32 bits de decomposeBlock() recebem o dia 0 e são listadas em wide
+ * \return Quantidade de datas listadas em wide
+ * \param zone Fuso horário (NULL para o fuso local)
+ * \param seconds Datas em segundos desde 1970 UTC
+ * \param count Quantidade de datas (no máximo BATCH_BLOCK)
+ * \param days Vetor onde serão guardados os dias desde 1970
+ * \param secondOfDay Vetor onde serão guardados os segundos do dia
+ * \param wide Vetor onde serão guardadas as posições das datas fora da faixa
+ */
+static size_t splitLocalBlock(const TimeZone* zone, const time_t* seconds, size_t count,
+        int* days, int* secondOfDay, size_t* wide){
+    time_t from = 1;
+    time_t until = 0;
+    long offset = 0;
+    size_t wideCount = 0;
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        if(seconds[i] < from || seconds[i] > until)
+            offset = getZoneUtcOffsetWindow(zone, seconds[i], &from, &until);
+
+        long long local = (long long) seconds[i] + offset;
+        long long day = local / SECONDS_PER_DAY;
+        long long rest = local - day * SECONDS_PER_DAY;
+
+        // arredonda para baixo sem desvio
+        day -= (rest < 0);
+        rest += (rest < 0) * SECONDS_PER_DAY;
+
+        if(day > BLOCK_DAY_LIMIT || day < -BLOCK_DAY_LIMIT){
+            wide[wideCount++] = i;
+            day = 0;
+        }
+
+        days[i] = (int) day;
+        secondOfDay[i] = (int) rest;
+    }
+
+    return wideCount;
+}
+
+/**
+ * Decompõe um bloco de dias e segundos do dia em componentes<BR>
+ * Laço sem desvios e somente com aritmética de 32 bits, para que possa ser
+ * vetorizado pelo compilador
+ * \param days Dias desde 1970
+ * \param secondOfDay Segundos do dia
+ * \param count Quantidade de datas (no máximo BATCH_BLOCK)
+ * \param block Bloco onde os componentes serão guardados
+ */
+static void decomposeBlock(const int* days, const int* secondOfDay, size_t count,
+        struct componentBlock* block){
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        // algoritmo de dias para data civil com o ano começando em março
+        int z = days[i] + 719468;
+        int era = (z - (z < 0) * 146096) / 146097;
+        int dayOfEra = z - era * 146097;
+        int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524
+                - dayOfEra / 146096) / 365;
+        int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int monthIndex = (5 * dayOfYear + 2) / 153;
+        int january = (monthIndex >= 10);
+        int month = monthIndex + 3 - 12 * january;
+        int year = yearOfEra + era * 400 + january;
+        int leap = ((year & 3) == 0) & ((year % 100 != 0) | (year % 400 == 0));
+        int hour = secondOfDay[i] / 3600;
+
+        block->mday[i] = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        block->month[i] = month;
+        block->year[i] = year;
+        block->yday[i] = january ? dayOfYear - 306 : dayOfYear + 59 + leap;
+        block->wday[i] = ((days[i] % 7) + 11) % 7;
+        block->hour[i] = hour;
+        block->hourAmPm[i] = hour - 12 * (hour > 12) + 12 * (hour == 0);
+        block->minute[i] = (secondOfDay[i] / 60) % 60;
+        block->second[i] = secondOfDay[i] % 60;
+    }
+}
+
+/**
+ * Decompõe novamente, com aritmética de 64 bits, as datas do bloco que
+ * splitLocalBlock() deixou de fora (mesmo cálculo de getDateComponent())
+ * \param zone Fuso horário (NULL para o fuso local)
+ * \param seconds Datas em segundos desde 1970 UTC
+ * \param wide Posições das datas fora da faixa
+ * \param wideCount Quantidade de posições
+ * \param block Bloco onde os componentes serão corrigidos
+ */
+static void decomposeWide(const TimeZone* zone, const time_t* seconds, const size_t* wide,
+        size_t wideCount, struct componentBlock* block){
+    size_t i;
+
+    for(i = 0; i < wideCount; i++){
+        size_t index = wide[i];
+        CivilTime civil;
+
+        civilTimeFromSeconds((long long) seconds[index]
+                + getZoneUtcOffset(zone, seconds[index]), &civil);
+        block->mday[index] = civil.mday;
+        block->month[index] = civil.month;
+        block->year[index] = civil.year;
+        block->yday[index] = civil.yday;
+        block->wday[index] = civil.wday;
+        block->hour[index] = civil.hour;
+        block->hourAmPm[index] = civil.hour - 12 * (civil.hour > 12) + 12 * (civil.hour == 0);
+        block->minute[index] = civil.minute;
+        block->second[index] = civil.second;
+    }
+}
+
+/**
+ * Copia um componente do bloco para o vetor de saída
+ * \param destination Posição do bloco no vetor de saída
+ * \param source Componente do bloco
+ * \param count Quantidade de datas do bloco
+ */
+static void storeComponent(int* destination, const int* source, size_t count){
+    memcpy(destination, source, count * sizeof(int));
+}
+
+/**
+ * Valida um bloco de datas<BR>
+ * Laço sem desvios (somente comparações combinadas com & e |), para que
+ * possa ser vetorizado pelo compilador
+ * \param day Dias do mês
+ * \param month Meses
+ * \param year Anos
+ * \param hour Horas
+ * \param minute Minutos
+ * \param second Segundos
+ * \param count Quantidade de datas (no máximo MASK_BLOCK)
+ * \param valid Vetor onde será guardado 1 para as datas válidas e 0 para as
+ *      inválidas
+ */
+static void validateBlock(const int* day, const int* month, const int* year,
+        const int* hour, const int* minute, const int* second, size_t count,
+        unsigned char* valid){
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        int leap = ((year[i] & 3) == 0) & ((year[i] % 100 != 0) | (year[i] % 400 == 0));
+        int monthOk = (unsigned int) (month[i] - 1) < 12u;
+        // fora de 1 - 12 o índice cai em uma posição qualquer, descartada por monthOk
+        int lastDay = MONTH_DAYS[(unsigned int) (month[i] - 1) & 15u] + (month[i] == 2) * leap;
+        int dayOk = (day[i] >= 1) & (day[i] <= lastDay);
+        int clockOk = ((unsigned int) hour[i] < 24u) & ((unsigned int) minute[i] < 60u)
+                & ((unsigned int) second[i] < 60u);
+
+        valid[i] = (unsigned char) (monthOk & dayOk & clockOk);
+    }
+}
+
+/**
+ * Junta 64 valores 0/1 em uma palavra do mapa de bits
+ * \return Palavra com o bit i igual a valid[i]
+ * \param valid Vetor com 64 valores 0 ou 1
+ */
+static uint64_t packMask(const unsigned char* valid){
+    uint64_t mask = 0;
+    int i;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // 8 valores por multiplicação: cada byte vai parar em um bit do byte mais alto
+    for(i = 0; i < MASK_BLOCK; i += 8){
+        uint64_t bytes;
+        memcpy(&bytes, valid + i, 8);
+        mask |= ((bytes * 0x0102040810204080ULL) >> 56) << i;
+    }
+#else
+    for(i = 0; i < MASK_BLOCK; i++)
+        mask |= (uint64_t) valid[i] << i;
+#endif
+
+    return mask;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Decompõe um vetor de datas no fuso local, em uma única passada<BR>
+ * Equivale a chamar getDateComponent() para cada data e cada componente
+ * solicitado, sem alocar objetos Date
+ * \return false se algum ponteiro obrigatório for NULL, true em caso contrário
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas no vetor
+ * \param components Vetores de saída (componentes NULL são ignorados)
+ */
+bool getDateComponentsBatch(const time_t* seconds, size_t count,
+        DateComponentArrays* components){
+    return getDateComponentsBatchZone(NULL, seconds, count, components);
+}
+
+/**
+ * Decompõe um vetor de datas em um fuso específico, em uma única passada
+ * \return false se algum ponteiro obrigatório for NULL, true em caso contrário
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas no vetor
+ * \param components Vetores de saída (componentes NULL são ignorados)
+ */
+bool getDateComponentsBatchZone(const TimeZone* zone, const time_t* seconds,
+        size_t count, DateComponentArrays* components){
+    int days[BATCH_BLOCK];
+    int secondOfDay[BATCH_BLOCK];
+    size_t wide[BATCH_BLOCK];
+    struct componentBlock block;
+    size_t start;
+
+    if(components == NULL || (seconds == NULL && count > 0))
+        return false;
+
+    for(start = 0; start < count; start += BATCH_BLOCK){
+        size_t length = count - start;
+        if(length > BATCH_BLOCK)
+            length = BATCH_BLOCK;
+
+        size_t wideCount = splitLocalBlock(zone, seconds + start, length, days,
+                secondOfDay, wide);
+        decomposeBlock(days, secondOfDay, length, &block);
+        // raro: datas a milhões de anos de 1970
+        if(wideCount > 0)
+            decomposeWide(zone, seconds + start, wide, wideCount, &block);
+
+        // guarda somente os componentes solicitados
+        if(components->mday != NULL) storeComponent(components->mday + start, block.mday, length);
+        if(components->yday != NULL) storeComponent(components->yday + start, block.yday, length);
+        if(components->wday != NULL) storeComponent(components->wday + start, block.wday, length);
+        if(components->month != NULL) storeComponent(components->month + start, block.month, length);
+        if(components->year != NULL) storeComponent(components->year + start, block.year, length);
+        if(components->hour != NULL) storeComponent(components->hour + start, block.hour, length);
+        if(components->hourAmPm != NULL) storeComponent(components->hourAmPm + start, block.hourAmPm, length);
+        if(components->minute != NULL) storeComponent(components->minute + start, block.minute, length);
+        if(components->second != NULL) storeComponent(components->second + start, block.second, length);
+    }
+
+    return true;
+}
+
+/**
+ * Valida um vetor de datas, com as mesmas regras de validateDate() (veja
+ * date.h)<BR>
+ * O resultado é um mapa de bits: o bit (i % 64) da palavra validMask[i / 64]
+ * indica se a data i é válida. Os bits além de count na última palavra são
+ * zerados
+ * \return Quantidade de datas válidas (0 se algum ponteiro obrigatório for
+ *      NULL)
+ * \param fields Vetores de entrada (veja struct dateFieldArrays)
+ * \param count Quantidade de datas
+ * \param validMask Vetor com pelo menos (count + 63) / 64 palavras
+ */
+size_t validateDatesBatch(const DateFieldArrays* fields, size_t count,
+        uint64_t* validMask){
+    unsigned char valid[MASK_BLOCK];
+    size_t total = 0;
+    size_t start;
+
+    if(fields == NULL || validMask == NULL || (count > 0 && (fields->day == NULL
+            || fields->month == NULL || fields->year == NULL)))
+        return 0;
+
+    for(start = 0; start < count; start += MASK_BLOCK){
+        size_t length = count - start;
+        uint64_t mask;
+        if(length > MASK_BLOCK)
+            length = MASK_BLOCK;
+
+        validateBlock(fields->day + start, fields->month + start, fields->year + start,
+                (fields->hour != NULL) ? fields->hour + start : ZERO_FIELDS,
+                (fields->minute != NULL) ? fields->minute + start : ZERO_FIELDS,
+                (fields->second != NULL) ? fields->second + start : ZERO_FIELDS,
+                length, valid);
+        // o resto do último bloco fica zerado no mapa de bits
+        memset(valid + length, 0, MASK_BLOCK - length);
+
+        mask = packMask(valid);
+        validMask[start / MASK_BLOCK] = mask;
+        total += (size_t) __builtin_popcountll(mask);
+    }
+
+    return total;
+}
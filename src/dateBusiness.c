@@ -0,0 +1,381 @@
+/**
+ * \file dateBusiness.c
+ * Implementação do arquivo dateBusiness.h
+ */
+
+#include "../h_files/dateBusiness.h"
+#include "../h_files/dateCivil.h"
+#include <stdint.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Quantidade máxima de anos em um calendário (mantém a contagem acumulada
+ * em 32 bits)
+ */
+#define MAX_CALENDAR_YEARS 10000
+
+/**
+ * Máscara com todos os dias da semana
+ */
+#define ALL_WEEK_DAYS 0x7Fu
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Calendário de dias úteis
+ */
+struct businessCalendar{
+    // primeiro dia coberto (1/1 do primeiro ano, em dias desde 1970)
+    long long firstDay;
+    // quantidade de dias cobertos
+    size_t dayCount;
+    // um bit por dia, ligado nos dias úteis
+    uint64_t* bits;
+    // quantidade de palavras de bits
+    size_t wordCount;
+    // dias úteis antes de cada palavra (wordCount + 1 posições)
+    uint32_t* rank;
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Retorna a quantidade de dias úteis antes de um dia
+ * \return Dias úteis em [firstDay, firstDay + offset)
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param offset Posição do dia no calendário (0 a dayCount)
+ */
+static long long rankDay(const BusinessCalendar* calendar, size_t offset){
+    size_t word = offset / 64;
+    unsigned int bit = offset % 64;
+    long long count = calendar->rank[word];
+
+    if(bit != 0)
+        count += __builtin_popcountll(calendar->bits[word] & ((UINT64_C(1) << bit) - 1));
+
+    return count;
+}
+
+/**
+ * Retorna a posição do dia útil de uma ordem (a operação inversa de
+ * rankDay())
+ * \return Posição do dia no calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param order Ordem do dia útil, começando em 0 (menor que o total)
+ */
+static size_t selectDay(const BusinessCalendar* calendar, long long order){
+    size_t low = 0;
+    size_t high = calendar->wordCount;
+    uint64_t word;
+    long long skipped;
+
+    // última palavra com menos de order + 1 dias úteis antes dela
+    while(high - low > 1){
+        size_t middle = low + (high - low) / 2;
+        if(calendar->rank[middle] <= order)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    // descarta os dias úteis anteriores dentro da palavra
+    word = calendar->bits[low];
+    for(skipped = order - calendar->rank[low]; skipped > 0; skipped--)
+        word &= word - 1;
+
+    return low * 64 + (size_t) __builtin_ctzll(word);
+}
+
+/**
+ * Recalcula a contagem acumulada a partir de uma palavra de bits
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param first Primeira palavra cuja contagem pode ter mudado
+ */
+static void rebuildRank(BusinessCalendar* calendar, size_t first){
+    size_t word;
+
+    for(word = first; word < calendar->wordCount; word++)
+        calendar->rank[word + 1] = calendar->rank[word]
+                + (uint32_t) __builtin_popcountll(calendar->bits[word]);
+}
+
+/**
+ * Converte um dia em posição no calendário
+ * \return false se o dia estiver fora do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param days Dia em dias desde 1/1/1970
+ * \param allowEnd Se o dia seguinte ao último também é aceito
+ * \param offset Ponteiro onde será guardada a posição
+ */
+static bool dayOffset(const BusinessCalendar* calendar, long long days, bool allowEnd,
+        size_t* offset){
+    if(days < calendar->firstDay
+            || days - calendar->firstDay > (long long) calendar->dayCount - (allowEnd ? 0 : 1))
+        return false;
+
+    *offset = (size_t) (days - calendar->firstDay);
+    return true;
+}
+
+/**
+ * Retorna o dia (no fuso da data) de um objeto Date
+ * \return Dias desde 1/1/1970
+ * \param date Ponteiro para objeto Date
+ */
+static long long localDay(Date** date){
+    CivilTime civil;
+    getDateCivilTime(date, &civil);
+    return daysFromCivil(civil.year, civil.month, civil.mday);
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Cria um calendário de dias úteis sem feriados
+ * \return Ponteiro para objeto BusinessCalendar, ou NULL se os parâmetros
+ *      forem inválidos ou faltar memória
+ * \param weekend Dias de fim de semana (veja BUSINESS_DAY())
+ * \param firstYear Primeiro ano coberto pelo calendário
+ * \param lastYear Último ano coberto pelo calendário
+ */
+BusinessCalendar* createBusinessCalendar(unsigned int weekend, int firstYear, int lastYear){
+    BusinessCalendar* calendar;
+    unsigned int weekDay;
+    size_t day;
+
+    if((weekend & ~ALL_WEEK_DAYS) != 0 || lastYear < firstYear
+            || (long long) lastYear - firstYear >= MAX_CALENDAR_YEARS)
+        return NULL;
+
+    calendar = calloc(1, sizeof(BusinessCalendar));
+    if(calendar == NULL)
+        return NULL;
+
+    calendar->firstDay = daysFromCivil(firstYear, 1, 1);
+    calendar->dayCount = (size_t) (daysFromCivil(lastYear + 1, 1, 1) - calendar->firstDay);
+    calendar->wordCount = (calendar->dayCount + 63) / 64;
+    calendar->bits = calloc(calendar->wordCount, sizeof(uint64_t));
+    calendar->rank = calloc(calendar->wordCount + 1, sizeof(uint32_t));
+    if(calendar->bits == NULL || calendar->rank == NULL)
+        return destroyBusinessCalendar(calendar);
+
+    // o padrão dos fins de semana se repete a cada 7 dias
+    weekDay = (unsigned int) weekDayFromDays(calendar->firstDay);
+    for(day = 0; day < calendar->dayCount; day++){
+        if(!((weekend >> weekDay) & 1u))
+            calendar->bits[day / 64] |= UINT64_C(1) << (day % 64);
+        weekDay = (weekDay == SATURDAY) ? SUNDAY : weekDay + 1;
+    }
+
+    rebuildRank(calendar, 0);
+
+    return calendar;
+}
+
+/**
+ * Desaloca o calendário
+ * \return NULL
+ * \param calendar Ponteiro para objeto BusinessCalendar a ser desalocado
+ */
+BusinessCalendar* destroyBusinessCalendar(BusinessCalendar* calendar){
+    if(calendar == NULL)
+        return NULL;
+
+    free(calendar->bits);
+    free(calendar->rank);
+    free(calendar);
+    return NULL;
+}
+
+/**
+ * Marca um dia como feriado<BR>
+ * Feriados em fins de semana são aceitos e não mudam nada. O calendário não
+ * deve ser consultado por outra thread enquanto feriados são adicionados.
+ * Cada chamada atualiza a contagem acumulada dos dias seguintes; para muitos
+ * feriados, use addBusinessHolidays()
+ * \return false se a data for inválida ou estiver fora dos anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param day Dia do mês
+ * \param month Mês
+ * \param year Ano
+ */
+bool addBusinessHoliday(BusinessCalendar* calendar, int day, int month, int year){
+    uint64_t mask;
+    size_t offset, word;
+
+    if(calendar == NULL || !validateDate(day, month, year, 0, 0, 0)
+            || !dayOffset(calendar, daysFromCivil(year, month, day), false, &offset))
+        return false;
+
+    mask = UINT64_C(1) << (offset % 64);
+    if((calendar->bits[offset / 64] & mask) == 0)
+        return true;
+
+    // a contagem acumulada das palavras seguintes perde um dia útil
+    calendar->bits[offset / 64] &= ~mask;
+    for(word = offset / 64 + 1; word <= calendar->wordCount; word++)
+        calendar->rank[word]--;
+
+    return true;
+}
+
+/**
+ * Marca vários dias como feriados, atualizando a contagem acumulada uma
+ * única vez (a partir do primeiro dia alterado)<BR>
+ * Datas inválidas ou fora dos anos do calendário são ignoradas. O
+ * calendário não deve ser consultado por outra thread enquanto feriados são
+ * adicionados
+ * \return Quantidade de datas aceitas (0 se algum ponteiro obrigatório for
+ *      NULL)
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param holidays Vetores de dia, mês e ano (hora, minuto e segundo são
+ *      ignorados; veja struct dateFieldArrays em dateBatch.h)
+ * \param count Quantidade de feriados
+ */
+size_t addBusinessHolidays(BusinessCalendar* calendar, const DateFieldArrays* holidays,
+        size_t count){
+    size_t firstWord = SIZE_MAX;
+    size_t accepted = 0;
+    size_t i;
+
+    if(calendar == NULL || holidays == NULL || (count > 0 && (holidays->day == NULL
+            || holidays->month == NULL || holidays->year == NULL)))
+        return 0;
+
+    // primeiro só apaga os bits; a contagem é refeita uma vez no final
+    for(i = 0; i < count; i++){
+        size_t offset;
+        int day = holidays->day[i];
+        int month = holidays->month[i];
+        int year = holidays->year[i];
+
+        if(!validateDate(day, month, year, 0, 0, 0)
+                || !dayOffset(calendar, daysFromCivil(year, month, day), false, &offset))
+            continue;
+
+        accepted++;
+        calendar->bits[offset / 64] &= ~(UINT64_C(1) << (offset % 64));
+        if(offset / 64 < firstWord)
+            firstWord = offset / 64;
+    }
+
+    if(firstWord != SIZE_MAX)
+        rebuildRank(calendar, firstWord);
+
+    return accepted;
+}
+
+/**
+ * Verifica se um dia é útil
+ * \return true se o dia for útil; false se não for ou se estiver fora dos
+ *      anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param days Dia em dias desde 1/1/1970 (veja daysFromCivil() em dateCivil.h)
+ */
+bool isBusinessDay(const BusinessCalendar* calendar, long long days){
+    size_t offset;
+
+    if(calendar == NULL || !dayOffset(calendar, days, false, &offset))
+        return false;
+
+    return (calendar->bits[offset / 64] >> (offset % 64)) & 1u;
+}
+
+/**
+ * Conta os dias úteis em um intervalo de dias [from, until)
+ * \return false se o intervalo sair dos anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param from Primeiro dia do intervalo, em dias desde 1/1/1970
+ * \param until Dia seguinte ao último do intervalo, em dias desde 1/1/1970
+ * \param count Ponteiro onde será guardada a quantidade de dias úteis
+ *      (negativa se until for anterior a from)
+ */
+bool countBusinessDays(const BusinessCalendar* calendar, long long from, long long until,
+        long long* count){
+    size_t first, end;
+
+    if(calendar == NULL || count == NULL || !dayOffset(calendar, from, true, &first)
+            || !dayOffset(calendar, until, true, &end))
+        return false;
+
+    *count = rankDay(calendar, end) - rankDay(calendar, first);
+    return true;
+}
+
+/**
+ * Soma dias úteis a um dia<BR>
+ * Com count positivo, o resultado é o count-ésimo dia útil depois de days;
+ * com count negativo, o count-ésimo dia útil antes de days; com count 0, o
+ * próprio dia se for útil ou o próximo dia útil
+ * \return false se o resultado sair dos anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param days Dia em dias desde 1/1/1970
+ * \param count Quantidade de dias úteis
+ * \param result Ponteiro onde será guardado o dia resultante
+ */
+bool addBusinessDays(const BusinessCalendar* calendar, long long days, long long count,
+        long long* result){
+    long long total, order;
+    size_t offset;
+
+    if(calendar == NULL || result == NULL || !dayOffset(calendar, days, false, &offset))
+        return false;
+
+    total = calendar->rank[calendar->wordCount];
+    // ordem do dia útil procurado entre todos os do calendário
+    if(count > 0)
+        order = rankDay(calendar, offset + 1) - 1;
+    else
+        order = rankDay(calendar, offset);
+    if(count > total || count < -total)
+        return false;
+    order += count;
+
+    if(order < 0 || order >= total)
+        return false;
+
+    *result = calendar->firstDay + (long long) selectDay(calendar, order);
+    return true;
+}
+
+/**
+ * Soma dias úteis à data, mantendo o horário local (veja addBusinessDays())
+ * \return false se o resultado sair dos anos do calendário (a data não muda)
+ * \param date Ponteiro para o objeto Date
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param count Quantidade de dias úteis (negativa para subtrair)
+ */
+bool addBusinessDaysDate(Date** date, const BusinessCalendar* calendar, long long count){
+    long long day = localDay(date);
+    long long result;
+
+    if(!addBusinessDays(calendar, day, count, &result))
+        return false;
+
+    return addDaysDate(date, result - day);
+}
+
+/**
+ * Conta os dias úteis depois de from até to, inclusive (os horários são
+ * ignorados): somar esse resultado a from com addBusinessDaysDate() leva ao
+ * dia de to quando to é dia útil
+ * \return false se as datas saírem dos anos do calendário
+ * \param calendar Ponteiro para objeto BusinessCalendar
+ * \param from Ponteiro para o objeto Date inicial
+ * \param to Ponteiro para o objeto Date final
+ * \param count Ponteiro onde será guardada a quantidade de dias úteis
+ *      (negativa se to for anterior a from)
+ */
+bool diffBusinessDaysDate(const BusinessCalendar* calendar, Date** from, Date** to,
+        long long* count){
+    return countBusinessDays(calendar, localDay(from) + 1, localDay(to) + 1, count);
+}
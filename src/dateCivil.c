@@ -0,0 +1,160 @@
+/**
+ * \file dateCivil.c
+ * Implementação do arquivo dateCivil.h
+ */
+
+#include "../h_files/dateCivil.h"
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Dias em um ciclo gregoriano de 400 anos
+ */
+#define DAYS_PER_ERA 146097
+
+/**
+ * Dias entre 1/3/0000 e 1/1/1970
+ */
+#define EPOCH_SHIFT 719468
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Divisão inteira com arredondamento para baixo (também para negativos)
+ * \return Quociente arredondado para menos infinito
+ * \param value Dividendo
+ * \param divisor Divisor (positivo)
+ */
+static long long floorDiv(long long value, long long divisor){
+    long long quotient = value / divisor;
+    // corrige o arredondamento em direção a zero do C
+    if((value % divisor) < 0)
+        quotient--;
+    return quotient;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Verifica se um ano é bissexto (regra gregoriana completa)
+ * \return true se o ano for bissexto
+ * \param year Ano
+ */
+bool isLeapYear(int year){
+    return (year % 4 == 0) && (year % 100 != 0 || year % 400 == 0);
+}
+
+/**
+ * Retorna a quantidade de dias de um mês
+ * \return Dias do mês (28 - 31)
+ * \param year Ano
+ * \param month Mês (1 - 12)
+ */
+int daysInMonth(int year, int month){
+    // fevereiro é o único mês que depende do ano
+    if(month == 2)
+        return isLeapYear(year) ? 29 : 28;
+    // abril, junho, setembro e novembro têm 30 dias
+    return 30 + ((month + (month >> 3)) & 1);
+}
+
+/**
+ * Converte uma data civil em dias desde 1/1/1970
+ * \return Dias desde 1/1/1970 (negativo para datas anteriores)
+ * \param year Ano
+ * \param month Mês (1 - 12)
+ * \param day Dia do mês (1 - 31)
+ */
+long long daysFromCivil(int year, int month, int day){
+    // o ano começa em março, assim o dia bissexto fica no fim do ano
+    long long y = (long long) year - (month <= 2);
+    long long era = floorDiv(y, 400);
+    long long yearOfEra = y - era * 400;
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * DAYS_PER_ERA + dayOfEra - EPOCH_SHIFT;
+}
+
+/**
+ * Converte dias desde 1/1/1970 em uma data civil
+ * \param days Dias desde 1/1/1970
+ * \param year Ponteiro onde será guardado o ano
+ * \param month Ponteiro onde será guardado o mês (1 - 12)
+ * \param day Ponteiro onde será guardado o dia do mês (1 - 31)
+ */
+void civilFromDays(long long days, int* year, int* month, int* day){
+    long long z = days + EPOCH_SHIFT;
+    long long era = floorDiv(z, DAYS_PER_ERA);
+    long long dayOfEra = z - era * DAYS_PER_ERA;
+    long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524
+            - dayOfEra / 146096) / 365;
+    long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    long long monthIndex = (5 * dayOfYear + 2) / 153;
+
+    *day = (int) (dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    *month = (int) (monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    *year = (int) (yearOfEra + era * 400 + (*month <= 2));
+}
+
+/**
+ * Retorna o dia da semana de um dia desde 1/1/1970
+ * \return Dia da semana (0: domingo, 6: sábado)
+ * \param days Dias desde 1/1/1970
+ */
+int weekDayFromDays(long long days){
+    // 1/1/1970 foi uma quinta-feira
+    return (int) (((days % 7) + 11) % 7);
+}
+
+/**
+ * Decompõe segundos (já ajustados para o fuso desejado) em componentes
+ * \param seconds Segundos desde 1/1/1970 00:00:00 no fuso desejado
+ * \param civil Ponteiro para a estrutura a ser preenchida
+ */
+void civilTimeFromSeconds(long long seconds, CivilTime* civil){
+    long long days = floorDiv(seconds, SECONDS_PER_DAY);
+    int secondOfDay = (int) (seconds - days * SECONDS_PER_DAY);
+
+    civilFromDays(days, &civil->year, &civil->month, &civil->mday);
+
+    civil->yday = (int) (days - daysFromCivil(civil->year, 1, 1));
+    civil->wday = weekDayFromDays(days);
+    civil->hour = secondOfDay / 3600;
+    civil->minute = (secondOfDay / 60) % 60;
+    civil->second = secondOfDay % 60;
+}
+
+/**
+ * Compõe segundos desde 1/1/1970 a partir dos componentes da data<BR>
+ * Componentes fora do intervalo são normalizados (como em mktime()): mês 13
+ * vira janeiro do ano seguinte, dia 0 vira o último dia do mês anterior etc.
+ * \return Segundos desde 1/1/1970 00:00:00 no mesmo fuso dos componentes
+ * \param day Dia do mês
+ * \param month Mês
+ * \param year Ano
+ * \param hour Hora
+ * \param minute Minuto
+ * \param second Segundo
+ */
+long long secondsFromCivil(int day, int month, int year,
+        int hour, int minute, int second){
+
+    // normaliza o mês, levando o excesso para o ano
+    long long monthIndex = (long long) month - 1;
+    long long yearShift = floorDiv(monthIndex, 12);
+    int normalizedYear = (int) (year + yearShift);
+    int normalizedMonth = (int) (monthIndex - yearShift * 12) + 1;
+
+    // dias excedentes são somados a partir do primeiro dia do mês
+    long long days = daysFromCivil(normalizedYear, normalizedMonth, 1) + day - 1;
+
+    return days * SECONDS_PER_DAY + (long long) hour * 3600
+            + (long long) minute * 60 + second;
+}
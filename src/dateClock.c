@@ -0,0 +1,209 @@
+/**
+ * \file dateClock.c
+ * Implementação do arquivo dateClock.h
+ */
+
+#include "../h_files/dateClock.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Nanossegundos em um segundo
+ */
+#define NANOSECONDS_PER_SECOND 1000000000LL
+
+/**
+ * Intervalo padrão da thread de atualização em microssegundos
+ */
+#define DEFAULT_TICK_MICROSECONDS 1000
+
+/******************************************************************************
+ * Variáveis do módulo
+ ******************************************************************************/
+
+/**
+ * Fonte da data atual em uso
+ */
+static _Atomic int currentClock = DATE_CLOCK_TIME;
+
+/**
+ * Último valor lido pela thread de atualização, em nanossegundos desde 1970
+ * (0 enquanto a thread não estiver rodando)
+ */
+static _Atomic int64_t cachedNanoseconds = 0;
+
+/**
+ * Se a thread de atualização deve continuar rodando
+ */
+static _Atomic bool tickerRunning = false;
+
+/**
+ * Intervalo da thread de atualização
+ */
+static unsigned int tickerInterval;
+
+/**
+ * Thread de atualização
+ */
+static pthread_t tickerThread;
+
+/**
+ * Protege o início e a parada da thread de atualização
+ */
+static pthread_mutex_t tickerLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Lê um relógio do sistema
+ * \param clockId Relógio (CLOCK_REALTIME ou CLOCK_REALTIME_COARSE)
+ * \param seconds Ponteiro onde serão guardados os segundos
+ * \param nanoseconds Ponteiro onde serão guardados os nanossegundos
+ */
+static void readSystemClock(clockid_t clockId, time_t* seconds, long* nanoseconds){
+    struct timespec now;
+
+    if(clock_gettime(clockId, &now) != 0){
+        now.tv_sec = time(0);
+        now.tv_nsec = 0;
+    }
+
+    *seconds = now.tv_sec;
+    *nanoseconds = now.tv_nsec;
+}
+
+/**
+ * Guarda a data atual para os leitores de DATE_CLOCK_CACHED
+ */
+static void refreshCachedClock(void){
+    time_t seconds;
+    long nanoseconds;
+
+    readSystemClock(CLOCK_REALTIME, &seconds, &nanoseconds);
+    atomic_store_explicit(&cachedNanoseconds,
+            (int64_t) seconds * NANOSECONDS_PER_SECOND + nanoseconds, memory_order_relaxed);
+}
+
+/**
+ * Laço da thread de atualização
+ * \return NULL
+ * \param argument Não usado
+ */
+static void* tickerLoop(void* argument){
+    struct timespec interval;
+
+    (void) argument;
+    interval.tv_sec = tickerInterval / 1000000;
+    interval.tv_nsec = (long) (tickerInterval % 1000000) * 1000;
+
+    while(atomic_load_explicit(&tickerRunning, memory_order_relaxed)){
+        refreshCachedClock();
+        nanosleep(&interval, NULL);
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Escolhe a fonte da data atual
+ * \param clock Fonte da data atual
+ */
+void setDateClock(enum DateClock clock){
+    atomic_store_explicit(&currentClock, (int) clock, memory_order_relaxed);
+}
+
+/**
+ * Retorna a fonte da data atual em uso
+ * \return Fonte da data atual
+ */
+enum DateClock getDateClock(void){
+    return (enum DateClock) atomic_load_explicit(&currentClock, memory_order_relaxed);
+}
+
+/**
+ * Inicia a thread que atualiza o relógio usado por DATE_CLOCK_CACHED<BR>
+ * Enquanto a thread não estiver rodando, DATE_CLOCK_CACHED se comporta como
+ * DATE_CLOCK_COARSE
+ * \return false se não conseguir iniciar a thread (ou se ela já estiver rodando)
+ * \param intervalMicroseconds Intervalo entre duas atualizações (0 para 1 ms)
+ */
+bool startDateClockTicker(unsigned int intervalMicroseconds){
+    bool started = false;
+
+    pthread_mutex_lock(&tickerLock);
+    if(!atomic_load(&tickerRunning)){
+        tickerInterval = (intervalMicroseconds > 0) ? intervalMicroseconds
+                : DEFAULT_TICK_MICROSECONDS;
+        // o valor fica disponível antes da primeira espera da thread
+        refreshCachedClock();
+        atomic_store(&tickerRunning, true);
+        started = pthread_create(&tickerThread, NULL, tickerLoop, NULL) == 0;
+        if(!started){
+            atomic_store(&tickerRunning, false);
+            atomic_store(&cachedNanoseconds, 0);
+        }
+    }
+    pthread_mutex_unlock(&tickerLock);
+
+    return started;
+}
+
+/**
+ * Para a thread iniciada por startDateClockTicker()
+ */
+void stopDateClockTicker(void){
+    pthread_mutex_lock(&tickerLock);
+    if(atomic_load(&tickerRunning)){
+        atomic_store(&tickerRunning, false);
+        pthread_join(tickerThread, NULL);
+        // sem a thread, o valor guardado ficaria parado
+        atomic_store(&cachedNanoseconds, 0);
+    }
+    pthread_mutex_unlock(&tickerLock);
+}
+
+/**
+ * Lê a data atual na fonte escolhida
+ * \param seconds Ponteiro onde serão guardados os segundos desde 1970
+ * \param nanoseconds Ponteiro onde serão guardados os nanossegundos (0 se a
+ *      fonte não tiver essa resolução). Pode ser NULL
+ */
+void readDateClock(time_t* seconds, long* nanoseconds){
+    long fraction = 0;
+
+    switch(getDateClock()){
+    case DATE_CLOCK_CACHED:{
+        int64_t cached = atomic_load_explicit(&cachedNanoseconds, memory_order_relaxed);
+        if(cached != 0){
+            *seconds = (time_t) (cached / NANOSECONDS_PER_SECOND);
+            fraction = (long) (cached % NANOSECONDS_PER_SECOND);
+            break;
+        }
+        // sem a thread de atualização, usa o relógio de baixa resolução
+        readSystemClock(CLOCK_REALTIME_COARSE, seconds, &fraction);
+        break;
+    }
+    case DATE_CLOCK_COARSE:
+        readSystemClock(CLOCK_REALTIME_COARSE, seconds, &fraction);
+        break;
+    case DATE_CLOCK_PRECISE:
+        readSystemClock(CLOCK_REALTIME, seconds, &fraction);
+        break;
+    default:
+        *seconds = time(0);
+    }
+
+    if(nanoseconds != NULL)
+        *nanoseconds = fraction;
+}
@@ -0,0 +1,922 @@
+/**
+ * \file dateFormat.c
+ * Implementação do arquivo dateFormat.h
+ */
+
+#include "../h_files/dateFormat.h"
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Todos os pares de dígitos de 00 a 99, em sequência
+ */
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * Nomes dos dias da semana (0: domingo)
+ */
+static const char* const WEEK_DAY_NAMES[7] = {
+    "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
+};
+
+/**
+ * Tamanho de cada nome de dia da semana
+ */
+static const size_t WEEK_DAY_LENGTHS[7] = {6, 6, 7, 9, 8, 6, 8};
+
+/**
+ * Nomes dos meses (0: janeiro)
+ */
+static const char* const MONTH_NAMES[12] = {
+    "January", "February", "March", "April", "May", "June", "July", "August",
+    "September", "October", "November", "December"
+};
+
+/**
+ * Tamanho de cada nome de mês
+ */
+static const size_t MONTH_LENGTHS[12] = {7, 8, 5, 5, 3, 4, 4, 6, 9, 7, 8, 8};
+
+/**
+ * Maior texto gerado por uma conversão de um plano de formatação (o ano
+ * com sinal)
+ */
+#define FIELD_MAX_LENGTH 12
+
+/**
+ * Quantidade de dígitos de %f sem largura explícita
+ */
+#define DEFAULT_FRACTION_DIGITS 6
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Operações de um plano de formatação
+ */
+enum PlanOperation{
+    PLAN_LITERAL, ///< texto fixo
+    PLAN_YEAR, ///< %Y
+    PLAN_YEAR_SHORT, ///< %y
+    PLAN_MONTH, ///< %m
+    PLAN_MDAY, ///< %d
+    PLAN_MDAY_SPACE, ///< %e
+    PLAN_YDAY, ///< %j
+    PLAN_HOUR, ///< %H
+    PLAN_HOUR_AMPM, ///< %I
+    PLAN_AMPM, ///< %p
+    PLAN_MINUTE, ///< %M
+    PLAN_SECOND, ///< %S
+    PLAN_FRACTION, ///< %f
+    PLAN_MONTH_ABBREVIATED, ///< %b
+    PLAN_MONTH_NAME, ///< %B
+    PLAN_WEEK_DAY_ABBREVIATED, ///< %a
+    PLAN_WEEK_DAY_NAME, ///< %A
+    PLAN_OFFSET ///< %z
+};
+
+/**
+ * Passo de um plano de formatação
+ */
+struct planStep{
+    // o que o passo escreve
+    enum PlanOperation operation;
+    // se campos numéricos têm zeros à esquerda
+    bool padded;
+    // posição do texto fixo em literals (PLAN_LITERAL) ou dígitos de %f
+    size_t start;
+    // tamanho do texto fixo (PLAN_LITERAL)
+    size_t length;
+};
+
+/**
+ * Plano de formatação: o padrão já separado em passos
+ */
+struct dateFormatPlan{
+    // passos, na ordem do padrão
+    struct planStep* steps;
+    // quantidade de passos
+    size_t stepCount;
+    // textos fixos de todos os passos, em sequência
+    char* literals;
+    // maior texto que o plano pode gerar
+    size_t maxLength;
+    // se o plano tem %z (só então o deslocamento do fuso é consultado)
+    bool usesOffset;
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Escreve um número de 0 a 99 sem zeros à esquerda
+ * \return Quantidade de caracteres escritos
+ * \param out Memória onde o número será escrito
+ * \param value Número (0 - 99)
+ */
+static size_t writeSmallNumber(char* out, int value){
+    if(value < 10){
+        out[0] = (char) ('0' + value);
+        return 1;
+    }
+
+    out[0] = DIGIT_PAIRS[value * 2];
+    out[1] = DIGIT_PAIRS[value * 2 + 1];
+    return 2;
+}
+
+/**
+ * Escreve um número inteiro qualquer sem zeros à esquerda
+ * \return Quantidade de caracteres escritos
+ * \param out Memória onde o número será escrito (pelo menos 11 bytes)
+ * \param value Número
+ */
+static size_t writeNumber(char* out, int value){
+    char digits[12];
+    char* end = digits + sizeof(digits);
+    char* cursor = end;
+    unsigned int magnitude = (value < 0) ? 0u - (unsigned int) value : (unsigned int) value;
+    size_t length;
+
+    if(value >= 0 && value < 100)
+        return writeSmallNumber(out, value);
+
+    // escreve de trás para frente, dois dígitos por vez
+    while(magnitude >= 100){
+        unsigned int pair = (magnitude % 100) * 2;
+        magnitude /= 100;
+        cursor -= 2;
+        cursor[0] = DIGIT_PAIRS[pair];
+        cursor[1] = DIGIT_PAIRS[pair + 1];
+    }
+    if(magnitude >= 10){
+        cursor -= 2;
+        cursor[0] = DIGIT_PAIRS[magnitude * 2];
+        cursor[1] = DIGIT_PAIRS[magnitude * 2 + 1];
+    }
+    else
+        *--cursor = (char) ('0' + magnitude);
+
+    if(value < 0)
+        *--cursor = '-';
+
+    length = (size_t) (end - cursor);
+    memcpy(out, cursor, length);
+    return length;
+}
+
+/**
+ * Escreve dia, mês e ano separados por '/'
+ * \return Quantidade de caracteres escritos
+ * \param out Memória onde a data será escrita
+ * \param civil Componentes da data
+ * \param yearFirst Se true usa yyyy/mm/dd, se false dd/mm/yyyy
+ */
+static size_t writeCalendar(char* out, const CivilTime* civil, bool yearFirst){
+    size_t length;
+
+    if(yearFirst){
+        length = writeNumber(out, civil->year);
+        out[length++] = '/';
+        length += writeSmallNumber(out + length, civil->month);
+        out[length++] = '/';
+        length += writeSmallNumber(out + length, civil->mday);
+    }
+    else{
+        length = writeSmallNumber(out, civil->mday);
+        out[length++] = '/';
+        length += writeSmallNumber(out + length, civil->month);
+        out[length++] = '/';
+        length += writeNumber(out + length, civil->year);
+    }
+
+    return length;
+}
+
+/**
+ * Escreve hora, minuto e segundo separados por ':'
+ * \return Quantidade de caracteres escritos
+ * \param out Memória onde o horário será escrito
+ * \param civil Componentes da data
+ * \param ampm Se true usa o formato am/pm (com o sufixo " AM" ou " PM")
+ */
+static size_t writeClock(char* out, const CivilTime* civil, bool ampm){
+    size_t length;
+    int hour = civil->hour;
+
+    if(ampm)
+        hour = (hour == 0) ? 12 : (hour > 12 ? hour - 12 : hour);
+
+    length = writeSmallNumber(out, hour);
+    out[length++] = ':';
+    length += writeSmallNumber(out + length, civil->minute);
+    out[length++] = ':';
+    length += writeSmallNumber(out + length, civil->second);
+
+    if(ampm){
+        out[length++] = ' ';
+        out[length++] = (civil->hour < 12) ? 'A' : 'P';
+        out[length++] = 'M';
+    }
+
+    return length;
+}
+
+/**
+ * Escreve um número com uma quantidade mínima de dígitos
+ * \return Quantidade de caracteres escritos
+ * \param out Memória onde o número será escrito (pelo menos 11 bytes)
+ * \param value Número
+ * \param digits Quantidade mínima de dígitos (2 ou 3)
+ * \param padded Se completa com zeros à esquerda (senão, ignora digits)
+ */
+static size_t writePaddedNumber(char* out, int value, int digits, bool padded){
+    if(!padded || value < 0 || value > 999)
+        return writeNumber(out, value);
+
+    if(digits == 3){
+        out[0] = (char) ('0' + value / 100);
+        out[1] = DIGIT_PAIRS[value % 100 * 2];
+        out[2] = DIGIT_PAIRS[value % 100 * 2 + 1];
+        return 3;
+    }
+    if(value > 99)
+        return writeNumber(out, value);
+
+    out[0] = DIGIT_PAIRS[value * 2];
+    out[1] = DIGIT_PAIRS[value * 2 + 1];
+    return 2;
+}
+
+/**
+ * Escreve uma conversão de um plano de formatação
+ * \return Quantidade de caracteres escritos
+ * \param out Memória onde o campo será escrito (pelo menos FIELD_MAX_LENGTH
+ *      bytes)
+ * \param step Passo do plano (nunca PLAN_LITERAL)
+ * \param civil Componentes da data
+ * \param nanoseconds Fração de segundo em nanossegundos
+ * \param utcOffset Deslocamento do fuso em segundos
+ */
+static size_t writeField(char* out, const struct planStep* step, const CivilTime* civil,
+        long nanoseconds, long utcOffset){
+    long magnitude;
+    size_t i;
+
+    switch(step->operation){
+    case PLAN_YEAR:
+        // ano com 4 dígitos: dois pares da tabela
+        if(step->padded && civil->year >= 0 && civil->year <= 9999){
+            writePaddedNumber(out, civil->year / 100, 2, true);
+            writePaddedNumber(out + 2, civil->year % 100, 2, true);
+            return 4;
+        }
+        return writeNumber(out, civil->year);
+    case PLAN_YEAR_SHORT:
+        return writePaddedNumber(out, (civil->year % 100 + 100) % 100, 2, step->padded);
+    case PLAN_MONTH:
+        return writePaddedNumber(out, civil->month, 2, step->padded);
+    case PLAN_MDAY:
+        return writePaddedNumber(out, civil->mday, 2, step->padded);
+    case PLAN_MDAY_SPACE:
+        if(step->padded && civil->mday >= 0 && civil->mday < 10){
+            out[0] = ' ';
+            out[1] = (char) ('0' + civil->mday);
+            return 2;
+        }
+        return writeNumber(out, civil->mday);
+    case PLAN_YDAY:
+        return writePaddedNumber(out, civil->yday + 1, 3, step->padded);
+    case PLAN_HOUR:
+        return writePaddedNumber(out, civil->hour, 2, step->padded);
+    case PLAN_HOUR_AMPM:
+        return writePaddedNumber(out, (civil->hour % 12 == 0) ? 12 : civil->hour % 12, 2,
+                step->padded);
+    case PLAN_AMPM:
+        out[0] = (civil->hour < 12) ? 'A' : 'P';
+        out[1] = 'M';
+        return 2;
+    case PLAN_MINUTE:
+        return writePaddedNumber(out, civil->minute, 2, step->padded);
+    case PLAN_SECOND:
+        return writePaddedNumber(out, civil->second, 2, step->padded);
+    case PLAN_FRACTION:
+        // os primeiros step->start dígitos dos 9 dos nanossegundos
+        magnitude = (nanoseconds >= 0 && nanoseconds < 1000000000L) ? nanoseconds : 0;
+        for(i = step->start; i < 9; i++)
+            magnitude /= 10;
+        for(i = step->start; i > 0; i--){
+            out[i - 1] = (char) ('0' + magnitude % 10);
+            magnitude /= 10;
+        }
+        return step->start;
+    case PLAN_MONTH_ABBREVIATED:
+    case PLAN_MONTH_NAME:
+        if(civil->month < 1 || civil->month > 12)
+            return 0;
+        i = (step->operation == PLAN_MONTH_NAME) ? MONTH_LENGTHS[civil->month - 1] : 3;
+        memcpy(out, MONTH_NAMES[civil->month - 1], i);
+        return i;
+    case PLAN_WEEK_DAY_ABBREVIATED:
+    case PLAN_WEEK_DAY_NAME:
+        if(civil->wday < SUNDAY || civil->wday > SATURDAY)
+            return 0;
+        i = (step->operation == PLAN_WEEK_DAY_NAME) ? WEEK_DAY_LENGTHS[civil->wday] : 3;
+        memcpy(out, WEEK_DAY_NAMES[civil->wday], i);
+        return i;
+    case PLAN_OFFSET:
+        magnitude = (utcOffset < 0) ? -utcOffset : utcOffset;
+        out[0] = (utcOffset < 0) ? '-' : '+';
+        writePaddedNumber(out + 1, (int) (magnitude / 3600 % 100), 2, true);
+        writePaddedNumber(out + 3, (int) (magnitude % 3600 / 60), 2, true);
+        return 5;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Retorna o maior texto que uma conversão pode gerar
+ * \return Quantidade máxima de caracteres
+ * \param step Passo do plano (nunca PLAN_LITERAL)
+ */
+static size_t fieldMaxLength(const struct planStep* step){
+    switch(step->operation){
+    case PLAN_YEAR: return 11;
+    case PLAN_YDAY: return 3;
+    case PLAN_FRACTION: return step->start;
+    case PLAN_MONTH_ABBREVIATED:
+    case PLAN_WEEK_DAY_ABBREVIATED: return 3;
+    case PLAN_MONTH_NAME:
+    case PLAN_WEEK_DAY_NAME: return 9;
+    case PLAN_OFFSET: return 5;
+    default: return 2;
+    }
+}
+
+/**
+ * Acrescenta um caractere fixo ao plano, juntando-o ao texto fixo anterior
+ * \param plan Plano sendo compilado
+ * \param used Ponteiro para a quantidade de caracteres já usados em literals
+ * \param character Caractere
+ */
+static void appendLiteral(DateFormatPlan* plan, size_t* used, char character){
+    struct planStep* last = (plan->stepCount > 0) ? &plan->steps[plan->stepCount - 1] : NULL;
+
+    if(last == NULL || last->operation != PLAN_LITERAL){
+        last = &plan->steps[plan->stepCount++];
+        last->operation = PLAN_LITERAL;
+        last->start = *used;
+        last->length = 0;
+    }
+
+    plan->literals[(*used)++] = character;
+    last->length++;
+    plan->maxLength++;
+}
+
+/**
+ * Divisão inteira arredondada para baixo (também para valores negativos)
+ * \return Quociente
+ * \param value Dividendo
+ * \param divisor Divisor (positivo)
+ */
+static long long floorDiv(long long value, long long divisor){
+    long long quotient = value / divisor;
+    if(value % divisor < 0)
+        quotient--;
+    return quotient;
+}
+
+/**
+ * Reescreve o horário e o nome do dia da semana no texto de um formatador
+ * com memória
+ * \param cache Ponteiro para o formatador
+ * \param secondOfDay Segundo do dia (ignorado se o formato não tiver horário)
+ */
+static void writeCacheTime(DateFormatCache* cache, int secondOfDay){
+    size_t length = cache->clockStart;
+
+    if(cache->clock){
+        CivilTime civil;
+        civil.hour = secondOfDay / 3600;
+        civil.minute = secondOfDay / 60 % 60;
+        civil.second = secondOfDay % 60;
+
+        length += writeClock(cache->text + length, &civil, cache->ampm);
+        cache->secondStart = length - (cache->ampm ? 3 : 0) - (civil.second < 10 ? 1 : 2);
+        cache->secondOfDay = secondOfDay;
+    }
+
+    if(cache->weekDayName){
+        cache->text[length++] = ' ';
+        memcpy(cache->text + length, WEEK_DAY_NAMES[cache->weekDay],
+                WEEK_DAY_LENGTHS[cache->weekDay]);
+        length += WEEK_DAY_LENGTHS[cache->weekDay];
+    }
+
+    cache->text[length] = '\0';
+    cache->length = length;
+}
+
+/**
+ * Formata por inteiro o dia de uma data no texto de um formatador com memória
+ * e calcula o intervalo em que esse dia vale
+ * \return false se o formato for inválido
+ * \param cache Ponteiro para o formatador
+ * \param seconds Data em segundos desde 1970
+ */
+static bool refreshCache(DateFormatCache* cache, time_t seconds){
+    time_t windowFrom, windowUntil;
+    long long local, dayEnd;
+    bool calendar = true;
+    bool yearFirst = false;
+    size_t length = 0;
+    CivilTime civil;
+
+    switch(cache->dateString){
+    case DATE_DMY:
+    case DATE_DMY_HMS:
+    case DATE_DMY_HMS_AMPM:
+        break;
+    case DATE_YMD:
+    case DATE_YMD_HMS:
+    case DATE_YMD_HMS_AMPM:
+        yearFirst = true;
+        break;
+    case DATE_HMS:
+    case DATE_HMS_AMPM:
+        calendar = false;
+        break;
+    default:
+        return false;
+    }
+
+    cache->offset = getZoneUtcOffsetWindow(cache->zone, seconds, &windowFrom, &windowUntil);
+    local = (long long) seconds + cache->offset;
+    civilTimeFromSeconds(local, &civil);
+    cache->dayStart = floorDiv(local, SECONDS_PER_DAY) * SECONDS_PER_DAY;
+    cache->weekDay = civil.wday;
+
+    // o dia vale enquanto o deslocamento e o dia local não mudam
+    dayEnd = cache->dayStart + SECONDS_PER_DAY - 1;
+    cache->from = (cache->dayStart - cache->offset > (long long) windowFrom)
+            ? (time_t) (cache->dayStart - cache->offset) : windowFrom;
+    cache->until = (dayEnd - cache->offset < (long long) windowUntil)
+            ? (time_t) (dayEnd - cache->offset) : windowUntil;
+
+    if(calendar){
+        length = writeCalendar(cache->text, &civil, yearFirst);
+        if(cache->clock)
+            cache->text[length++] = ' ';
+    }
+    cache->clockStart = length;
+    writeCacheTime(cache, (int) (local - cache->dayStart));
+    return true;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Formata componentes de data em um dos formatos de enum DateString<BR>
+ * O texto gerado é o mesmo de getStringDate() e sempre termina com '\0'
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o texto
+ *      não couber na capacidade informada
+ * \param civil Componentes da data (veja dateCivil.h)
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja date.h)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatCivilTime(const CivilTime* civil, enum DateString dateString,
+        bool weekDayName, char* buffer, size_t capacity){
+    // monta o texto em memória local, cujo tamanho cobre qualquer formato
+    char text[DATE_STRING_SIZE + 8];
+    size_t length = 0;
+
+    switch(dateString){
+    case DATE_DMY:
+        length = writeCalendar(text, civil, false);
+        break;
+    case DATE_YMD:
+        length = writeCalendar(text, civil, true);
+        break;
+    case DATE_HMS:
+        length = writeClock(text, civil, false);
+        break;
+    case DATE_HMS_AMPM:
+        length = writeClock(text, civil, true);
+        break;
+    case DATE_DMY_HMS:
+    case DATE_YMD_HMS:
+    case DATE_DMY_HMS_AMPM:
+    case DATE_YMD_HMS_AMPM:
+        length = writeCalendar(text, civil,
+                dateString == DATE_YMD_HMS || dateString == DATE_YMD_HMS_AMPM);
+        text[length++] = ' ';
+        length += writeClock(text + length, civil,
+                dateString == DATE_DMY_HMS_AMPM || dateString == DATE_YMD_HMS_AMPM);
+        break;
+    default:
+        return 0;
+    }
+
+    if(weekDayName && civil->wday >= SUNDAY && civil->wday <= SATURDAY){
+        text[length++] = ' ';
+        memcpy(text + length, WEEK_DAY_NAMES[civil->wday], WEEK_DAY_LENGTHS[civil->wday]);
+        length += WEEK_DAY_LENGTHS[civil->wday];
+    }
+
+    if(buffer == NULL || length + 1 > capacity)
+        return 0;
+
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * Formata uma data em um dos formatos de enum DateString
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o texto
+ *      não couber na capacidade informada
+ * \param date Ponteiro para objeto Date
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja date.h)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatDate(Date** date, enum DateString dateString, bool weekDayName,
+        char* buffer, size_t capacity){
+    CivilTime civil;
+
+    getDateCivilTime(date, &civil);
+
+    return formatCivilTime(&civil, dateString, weekDayName, buffer, capacity);
+}
+
+/**
+ * Escreve o nome de um dia da semana
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o nome
+ *      não couber na capacidade informada ou o dia não for válido
+ * \param weekDay Dia da semana (0: domingo, 6: sábado)
+ * \param buffer Memória onde o nome será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatWeekDay(int weekDay, char* buffer, size_t capacity){
+    size_t length;
+
+    if(weekDay < SUNDAY || weekDay > SATURDAY || buffer == NULL)
+        return 0;
+
+    length = WEEK_DAY_LENGTHS[weekDay];
+    if(length + 1 > capacity)
+        return 0;
+
+    memcpy(buffer, WEEK_DAY_NAMES[weekDay], length);
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * Compila um padrão no estilo de strftime() em um plano de formatação<BR>
+ * Conversões aceitas (campos numéricos com zeros à esquerda; o modificador
+ * '-', como em "%-d", tira os zeros):<BR>
+ * &nbsp; &nbsp; %Y ano (pelo menos 4 dígitos), %y ano com 2 dígitos<BR>
+ * &nbsp; &nbsp; %m mês, %d dia do mês, %e dia do mês com espaço à esquerda,
+ * %j dia do ano (001 - 366)<BR>
+ * &nbsp; &nbsp; %H hora (00 - 23), %I hora (01 - 12), %p AM ou PM, %M
+ * minuto, %S segundo<BR>
+ * &nbsp; &nbsp; %f fração de segundo com 6 dígitos, ou com 1 a 9 dígitos em
+ * "%3f" ... "%9f"<BR>
+ * &nbsp; &nbsp; %b e %B nome do mês abreviado e completo, %a e %A nome do
+ * dia da semana abreviado e completo (em inglês, como getStringWeekDay())<BR>
+ * &nbsp; &nbsp; %z deslocamento do fuso (+hhmm), %% o caractere '%'<BR>
+ * Os demais caracteres são copiados sem mudança
+ * \return Ponteiro para objeto DateFormatPlan, ou NULL se o padrão tiver uma
+ *      conversão desconhecida ou faltar memória
+ * \param pattern Padrão terminado em '\0'
+ */
+DateFormatPlan* compileDateFormat(const char* pattern){
+    static const char CONVERSIONS[] = "YymdejHIpMSfbBaAz";
+    static const enum PlanOperation OPERATIONS[] = {PLAN_YEAR, PLAN_YEAR_SHORT,
+        PLAN_MONTH, PLAN_MDAY, PLAN_MDAY_SPACE, PLAN_YDAY, PLAN_HOUR, PLAN_HOUR_AMPM,
+        PLAN_AMPM, PLAN_MINUTE, PLAN_SECOND, PLAN_FRACTION, PLAN_MONTH_ABBREVIATED,
+        PLAN_MONTH_NAME, PLAN_WEEK_DAY_ABBREVIATED, PLAN_WEEK_DAY_NAME, PLAN_OFFSET};
+    DateFormatPlan* plan;
+    size_t length;
+    size_t used = 0;
+    const char* cursor;
+
+    if(pattern == NULL)
+        return NULL;
+
+    plan = calloc(1, sizeof(DateFormatPlan));
+    if(plan == NULL)
+        return NULL;
+
+    // cada caractere do padrão gera no máximo um passo e um caractere fixo
+    length = strlen(pattern);
+    plan->steps = calloc(length + 1, sizeof(struct planStep));
+    plan->literals = malloc(length + 1);
+    if(plan->steps == NULL || plan->literals == NULL)
+        return destroyDateFormatPlan(plan);
+
+    for(cursor = pattern; *cursor != '\0'; cursor++){
+        struct planStep* step;
+        const char* conversion;
+        bool padded = true;
+        size_t width = 0;
+
+        if(*cursor != '%'){
+            appendLiteral(plan, &used, *cursor);
+            continue;
+        }
+
+        cursor++;
+        if(*cursor == '-'){
+            padded = false;
+            cursor++;
+        }
+        if(*cursor >= '1' && *cursor <= '9'){
+            width = (size_t) (*cursor - '0');
+            cursor++;
+        }
+
+        if(*cursor == '%' && padded && width == 0){
+            appendLiteral(plan, &used, '%');
+            continue;
+        }
+
+        // a largura só faz sentido em %f
+        conversion = (*cursor != '\0') ? strchr(CONVERSIONS, *cursor) : NULL;
+        if(conversion == NULL || (width != 0 && *cursor != 'f'))
+            return destroyDateFormatPlan(plan);
+
+        step = &plan->steps[plan->stepCount++];
+        step->operation = OPERATIONS[conversion - CONVERSIONS];
+        step->padded = padded;
+        if(step->operation == PLAN_FRACTION)
+            step->start = (width != 0) ? width : DEFAULT_FRACTION_DIGITS;
+        plan->maxLength += fieldMaxLength(step);
+        plan->usesOffset = plan->usesOffset || step->operation == PLAN_OFFSET;
+    }
+
+    return plan;
+}
+
+/**
+ * Desaloca o plano de formatação
+ * \return NULL
+ * \param plan Ponteiro para objeto DateFormatPlan a ser desalocado
+ */
+DateFormatPlan* destroyDateFormatPlan(DateFormatPlan* plan){
+    if(plan == NULL)
+        return NULL;
+
+    free(plan->steps);
+    free(plan->literals);
+    free(plan);
+    return NULL;
+}
+
+/**
+ * Retorna o maior texto que o plano pode gerar
+ * \return Quantidade máxima de caracteres (sem o '\0')
+ * \param plan Ponteiro para objeto DateFormatPlan
+ */
+size_t getDateFormatPlanMaxLength(const DateFormatPlan* plan){
+    return plan->maxLength;
+}
+
+/**
+ * Formata componentes de data com um plano de formatação<BR>
+ * O texto sempre termina com '\0'
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o texto
+ *      não couber na capacidade informada
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param civil Componentes da data (veja dateCivil.h)
+ * \param nanoseconds Fração de segundo em nanossegundos (usada por %f)
+ * \param utcOffset Deslocamento do fuso em segundos (usado por %z)
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatCivilTimePlan(const DateFormatPlan* plan, const CivilTime* civil,
+        long nanoseconds, long utcOffset, char* buffer, size_t capacity){
+    size_t length = 0;
+    size_t i;
+
+    if(plan == NULL || buffer == NULL || capacity == 0)
+        return 0;
+
+    for(i = 0; i < plan->stepCount; i++){
+        const struct planStep* step = &plan->steps[i];
+
+        if(step->operation == PLAN_LITERAL){
+            if(length + step->length >= capacity)
+                return 0;
+            memcpy(buffer + length, plan->literals + step->start, step->length);
+            length += step->length;
+        }
+        else if(length + FIELD_MAX_LENGTH < capacity)
+            // com folga, o campo é escrito direto no destino
+            length += writeField(buffer + length, step, civil, nanoseconds, utcOffset);
+        else{
+            char field[FIELD_MAX_LENGTH];
+            size_t written = writeField(field, step, civil, nanoseconds, utcOffset);
+
+            if(length + written >= capacity)
+                return 0;
+            memcpy(buffer + length, field, written);
+            length += written;
+        }
+    }
+
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * Formata uma data com um plano de formatação
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o texto
+ *      não couber na capacidade informada
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param date Ponteiro para objeto Date
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatDatePlan(const DateFormatPlan* plan, Date** date, char* buffer,
+        size_t capacity){
+    CivilTime civil;
+    long offset = 0;
+
+    if(plan == NULL)
+        return 0;
+
+    getDateCivilTime(date, &civil);
+    if(plan->usesOffset)
+        offset = getZoneUtcOffset(getDateTimeZone(date), getDateInSeconds(date));
+
+    return formatCivilTimePlan(plan, &civil, getDateNanoseconds(date), offset, buffer, capacity);
+}
+
+/**
+ * Formata um vetor de datas com um plano de formatação<BR>
+ * Cada texto ocupa stride bytes em texts e termina com '\0'; textos que não
+ * couberem ficam vazios. Com stride maior que getDateFormatPlanMaxLength()
+ * todos os textos cabem
+ * \return Quantidade de datas formatadas
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param texts Memória com count * stride bytes onde os textos serão escritos
+ * \param stride Espaço de cada texto em bytes
+ * \param lengths Vetor onde será guardado o tamanho de cada texto (pode ser
+ *      NULL)
+ */
+size_t formatDatesBatchPlan(const DateFormatPlan* plan, const TimeZone* zone,
+        const time_t* seconds, size_t count, char* texts, size_t stride, size_t* lengths){
+    time_t from = 1;
+    time_t until = 0;
+    long offset = 0;
+    size_t formatted = 0;
+    size_t i;
+
+    if(plan == NULL || texts == NULL || stride == 0 || (seconds == NULL && count > 0))
+        return 0;
+
+    for(i = 0; i < count; i++){
+        CivilTime civil;
+        size_t length;
+
+        // o deslocamento só é consultado quando sai do intervalo válido
+        if(seconds[i] < from || seconds[i] > until)
+            offset = getZoneUtcOffsetWindow(zone, seconds[i], &from, &until);
+
+        civilTimeFromSeconds((long long) seconds[i] + offset, &civil);
+        length = formatCivilTimePlan(plan, &civil, 0, offset, texts + i * stride, stride);
+
+        // um plano sem conversões nem texto fixo gera o texto vazio
+        if(length > 0 || plan->maxLength == 0)
+            formatted++;
+        else
+            texts[i * stride] = '\0';
+        if(lengths != NULL)
+            lengths[i] = length;
+    }
+
+    return formatted;
+}
+
+/**
+ * Inicia um formatador com memória (veja struct dateFormatCache)
+ * \param cache Ponteiro para a estrutura a ser iniciada
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja date.h)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ */
+void startDateFormatCache(DateFormatCache* cache, const TimeZone* zone,
+        enum DateString dateString, bool weekDayName){
+    if(cache == NULL)
+        return;
+
+    memset(cache, 0, sizeof(DateFormatCache));
+    cache->zone = zone;
+    cache->dateString = dateString;
+    cache->weekDayName = weekDayName;
+    cache->clock = dateString != DATE_DMY && dateString != DATE_YMD;
+    cache->ampm = dateString == DATE_HMS_AMPM || dateString == DATE_DMY_HMS_AMPM
+            || dateString == DATE_YMD_HMS_AMPM;
+    // intervalo vazio: a primeira data é formatada por inteiro
+    cache->from = 1;
+    cache->until = 0;
+}
+
+/**
+ * Formata uma data com um formatador com memória<BR>
+ * O texto gerado é o mesmo de formatCivilTime() com os componentes da data
+ * no fuso do formatador
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o formato
+ *      for inválido ou o texto não couber na capacidade informada
+ * \param cache Ponteiro para o formatador
+ * \param seconds Data em segundos desde 1970
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatSecondsCached(DateFormatCache* cache, time_t seconds, char* buffer,
+        size_t capacity){
+    if(cache == NULL)
+        return 0;
+
+    if(seconds < cache->from || seconds > cache->until){
+        if(!refreshCache(cache, seconds))
+            return 0;
+    }
+    else if(cache->clock){
+        int secondOfDay = (int) ((long long) seconds + cache->offset - cache->dayStart);
+        int second = secondOfDay % 60;
+        int previous = cache->secondOfDay;
+
+        // mesmo minuto e segundos com a mesma largura: só os dígitos mudam
+        if(secondOfDay / 60 == previous / 60 && (second < 10) == (previous % 60 < 10)){
+            writeSmallNumber(cache->text + cache->secondStart, second);
+            cache->secondOfDay = secondOfDay;
+        }
+        else if(secondOfDay != previous)
+            writeCacheTime(cache, secondOfDay);
+    }
+
+    if(buffer == NULL || cache->length + 1 > capacity)
+        return 0;
+
+    memcpy(buffer, cache->text, cache->length + 1);
+    return cache->length;
+}
+
+/**
+ * Formata um objeto Date com um formatador com memória (o mesmo texto de
+ * formatDate())<BR>
+ * Se o fuso da data não for o do formatador, o formatador passa a usar o
+ * fuso da data
+ * \return Quantidade de caracteres escritos (sem o '\0'), ou 0 se o formato
+ *      for inválido ou o texto não couber na capacidade informada
+ * \param cache Ponteiro para o formatador
+ * \param date Ponteiro para objeto Date
+ * \param buffer Memória onde o texto será escrito
+ * \param capacity Tamanho da memória em bytes
+ */
+size_t formatDateCached(DateFormatCache* cache, Date** date, char* buffer,
+        size_t capacity){
+    const TimeZone* zone;
+
+    if(cache == NULL)
+        return 0;
+
+    zone = getDateTimeZone(date);
+    if(zone != cache->zone){
+        cache->zone = zone;
+        cache->from = 1;
+        cache->until = 0;
+    }
+
+    return formatSecondsCached(cache, getDateInSeconds(date), buffer, capacity);
+}
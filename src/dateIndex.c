@@ -0,0 +1,364 @@
+/**
+ * \file dateIndex.c
+ * Implementação do arquivo dateIndex.h
+ */
+
+#include "../h_files/dateIndex.h"
+#include "../h_files/dateCivil.h"
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Maior quantidade de dias na tabela de começos de dia (cerca de 11 mil
+ * anos). Índices com datas mais espalhadas respondem às consultas por dia e
+ * mês com buscas logarítmicas
+ */
+#define MAX_DAY_BUCKETS 4000000LL
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Estrutura do objeto índice de datas
+ */
+struct dateIndex{
+    // datas em ordem crescente
+    time_t* sorted;
+    // quantidade de datas
+    size_t count;
+    // árvore de busca no layout de Eytzinger (posições 1 a count)
+    time_t* tree;
+    // posição no vetor ordenado de cada nó da árvore
+    size_t* rank;
+    // fuso das consultas por dia e mês
+    const TimeZone* zone;
+    // primeiro dia da tabela (dias desde 1970 no fuso do índice)
+    long long firstDay;
+    // quantidade de dias da tabela
+    size_t dayCount;
+    // posição da primeira data de cada dia (dayCount + 1 posições)
+    size_t* dayStart;
+    // primeiro mês da tabela (ano * 12 + mês - 1)
+    long long firstMonth;
+    // quantidade de meses da tabela
+    size_t monthCount;
+    // posição da primeira data de cada mês (monthCount + 1 posições)
+    size_t* monthStart;
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Compara duas datas para qsort()
+ * \return Negativo, zero ou positivo
+ * \param first Ponteiro para a primeira data
+ * \param second Ponteiro para a segunda data
+ */
+static int compareSeconds(const void* first, const void* second){
+    time_t a = *(const time_t*) first;
+    time_t b = *(const time_t*) second;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Preenche a árvore de Eytzinger percorrendo-a em ordem
+ * \return Próxima posição do vetor ordenado a ser usada
+ * \param index Índice em construção
+ * \param position Próxima posição do vetor ordenado
+ * \param node Nó atual da árvore (1 é a raiz)
+ */
+static size_t buildTree(DateIndex* index, size_t position, size_t node){
+    if(node > index->count)
+        return position;
+
+    position = buildTree(index, position, 2 * node);
+    index->tree[node] = index->sorted[position];
+    index->rank[node] = position;
+    return buildTree(index, position + 1, 2 * node + 1);
+}
+
+/**
+ * Retorna o dia (no fuso do índice) de uma data
+ * \return Dias desde 1970
+ * \param index Índice
+ * \param seconds Data em segundos desde 1970
+ */
+static long long localDay(const DateIndex* index, time_t seconds){
+    long long local = (long long) seconds + getZoneUtcOffset(index->zone, seconds);
+    long long day = local / SECONDS_PER_DAY;
+    return day - ((local % SECONDS_PER_DAY) < 0);
+}
+
+/**
+ * Retorna o instante em que um dia começa no fuso do índice
+ * \return Segundos desde 1970
+ * \param index Índice
+ * \param day Dias desde 1970
+ */
+static time_t dayBoundary(const DateIndex* index, long long day){
+    return zoneLocalSecondsToTime(index->zone, day * SECONDS_PER_DAY);
+}
+
+/**
+ * Avança uma posição do vetor ordenado até a primeira data maior ou igual a
+ * um instante
+ * \return Nova posição
+ * \param index Índice
+ * \param position Posição atual (todas as datas antes dela são menores)
+ * \param boundary Instante
+ */
+static size_t advanceTo(const DateIndex* index, size_t position, time_t boundary){
+    while(position < index->count && index->sorted[position] < boundary)
+        position++;
+    return position;
+}
+
+/**
+ * Monta as tabelas de começo de cada dia e de cada mês
+ * \return false se faltar memória
+ * \param index Índice em construção (com o vetor ordenado)
+ */
+static bool buildBuckets(DateIndex* index){
+    long long lastDay, day, month, lastMonth;
+    size_t position, i;
+    int year, monthOfYear, dayOfMonth;
+
+    if(index->count == 0)
+        return true;
+
+    // uma folga de um dia cobre deslocamentos que voltam o relógio
+    index->firstDay = localDay(index, index->sorted[0]) - 1;
+    lastDay = localDay(index, index->sorted[index->count - 1]) + 1;
+    if(lastDay - index->firstDay + 1 > MAX_DAY_BUCKETS)
+        return true;
+
+    index->dayCount = (size_t) (lastDay - index->firstDay + 1);
+    index->dayStart = malloc((index->dayCount + 1) * sizeof(size_t));
+    if(index->dayStart == NULL)
+        return false;
+
+    position = 0;
+    for(i = 0; i <= index->dayCount; i++){
+        position = advanceTo(index, position, dayBoundary(index, index->firstDay + (long long) i));
+        index->dayStart[i] = position;
+    }
+
+    // meses que contêm o primeiro e o último dia da tabela
+    civilFromDays(index->firstDay, &year, &monthOfYear, &dayOfMonth);
+    index->firstMonth = (long long) year * 12 + (monthOfYear - 1);
+    civilFromDays(lastDay, &year, &monthOfYear, &dayOfMonth);
+    lastMonth = (long long) year * 12 + (monthOfYear - 1);
+
+    index->monthCount = (size_t) (lastMonth - index->firstMonth + 1);
+    index->monthStart = malloc((index->monthCount + 1) * sizeof(size_t));
+    if(index->monthStart == NULL)
+        return false;
+
+    position = 0;
+    for(i = 0; i <= index->monthCount; i++){
+        month = index->firstMonth + (long long) i;
+        year = (int) ((month >= 0 ? month : month - 11) / 12);
+        day = daysFromCivil(year, (int) (month - (long long) year * 12) + 1, 1);
+        position = advanceTo(index, position, dayBoundary(index, day));
+        index->monthStart[i] = position;
+    }
+
+    return true;
+}
+
+/**
+ * Monta um trecho a partir de duas posições do vetor ordenado
+ * \return Trecho
+ * \param index Índice
+ * \param first Primeira posição
+ * \param end Posição seguinte à última
+ */
+static DateSpan makeSpan(const DateIndex* index, size_t first, size_t end){
+    DateSpan span;
+
+    if(end < first)
+        end = first;
+
+    span.seconds = (index->sorted != NULL) ? index->sorted + first : NULL;
+    span.first = first;
+    span.count = end - first;
+    return span;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Cria um índice sobre um vetor de datas<BR>
+ * As datas são copiadas (e ordenadas, se necessário); o vetor original pode
+ * ser liberado em seguida
+ * \return Ponteiro para objeto DateIndex, ou NULL se não conseguir
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param zone Fuso usado nas consultas por dia e mês (NULL para o fuso
+ *      local). O fuso deve continuar carregado enquanto o índice existir
+ */
+DateIndex* createDateIndex(const time_t* seconds, size_t count, const TimeZone* zone){
+    DateIndex* index;
+    bool sorted = true;
+    size_t i;
+
+    if((seconds == NULL && count > 0) || count >= SIZE_MAX / sizeof(size_t) - 1)
+        return NULL;
+
+    index = calloc(1, sizeof(DateIndex));
+    if(index == NULL)
+        return NULL;
+
+    index->count = count;
+    index->zone = zone;
+    index->sorted = malloc((count + 1) * sizeof(time_t));
+    index->tree = malloc((count + 1) * sizeof(time_t));
+    index->rank = malloc((count + 1) * sizeof(size_t));
+    if(index->sorted == NULL || index->tree == NULL || index->rank == NULL)
+        return destroyDateIndex(index);
+
+    if(count > 0)
+        memcpy(index->sorted, seconds, count * sizeof(time_t));
+    for(i = 1; i < count && sorted; i++)
+        sorted = seconds[i - 1] <= seconds[i];
+    if(!sorted)
+        qsort(index->sorted, count, sizeof(time_t), compareSeconds);
+
+    buildTree(index, 0, 1);
+
+    if(!buildBuckets(index))
+        return destroyDateIndex(index);
+
+    return index;
+}
+
+/**
+ * Desaloca o índice
+ * \return NULL
+ * \param index Ponteiro para objeto DateIndex a ser desalocado
+ */
+DateIndex* destroyDateIndex(DateIndex* index){
+    if(index == NULL)
+        return NULL;
+
+    free(index->sorted);
+    free(index->tree);
+    free(index->rank);
+    free(index->dayStart);
+    free(index->monthStart);
+    free(index);
+    return NULL;
+}
+
+/**
+ * Retorna todas as datas do índice, em ordem crescente
+ * \return Trecho com todas as datas
+ * \param index Ponteiro para objeto DateIndex
+ */
+DateSpan getDateIndexSpan(const DateIndex* index){
+    return makeSpan(index, 0, index->count);
+}
+
+/**
+ * Retorna a posição da primeira data maior ou igual a um instante
+ * \return Posição no vetor ordenado (a quantidade de datas se não houver)
+ * \param index Ponteiro para objeto DateIndex
+ * \param seconds Instante em segundos desde 1970
+ */
+size_t findDateIndexLowerBound(const DateIndex* index, time_t seconds){
+    size_t node = 1;
+
+    // desce sem desvios; os netos dos netos já são trazidos para o cache
+    while(node <= index->count){
+        __builtin_prefetch(index->tree + node * 16);
+        node = 2 * node + (index->tree[node] < seconds);
+    }
+
+    // volta até o último nó em que a busca foi para a esquerda
+    node >>= __builtin_ffsll((long long) ~node);
+
+    return (node == 0) ? index->count : index->rank[node];
+}
+
+/**
+ * Retorna as datas do intervalo [from, until)
+ * \return Trecho com as datas do intervalo (vazio se until <= from)
+ * \param index Ponteiro para objeto DateIndex
+ * \param from Início do intervalo em segundos desde 1970 (incluído)
+ * \param until Fim do intervalo em segundos desde 1970 (excluído)
+ */
+DateSpan findDateIndexRange(const DateIndex* index, time_t from, time_t until){
+    if(until <= from)
+        return makeSpan(index, 0, 0);
+
+    return makeSpan(index, findDateIndexLowerBound(index, from),
+            findDateIndexLowerBound(index, until));
+}
+
+/**
+ * Retorna as datas entre dois objetos Date, no intervalo [from, until)
+ * \return Trecho com as datas do intervalo
+ * \param index Ponteiro para objeto DateIndex
+ * \param from Ponteiro para objeto Date do início (incluído)
+ * \param until Ponteiro para objeto Date do fim (excluído)
+ */
+DateSpan findDateIndexBetween(const DateIndex* index, Date** from, Date** until){
+    return findDateIndexRange(index, getDateInSeconds(from), getDateInSeconds(until));
+}
+
+/**
+ * Retorna as datas de um dia no fuso do índice
+ * \return Trecho com as datas do dia (vazio se a data não for válida)
+ * \param index Ponteiro para objeto DateIndex
+ * \param day Dia do mês
+ * \param month Mês
+ * \param year Ano
+ */
+DateSpan findDateIndexDay(const DateIndex* index, int day, int month, int year){
+    long long days;
+
+    if(!validateDate(day, month, year, 0, 0, 0))
+        return makeSpan(index, 0, 0);
+
+    days = daysFromCivil(year, month, day);
+
+    // dia dentro da tabela: tempo constante
+    if(index->dayStart != NULL && days >= index->firstDay
+            && days - index->firstDay < (long long) index->dayCount){
+        size_t bucket = (size_t) (days - index->firstDay);
+        return makeSpan(index, index->dayStart[bucket], index->dayStart[bucket + 1]);
+    }
+
+    return findDateIndexRange(index, dayBoundary(index, days), dayBoundary(index, days + 1));
+}
+
+/**
+ * Retorna as datas de um mês no fuso do índice
+ * \return Trecho com as datas do mês (vazio se o mês não for válido)
+ * \param index Ponteiro para objeto DateIndex
+ * \param month Mês
+ * \param year Ano
+ */
+DateSpan findDateIndexMonth(const DateIndex* index, int month, int year){
+    long long bucket = (long long) year * 12 + (month - 1);
+
+    if(month < 1 || month > 12)
+        return makeSpan(index, 0, 0);
+
+    // mês dentro da tabela: tempo constante
+    if(index->monthStart != NULL && bucket >= index->firstMonth
+            && bucket - index->firstMonth < (long long) index->monthCount){
+        size_t position = (size_t) (bucket - index->firstMonth);
+        return makeSpan(index, index->monthStart[position], index->monthStart[position + 1]);
+    }
+
+    return findDateIndexRange(index, dayBoundary(index, daysFromCivil(year, month, 1)),
+            dayBoundary(index, daysFromCivil(year, month, 1) + daysInMonth(year, month)));
+}
@@ -0,0 +1,547 @@
+/**
+ * \file datePacked.c
+ * Implementação do arquivo datePacked.h
+ */
+
+#include "../h_files/datePacked.h"
+#include "../h_files/dateCivil.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Identificação no início de um arquivo colunar
+ */
+#define COLUMN_MAGIC "DATECOL"
+
+/**
+ * Versão do formato do arquivo colunar
+ */
+#define COLUMN_VERSION 1
+
+/**
+ * Valor gravado para conferir a ordem de bytes na leitura
+ */
+#define COLUMN_BYTE_ORDER 0x01020304u
+
+/**
+ * Deslocamento dos campos de PackedCivil
+ */
+#define CIVIL_YEAR_SHIFT 26
+#define CIVIL_MONTH_SHIFT 22
+#define CIVIL_DAY_SHIFT 17
+#define CIVIL_HOUR_SHIFT 12
+#define CIVIL_MINUTE_SHIFT 6
+
+/**
+ * Soma aplicada ao ano de PackedCivil para que anos negativos ordenem antes
+ */
+#define CIVIL_YEAR_BIAS 0x80000000u
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Cabeçalho de 64 bytes de um arquivo colunar
+ */
+struct columnHeader{
+    char magic[8]; ///< COLUMN_MAGIC
+    uint32_t version; ///< COLUMN_VERSION
+    uint32_t byteOrder; ///< COLUMN_BYTE_ORDER na ordem de bytes de quem gravou
+    uint32_t encoding; ///< enum PackedEncoding
+    uint32_t valueSize; ///< tamanho de cada valor em bytes
+    uint64_t count; ///< quantidade de valores
+    uint8_t reserved[32]; ///< zeros
+};
+
+/**
+ * Arquivo colunar mapeado em memória
+ */
+struct dateColumn{
+    // início do mapeamento (o cabeçalho)
+    void* map;
+    // tamanho do mapeamento
+    size_t size;
+    // codificação dos valores
+    enum PackedEncoding encoding;
+    // quantidade de valores
+    size_t count;
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Divisão inteira com arredondamento para baixo (também para negativos)
+ * \return Quociente arredondado para menos infinito
+ * \param value Dividendo
+ * \param divisor Divisor (positivo)
+ */
+static long long floorDiv(long long value, long long divisor){
+    long long quotient = value / divisor;
+    if((value % divisor) < 0)
+        quotient--;
+    return quotient;
+}
+
+/**
+ * Verifica se uma data está na faixa das codificações
+ * \return true se estiver
+ * \param seconds Segundos desde 1970
+ */
+static bool inPackedRange(long long seconds){
+    return seconds >= PACKED_MIN_SECONDS && seconds <= PACKED_MAX_SECONDS;
+}
+
+/**
+ * Retorna o tamanho dos valores de uma codificação
+ * \return Tamanho em bytes (0 se a codificação for desconhecida)
+ * \param encoding Codificação
+ */
+static size_t encodingSize(enum PackedEncoding encoding){
+    switch(encoding){
+    case PACKED_SECONDS: return sizeof(int64_t);
+    case PACKED_DAY: return sizeof(PackedDay);
+    case PACKED_DATE_TIME: return sizeof(PackedDateTime);
+    case PACKED_CIVIL: return sizeof(PackedCivil);
+    default: return 0;
+    }
+}
+
+/**
+ * Codifica em campos de bits uma data em UTC
+ * \return Data codificada
+ * \param seconds Segundos desde 1970 (na faixa das codificações)
+ */
+static PackedCivil encodeCivil(long long seconds){
+    CivilTime civil;
+
+    civilTimeFromSeconds(seconds, &civil);
+    return ((PackedCivil) ((uint32_t) civil.year + CIVIL_YEAR_BIAS) << CIVIL_YEAR_SHIFT)
+            | ((PackedCivil) civil.month << CIVIL_MONTH_SHIFT)
+            | ((PackedCivil) civil.mday << CIVIL_DAY_SHIFT)
+            | ((PackedCivil) civil.hour << CIVIL_HOUR_SHIFT)
+            | ((PackedCivil) civil.minute << CIVIL_MINUTE_SHIFT)
+            | (PackedCivil) civil.second;
+}
+
+/**
+ * Decodifica uma data em campos de bits
+ * \return false se os campos forem inválidos
+ * \param packed Data codificada
+ * \param seconds Ponteiro onde será guardada a data em segundos desde 1970
+ */
+static bool decodeCivil(PackedCivil packed, long long* seconds){
+    int year = (int) ((uint32_t) (packed >> CIVIL_YEAR_SHIFT) - CIVIL_YEAR_BIAS);
+    int month = (int) ((packed >> CIVIL_MONTH_SHIFT) & 0xF);
+    int day = (int) ((packed >> CIVIL_DAY_SHIFT) & 0x1F);
+    int hour = (int) ((packed >> CIVIL_HOUR_SHIFT) & 0x1F);
+    int minute = (int) ((packed >> CIVIL_MINUTE_SHIFT) & 0x3F);
+    int second = (int) (packed & 0x3F);
+
+    if((packed >> 58) != 0 || month < 1 || month > 12 || day < 1
+            || day > daysInMonth(year, month) || hour > 23 || minute > 59 || second > 59)
+        return false;
+
+    *seconds = secondsFromCivil(day, month, year, hour, minute, second);
+    return inPackedRange(*seconds);
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Codifica o dia de uma data (no fuso da data)
+ * \return false se a data estiver fora da faixa suportada
+ * \param date Ponteiro para objeto Date
+ * \param packed Ponteiro onde será guardado o dia
+ */
+bool packDateDay(Date** date, PackedDay* packed){
+    CivilTime civil;
+    long long day;
+
+    getDateCivilTime(date, &civil);
+    day = daysFromCivil(civil.year, civil.month, civil.mday);
+    if(day < INT32_MIN || day > INT32_MAX)
+        return false;
+
+    *packed = (PackedDay) day;
+    return true;
+}
+
+/**
+ * Define a data como a meia-noite (no fuso da data) de um dia codificado
+ * \return false se a data não puder ser representada por um objeto Date
+ * \param date Ponteiro para objeto Date
+ * \param packed Dia codificado
+ */
+bool unpackDateDay(Date** date, PackedDay packed){
+    int year, month, day;
+
+    civilFromDays(packed, &year, &month, &day);
+    return setDateComplete(date, day, month, year, 0, 0, 0);
+}
+
+/**
+ * Codifica uma data em dia e segundos desde a meia-noite em UTC
+ * \return false se a data estiver fora da faixa suportada
+ * \param date Ponteiro para objeto Date
+ * \param packed Ponteiro onde será guardada a data codificada
+ */
+bool packDateTime(Date** date, PackedDateTime* packed){
+    time_t seconds = getDateInSeconds(date);
+
+    return packDateTimesBatch(&seconds, 1, packed);
+}
+
+/**
+ * Define a data a partir de dia e segundos desde a meia-noite em UTC
+ * \return false se os campos forem inválidos
+ * \param date Ponteiro para objeto Date
+ * \param packed Data codificada
+ */
+bool unpackDateTime(Date** date, PackedDateTime packed){
+    time_t seconds;
+
+    // datas anteriores a 1970 também são aceitas
+    if(!unpackDateTimesBatch(&packed, 1, &seconds))
+        return false;
+    storeDate(date, seconds);
+    return true;
+}
+
+/**
+ * Codifica os componentes de uma data em UTC em campos de bits
+ * \return false se a data estiver fora da faixa suportada
+ * \param date Ponteiro para objeto Date
+ * \param packed Ponteiro onde será guardada a data codificada
+ */
+bool packDateCivil(Date** date, PackedCivil* packed){
+    time_t seconds = getDateInSeconds(date);
+
+    return packCivilBatch(&seconds, 1, packed);
+}
+
+/**
+ * Define a data a partir dos componentes em UTC codificados em campos de bits
+ * \return false se os campos forem inválidos
+ * \param date Ponteiro para objeto Date
+ * \param packed Data codificada
+ */
+bool unpackDateCivil(Date** date, PackedCivil packed){
+    time_t seconds;
+
+    // datas anteriores a 1970 também são aceitas
+    if(!unpackCivilBatch(&packed, 1, &seconds))
+        return false;
+    storeDate(date, seconds);
+    return true;
+}
+
+/**
+ * Codifica um vetor de datas em dias (no fuso informado)
+ * \return false se alguma data estiver fora da faixa suportada (essas
+ *      posições recebem 0)
+ * \param zone Fuso dos dias (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param packed Vetor onde serão guardados os dias
+ */
+bool packDaysBatch(const TimeZone* zone, const time_t* seconds, size_t count,
+        PackedDay* packed){
+    time_t from = 1;
+    time_t until = 0;
+    long offset = 0;
+    bool ok = true;
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        long long day;
+
+        // o deslocamento só é consultado quando sai do intervalo válido
+        if(seconds[i] < from || seconds[i] > until)
+            offset = getZoneUtcOffsetWindow(zone, seconds[i], &from, &until);
+
+        day = floorDiv((long long) seconds[i] + offset, SECONDS_PER_DAY);
+        if(day < INT32_MIN || day > INT32_MAX){
+            packed[i] = 0;
+            ok = false;
+        }
+        else
+            packed[i] = (PackedDay) day;
+    }
+
+    return ok;
+}
+
+/**
+ * Converte um vetor de dias na meia-noite (no fuso informado) de cada dia
+ * \param zone Fuso dos dias (NULL para o fuso local)
+ * \param packed Vetor de dias
+ * \param count Quantidade de dias
+ * \param seconds Vetor onde serão guardadas as datas em segundos desde 1970
+ */
+void unpackDaysBatch(const TimeZone* zone, const PackedDay* packed, size_t count,
+        time_t* seconds){
+    size_t i;
+
+    for(i = 0; i < count; i++)
+        seconds[i] = zoneLocalSecondsToTime(zone, (long long) packed[i] * SECONDS_PER_DAY);
+}
+
+/**
+ * Codifica um vetor de datas em dia e segundos desde a meia-noite em UTC
+ * \return false se alguma data estiver fora da faixa suportada (essas
+ *      posições recebem 0)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param packed Vetor onde serão guardadas as datas codificadas
+ */
+bool packDateTimesBatch(const time_t* seconds, size_t count, PackedDateTime* packed){
+    bool ok = true;
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        long long day = floorDiv(seconds[i], SECONDS_PER_DAY);
+
+        if(!inPackedRange(seconds[i])){
+            packed[i].day = 0;
+            packed[i].second = 0;
+            ok = false;
+            continue;
+        }
+
+        packed[i].day = (int32_t) day;
+        packed[i].second = (uint32_t) (seconds[i] - day * SECONDS_PER_DAY);
+    }
+
+    return ok;
+}
+
+/**
+ * Decodifica um vetor de datas em dia e segundos desde a meia-noite em UTC
+ * \return false se alguma data codificada for inválida (essas posições
+ *      recebem 0)
+ * \param packed Vetor de datas codificadas
+ * \param count Quantidade de datas
+ * \param seconds Vetor onde serão guardadas as datas em segundos desde 1970
+ */
+bool unpackDateTimesBatch(const PackedDateTime* packed, size_t count, time_t* seconds){
+    bool ok = true;
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        if(packed[i].second >= SECONDS_PER_DAY){
+            seconds[i] = 0;
+            ok = false;
+        }
+        else
+            seconds[i] = (time_t) ((long long) packed[i].day * SECONDS_PER_DAY + packed[i].second);
+    }
+
+    return ok;
+}
+
+/**
+ * Codifica um vetor de datas em componentes UTC em campos de bits
+ * \return false se alguma data estiver fora da faixa suportada (essas
+ *      posições recebem 0)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param packed Vetor onde serão guardadas as datas codificadas
+ */
+bool packCivilBatch(const time_t* seconds, size_t count, PackedCivil* packed){
+    bool ok = true;
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        if(inPackedRange(seconds[i]))
+            packed[i] = encodeCivil(seconds[i]);
+        else{
+            packed[i] = 0;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+/**
+ * Decodifica um vetor de datas em componentes UTC em campos de bits
+ * \return false se alguma data codificada for inválida (essas posições
+ *      recebem 0)
+ * \param packed Vetor de datas codificadas
+ * \param count Quantidade de datas
+ * \param seconds Vetor onde serão guardadas as datas em segundos desde 1970
+ */
+bool unpackCivilBatch(const PackedCivil* packed, size_t count, time_t* seconds){
+    bool ok = true;
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        long long value;
+
+        if(decodeCivil(packed[i], &value))
+            seconds[i] = (time_t) value;
+        else{
+            seconds[i] = 0;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+/**
+ * Grava um vetor de datas codificadas em um arquivo colunar<BR>
+ * O arquivo tem um cabeçalho de 64 bytes seguido dos valores na ordem de
+ * bytes da máquina, que é conferida na leitura
+ * \return false se houver erro de escrita (veja errno)
+ * \param path Caminho do arquivo (é criado ou substituído)
+ * \param encoding Codificação dos valores
+ * \param values Vetor de valores (time_t, PackedDay, PackedDateTime ou
+ *      PackedCivil, conforme encoding)
+ * \param count Quantidade de valores
+ */
+bool writeDateColumn(const char* path, enum PackedEncoding encoding, const void* values,
+        size_t count){
+    struct columnHeader header;
+    size_t valueSize = encodingSize(encoding);
+    FILE* file;
+    bool ok;
+
+    if(path == NULL || valueSize == 0 || (values == NULL && count > 0)
+            || (encoding == PACKED_SECONDS && sizeof(time_t) != sizeof(int64_t))){
+        errno = EINVAL;
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COLUMN_MAGIC, sizeof(COLUMN_MAGIC));
+    header.version = COLUMN_VERSION;
+    header.byteOrder = COLUMN_BYTE_ORDER;
+    header.encoding = (uint32_t) encoding;
+    header.valueSize = (uint32_t) valueSize;
+    header.count = count;
+
+    file = fopen(path, "wb");
+    if(file == NULL)
+        return false;
+
+    ok = fwrite(&header, sizeof(header), 1, file) == 1
+            && (count == 0 || fwrite(values, valueSize, count, file) == count);
+
+    // fclose() também informa erros da escrita que ficou no buffer
+    if(fclose(file) != 0)
+        ok = false;
+
+    return ok;
+}
+
+/**
+ * Abre um arquivo colunar mapeando-o em memória (somente leitura)
+ * \return Ponteiro para objeto DateColumn, ou NULL se o arquivo não existir
+ *      ou não for um arquivo colunar válido
+ * \param path Caminho do arquivo
+ */
+DateColumn* openDateColumn(const char* path){
+    const struct columnHeader* header;
+    DateColumn* column;
+    struct stat status;
+    void* map;
+    int file;
+
+    if(path == NULL)
+        return NULL;
+
+    file = open(path, O_RDONLY);
+    if(file < 0)
+        return NULL;
+    if(fstat(file, &status) != 0 || (size_t) status.st_size < sizeof(struct columnHeader)){
+        close(file);
+        return NULL;
+    }
+
+    map = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if(map == MAP_FAILED)
+        return NULL;
+
+    // o cabeçalho deve ser deste formato e o tamanho deve bater com ele
+    header = map;
+    if(memcmp(header->magic, COLUMN_MAGIC, sizeof(COLUMN_MAGIC)) != 0
+            || header->version != COLUMN_VERSION || header->byteOrder != COLUMN_BYTE_ORDER
+            || header->valueSize == 0
+            || header->valueSize != encodingSize((enum PackedEncoding) header->encoding)
+            || header->count > ((size_t) status.st_size - sizeof(struct columnHeader))
+                    / header->valueSize
+            || sizeof(struct columnHeader) + header->count * header->valueSize
+                    != (size_t) status.st_size){
+        munmap(map, (size_t) status.st_size);
+        return NULL;
+    }
+
+    column = calloc(1, sizeof(DateColumn));
+    if(column == NULL){
+        munmap(map, (size_t) status.st_size);
+        return NULL;
+    }
+
+    column->map = map;
+    column->size = (size_t) status.st_size;
+    column->encoding = (enum PackedEncoding) header->encoding;
+    column->count = (size_t) header->count;
+    return column;
+}
+
+/**
+ * Fecha o arquivo colunar e desfaz o mapeamento
+ * \return NULL
+ * \param column Ponteiro para objeto DateColumn a ser fechado
+ */
+DateColumn* closeDateColumn(DateColumn* column){
+    if(column == NULL)
+        return NULL;
+
+    munmap(column->map, column->size);
+    free(column);
+    return NULL;
+}
+
+/**
+ * Retorna a codificação dos valores do arquivo colunar
+ * \return Codificação
+ * \param column Ponteiro para objeto DateColumn
+ */
+enum PackedEncoding getDateColumnEncoding(const DateColumn* column){
+    return column->encoding;
+}
+
+/**
+ * Retorna a quantidade de valores do arquivo colunar
+ * \return Quantidade de valores
+ * \param column Ponteiro para objeto DateColumn
+ */
+size_t getDateColumnCount(const DateColumn* column){
+    return column->count;
+}
+
+/**
+ * Retorna os valores do arquivo colunar, direto da memória mapeada<BR>
+ * O ponteiro é alinhado em 64 bytes e vale até closeDateColumn()
+ * \return Ponteiro para o vetor de valores (time_t, PackedDay,
+ *      PackedDateTime ou PackedCivil, conforme getDateColumnEncoding())
+ * \param column Ponteiro para objeto DateColumn
+ */
+const void* getDateColumnData(const DateColumn* column){
+    return (const char*) column->map + sizeof(struct columnHeader);
+}
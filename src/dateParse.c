@@ -0,0 +1,533 @@
+/**
+ * \file dateParse.c
+ * Implementação do arquivo dateParse.h
+ */
+
+#include "../h_files/dateParse.h"
+#include "../h_files/dateCivil.h"
+#include "../h_files/dateFormat.h"
+#include "../h_files/dateStats.h"
+#include <stdint.h>
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Posição de leitura em um texto
+ */
+struct scanner{
+    // texto sendo lido
+    const char* text;
+    // tamanho do texto
+    size_t length;
+    // próximo caractere a ser lido
+    size_t position;
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Verifica se um caractere é um dígito decimal
+ * \return true se for dígito
+ * \param character Caractere
+ */
+static bool isDigit(char character){
+    return character >= '0' && character <= '9';
+}
+
+/**
+ * Lê um caractere específico
+ * \return true se o próximo caractere for o esperado (e o consome)
+ * \param scanner Posição de leitura
+ * \param expected Caractere esperado
+ */
+static bool scanLiteral(struct scanner* scanner, char expected){
+    if(scanner->position >= scanner->length || scanner->text[scanner->position] != expected)
+        return false;
+
+    scanner->position++;
+    return true;
+}
+
+/**
+ * Lê um número decimal de tamanho variável
+ * \return true se leu pelo menos um dígito
+ * \param scanner Posição de leitura
+ * \param maxDigits Quantidade máxima de dígitos
+ * \param allowSign Se o número pode começar com '-'
+ * \param value Ponteiro onde será guardado o número
+ */
+static bool scanNumber(struct scanner* scanner, size_t maxDigits, bool allowSign, int* value){
+    bool negative = allowSign && scanLiteral(scanner, '-');
+    size_t start = scanner->position;
+    int number = 0;
+
+    while(scanner->position < scanner->length && scanner->position - start < maxDigits
+            && isDigit(scanner->text[scanner->position])){
+        number = number * 10 + (scanner->text[scanner->position] - '0');
+        scanner->position++;
+    }
+
+    // um dígito a mais do que o permitido invalida o número
+    if(scanner->position == start || (scanner->position < scanner->length
+            && isDigit(scanner->text[scanner->position])))
+        return false;
+
+    *value = negative ? -number : number;
+    return true;
+}
+
+/**
+ * Lê um número decimal com quantidade exata de dígitos
+ * \return true se leu todos os dígitos
+ * \param scanner Posição de leitura
+ * \param digits Quantidade de dígitos
+ * \param value Ponteiro onde será guardado o número
+ */
+static bool scanFixedNumber(struct scanner* scanner, size_t digits, int* value){
+    int number = 0;
+    size_t i;
+
+    if(scanner->length - scanner->position < digits)
+        return false;
+
+    for(i = 0; i < digits; i++){
+        char character = scanner->text[scanner->position + i];
+        if(!isDigit(character))
+            return false;
+        number = number * 10 + (character - '0');
+    }
+
+    scanner->position += digits;
+    *value = number;
+    return true;
+}
+
+/**
+ * Lê o sufixo " AM" ou " PM" e converte a hora para o formato 24 horas
+ * \return true se o sufixo e a hora (1 - 12) forem válidos
+ * \param scanner Posição de leitura
+ * \param hour Ponteiro para a hora lida, convertida no lugar
+ */
+static bool scanAmPm(struct scanner* scanner, int* hour){
+    char marker;
+
+    if(!scanLiteral(scanner, ' ') || scanner->length - scanner->position < 2)
+        return false;
+
+    marker = scanner->text[scanner->position] & ~0x20;
+    if((marker != 'A' && marker != 'P') || (scanner->text[scanner->position + 1] & ~0x20) != 'M')
+        return false;
+    scanner->position += 2;
+
+    if(*hour < 1 || *hour > 12)
+        return false;
+
+    // 12 AM é meia-noite e 12 PM é meio-dia
+    *hour = (*hour % 12) + (marker == 'P' ? 12 : 0);
+    return true;
+}
+
+/**
+ * Lê o nome de um dia da semana
+ * \return true se encontrou um nome válido
+ * \param scanner Posição de leitura
+ * \param weekDay Ponteiro onde será guardado o dia da semana
+ */
+static bool scanWeekDay(struct scanner* scanner, int* weekDay){
+    char name[WEEK_DAY_STRING_SIZE];
+    int day;
+
+    for(day = SUNDAY; day <= SATURDAY; day++){
+        size_t length = formatWeekDay(day, name, sizeof(name));
+        if(scanner->length - scanner->position == length
+                && memcmp(scanner->text + scanner->position, name, length) == 0){
+            scanner->position += length;
+            *weekDay = day;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Converte 8 dígitos de uma vez (SWAR: vários dígitos em um registrador)
+ * \return false se algum caractere não for dígito
+ * \param characters Os 8 caracteres
+ * \param value Ponteiro onde será guardado o número
+ */
+static bool parseEightDigits(const char* characters, unsigned int* value){
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word;
+    uint64_t digits;
+
+    memcpy(&word, characters, 8);
+    digits = word - 0x3030303030303030ULL;
+
+    // cada byte deve estar entre '0' e '9'
+    if(((word + 0x4646464646464646ULL) | digits) & 0x8080808080808080ULL)
+        return false;
+
+    // junta pares, depois quádruplas, depois os 8 dígitos
+    digits = (digits * 10 + (digits >> 8)) & 0x00FF00FF00FF00FFULL;
+    digits = (digits * 100 + (digits >> 16)) & 0x0000FFFF0000FFFFULL;
+    digits = (digits * 10000 + (digits >> 32)) & 0xFFFFFFFFULL;
+
+    *value = (unsigned int) digits;
+    return true;
+#else
+    unsigned int number = 0;
+    int i;
+
+    for(i = 0; i < 8; i++){
+        if(!isDigit(characters[i]))
+            return false;
+        number = number * 10 + (unsigned int) (characters[i] - '0');
+    }
+
+    *value = number;
+    return true;
+#endif
+}
+
+/**
+ * Lê o formato fixo "yyyy-mm-ddThh:mm:ss" pelo caminho rápido
+ * \return false se o texto não estiver exatamente nesse formato
+ * \param text Texto (pelo menos 19 caracteres)
+ * \param civil Ponteiro onde serão guardados os componentes
+ */
+static bool parseFixedIso(const char* text, CivilTime* civil){
+    char calendar[8];
+    char clock[8];
+    unsigned int date, time;
+
+    if(text[4] != '-' || text[7] != '-' || text[13] != ':' || text[16] != ':'
+            || (text[10] != 'T' && text[10] != 't' && text[10] != ' '))
+        return false;
+
+    // junta os dígitos em dois blocos de 8: yyyymmdd e 00hhmmss
+    memcpy(calendar, text, 4);
+    memcpy(calendar + 4, text + 5, 2);
+    memcpy(calendar + 6, text + 8, 2);
+    clock[0] = '0';
+    clock[1] = '0';
+    memcpy(clock + 2, text + 11, 2);
+    memcpy(clock + 4, text + 14, 2);
+    memcpy(clock + 6, text + 17, 2);
+
+    if(!parseEightDigits(calendar, &date) || !parseEightDigits(clock, &time))
+        return false;
+
+    civil->year = (int) (date / 10000);
+    civil->month = (int) (date / 100 % 100);
+    civil->mday = (int) (date % 100);
+    civil->hour = (int) (time / 10000);
+    civil->minute = (int) (time / 100 % 100);
+    civil->second = (int) (time % 100);
+    return true;
+}
+
+/**
+ * Lê o deslocamento opcional no fim de uma data ISO-8601
+ * \return false se houver um deslocamento mal formado
+ * \param scanner Posição de leitura
+ * \param hasOffset Ponteiro onde será guardado se havia deslocamento
+ * \param offset Ponteiro onde será guardado o deslocamento em segundos
+ */
+static bool scanIsoOffset(struct scanner* scanner, bool* hasOffset, long* offset){
+    int hours, minutes = 0;
+    long sign;
+
+    *hasOffset = false;
+    *offset = 0;
+
+    if(scanLiteral(scanner, 'Z') || scanLiteral(scanner, 'z')){
+        *hasOffset = true;
+        return true;
+    }
+
+    if(scanLiteral(scanner, '+'))
+        sign = 1;
+    else if(scanLiteral(scanner, '-'))
+        sign = -1;
+    else
+        return true;
+
+    if(!scanFixedNumber(scanner, 2, &hours))
+        return false;
+    if(scanLiteral(scanner, ':')){
+        if(!scanFixedNumber(scanner, 2, &minutes))
+            return false;
+    }
+    else if(scanner->position < scanner->length && !scanFixedNumber(scanner, 2, &minutes))
+        return false;
+
+    if(hours > 23 || minutes > 59)
+        return false;
+
+    *hasOffset = true;
+    *offset = sign * (hours * 3600L + minutes * 60L);
+    return true;
+}
+
+/**
+ * Lê uma data em um dos formatos de enum DateString (veja parseDateString())
+ * \return true se o texto estiver no formato e a data for válida
+ * \param text Texto a ser lido
+ * \param length Tamanho do texto
+ * \param dateString Enumerador que indica o formato do texto
+ * \param zone Fuso do texto (NULL para o fuso local)
+ * \param seconds Ponteiro onde será guardada a data em segundos desde 1970
+ */
+static bool scanDateString(const char* text, size_t length, enum DateString dateString,
+        const TimeZone* zone, time_t* seconds){
+    struct scanner scanner = {text, length, 0};
+    int day = 1, month = 1, year = 1970;
+    int hour = 0, minute = 0, second = 0;
+    int weekDay = -1;
+    bool hasDate, hasTime, yearFirst, ampm;
+
+    if(text == NULL || seconds == NULL || dateString < DATE_DMY || dateString > DATE_YMD_HMS_AMPM)
+        return false;
+
+    hasDate = dateString != DATE_HMS && dateString != DATE_HMS_AMPM;
+    hasTime = dateString != DATE_DMY && dateString != DATE_YMD;
+    yearFirst = dateString == DATE_YMD || dateString == DATE_YMD_HMS
+            || dateString == DATE_YMD_HMS_AMPM;
+    ampm = dateString == DATE_HMS_AMPM || dateString == DATE_DMY_HMS_AMPM
+            || dateString == DATE_YMD_HMS_AMPM;
+
+    if(hasDate){
+        if(yearFirst){
+            if(!scanNumber(&scanner, 9, true, &year) || !scanLiteral(&scanner, '/')
+                    || !scanNumber(&scanner, 2, false, &month) || !scanLiteral(&scanner, '/')
+                    || !scanNumber(&scanner, 2, false, &day))
+                return false;
+        }
+        else{
+            if(!scanNumber(&scanner, 2, false, &day) || !scanLiteral(&scanner, '/')
+                    || !scanNumber(&scanner, 2, false, &month) || !scanLiteral(&scanner, '/')
+                    || !scanNumber(&scanner, 9, true, &year))
+                return false;
+        }
+    }
+
+    if(hasDate && hasTime && !scanLiteral(&scanner, ' '))
+        return false;
+
+    if(hasTime){
+        if(!scanNumber(&scanner, 2, false, &hour) || !scanLiteral(&scanner, ':')
+                || !scanNumber(&scanner, 2, false, &minute) || !scanLiteral(&scanner, ':')
+                || !scanNumber(&scanner, 2, false, &second))
+            return false;
+        if(ampm && !scanAmPm(&scanner, &hour))
+            return false;
+    }
+
+    // nome do dia da semana opcional no final
+    if(scanner.position < length
+            && (!scanLiteral(&scanner, ' ') || !scanWeekDay(&scanner, &weekDay)))
+        return false;
+
+    if(!validateDate(day, month, year, hour, minute, second))
+        return false;
+
+    if(!hasDate){
+        *seconds = (time_t) (hour * 3600 + minute * 60 + second);
+        return true;
+    }
+
+    if(weekDay >= 0 && weekDayFromDays(daysFromCivil(year, month, day)) != weekDay)
+        return false;
+
+    *seconds = zoneLocalSecondsToTime(zone,
+            secondsFromCivil(day, month, year, hour, minute, second));
+    return true;
+}
+
+/**
+ * Lê uma data no formato ISO-8601/RFC-3339 (veja parseIsoDate())
+ * \return true se o texto estiver no formato e a data for válida
+ * \param text Texto a ser lido
+ * \param length Tamanho do texto
+ * \param zone Fuso usado quando o texto não traz deslocamento
+ * \param seconds Ponteiro onde será guardada a data em segundos desde 1970
+ */
+static bool scanIsoDate(const char* text, size_t length, const TimeZone* zone,
+        time_t* seconds){
+    struct scanner scanner = {text, length, 0};
+    CivilTime civil = {0};
+    bool hasSeconds = false;
+    bool hasOffset;
+    long offset;
+    long long local;
+
+    if(text == NULL || seconds == NULL)
+        return false;
+
+    if(length >= 19 && parseFixedIso(text, &civil)){
+        // caminho rápido
+        scanner.position = 19;
+        hasSeconds = true;
+    }
+    else{
+        if(!scanFixedNumber(&scanner, 4, &civil.year) || !scanLiteral(&scanner, '-')
+                || !scanFixedNumber(&scanner, 2, &civil.month) || !scanLiteral(&scanner, '-')
+                || !scanFixedNumber(&scanner, 2, &civil.mday))
+            return false;
+
+        // separador entre data e horário
+        if(scanLiteral(&scanner, 'T') || scanLiteral(&scanner, 't') || scanLiteral(&scanner, ' ')){
+            if(!scanFixedNumber(&scanner, 2, &civil.hour) || !scanLiteral(&scanner, ':')
+                    || !scanFixedNumber(&scanner, 2, &civil.minute))
+                return false;
+            if(scanLiteral(&scanner, ':')){
+                if(!scanFixedNumber(&scanner, 2, &civil.second))
+                    return false;
+                hasSeconds = true;
+            }
+        }
+    }
+
+    // fração de segundo (descartada)
+    if(hasSeconds && (scanLiteral(&scanner, '.') || scanLiteral(&scanner, ','))){
+        size_t start = scanner.position;
+        while(scanner.position < length && isDigit(text[scanner.position]))
+            scanner.position++;
+        if(scanner.position == start)
+            return false;
+    }
+
+    if(!scanIsoOffset(&scanner, &hasOffset, &offset) || scanner.position != length)
+        return false;
+
+    if(!validateDate(civil.mday, civil.month, civil.year,
+            civil.hour, civil.minute, civil.second))
+        return false;
+
+    local = secondsFromCivil(civil.mday, civil.month, civil.year,
+            civil.hour, civil.minute, civil.second);
+    *seconds = hasOffset ? (time_t) (local - offset) : zoneLocalSecondsToTime(zone, local);
+    return true;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Lê uma data em um dos formatos de enum DateString<BR>
+ * Os campos podem ter ou não zeros à esquerda, e o nome do dia da semana no
+ * final é aceito (e conferido) se estiver presente. Nos formatos só com
+ * horário (DATE_HMS e DATE_HMS_AMPM) o resultado é a quantidade de segundos
+ * desde a meia-noite, sem fuso
+ * \return true se o texto estiver no formato e a data for válida
+ * \param text Texto a ser lido
+ * \param length Tamanho do texto (o texto não precisa terminar com '\0')
+ * \param dateString Enumerador que indica o formato do texto (veja date.h)
+ * \param zone Fuso do texto (NULL para o fuso local)
+ * \param seconds Ponteiro onde será guardada a data em segundos desde 1970
+ */
+bool parseDateString(const char* text, size_t length, enum DateString dateString,
+        const TimeZone* zone, time_t* seconds){
+    DATE_STAT_SCOPE(DATE_STAT_PARSE);
+
+    if(scanDateString(text, length, dateString, zone, seconds))
+        return true;
+
+    DATE_STAT_EVENT(DATE_STAT_PARSE_FAILURE);
+    return false;
+}
+
+/**
+ * Lê uma data no formato ISO-8601/RFC-3339<BR>
+ * Aceita "yyyy-mm-dd" e "yyyy-mm-ddThh:mm[:ss[.fração]]", com 'T', 't' ou
+ * espaço entre data e horário, seguido opcionalmente de 'Z' ou de um
+ * deslocamento (+hh:mm, +hhmm ou +hh). Sem deslocamento, o horário é
+ * interpretado no fuso informado. A fração de segundo é descartada. O
+ * formato fixo "yyyy-mm-ddThh:mm:ss" é lido por um caminho rápido que
+ * converte vários dígitos de uma vez
+ * \return true se o texto estiver no formato e a data for válida
+ * \param text Texto a ser lido
+ * \param length Tamanho do texto (o texto não precisa terminar com '\0')
+ * \param zone Fuso usado quando o texto não traz deslocamento (NULL para o
+ *      fuso local)
+ * \param seconds Ponteiro onde será guardada a data em segundos desde 1970
+ */
+bool parseIsoDate(const char* text, size_t length, const TimeZone* zone,
+        time_t* seconds){
+    DATE_STAT_SCOPE(DATE_STAT_PARSE);
+
+    if(scanIsoDate(text, length, zone, seconds))
+        return true;
+
+    DATE_STAT_EVENT(DATE_STAT_PARSE_FAILURE);
+    return false;
+}
+
+/**
+ * Lê um vetor de datas em um dos formatos de enum DateString
+ * \return Quantidade de datas lidas com sucesso
+ * \param texts Vetor de textos
+ * \param lengths Vetor com o tamanho de cada texto (NULL se os textos
+ *      terminarem com '\0')
+ * \param count Quantidade de textos
+ * \param dateString Enumerador que indica o formato dos textos (veja date.h)
+ * \param zone Fuso dos textos (NULL para o fuso local)
+ * \param seconds Vetor onde serão guardadas as datas (0 para as inválidas)
+ * \param valid Vetor onde será guardado se cada texto foi lido (pode ser NULL)
+ */
+size_t parseDateStringBatch(const char* const* texts, const size_t* lengths,
+        size_t count, enum DateString dateString, const TimeZone* zone,
+        time_t* seconds, bool* valid){
+    size_t parsed = 0;
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        size_t length = (lengths != NULL) ? lengths[i] : strlen(texts[i]);
+        bool ok = parseDateString(texts[i], length, dateString, zone, seconds + i);
+
+        if(!ok)
+            seconds[i] = 0;
+        if(valid != NULL)
+            valid[i] = ok;
+        parsed += ok;
+    }
+
+    return parsed;
+}
+
+/**
+ * Lê um vetor de datas no formato ISO-8601/RFC-3339
+ * \return Quantidade de datas lidas com sucesso
+ * \param texts Vetor de textos
+ * \param lengths Vetor com o tamanho de cada texto (NULL se os textos
+ *      terminarem com '\0')
+ * \param count Quantidade de textos
+ * \param zone Fuso usado quando o texto não traz deslocamento (NULL para o
+ *      fuso local)
+ * \param seconds Vetor onde serão guardadas as datas (0 para as inválidas)
+ * \param valid Vetor onde será guardado se cada texto foi lido (pode ser NULL)
+ */
+size_t parseIsoDateBatch(const char* const* texts, const size_t* lengths,
+        size_t count, const TimeZone* zone, time_t* seconds, bool* valid){
+    size_t parsed = 0;
+    size_t i;
+
+    for(i = 0; i < count; i++){
+        size_t length = (lengths != NULL) ? lengths[i] : strlen(texts[i]);
+        bool ok = parseIsoDate(texts[i], length, zone, seconds + i);
+
+        if(!ok)
+            seconds[i] = 0;
+        if(valid != NULL)
+            valid[i] = ok;
+        parsed += ok;
+    }
+
+    return parsed;
+}
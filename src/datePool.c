@@ -0,0 +1,156 @@
+/**
+ * \file datePool.c
+ * Implementação do arquivo datePool.h
+ */
+
+#include "../h_files/datePool.h"
+#include <stddef.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Quantidade padrão de objetos Date reservados de cada vez
+ */
+#define DEFAULT_DATES_PER_BLOCK 1024
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Objeto Date de um pool, junto com o pool de onde veio<BR>
+ * O ponteiro para o pool fica fora de struct date para que os objetos na
+ * pilha ou em vetores não paguem por ele
+ */
+struct poolSlot{
+    // pool de onde o objeto veio
+    struct datePool* pool;
+    // objeto entregue a quem chama
+    Date date;
+};
+
+/**
+ * Bloco de objetos Date contíguos
+ */
+struct poolBlock{
+    // próximo bloco do pool
+    struct poolBlock* next;
+    // objetos do bloco
+    struct poolSlot slots[];
+};
+
+/**
+ * Estrutura do objeto pool de datas
+ */
+struct datePool{
+    // blocos reservados (o primeiro é o mais recente)
+    struct poolBlock* blocks;
+    // objetos já usados no bloco mais recente
+    size_t used;
+    // objetos por bloco
+    size_t datesPerBlock;
+    // objetos devolvidos por destroyDate()
+    Date* freeList;
+};
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Cria um pool de datas
+ * \return Ponteiro para objeto DatePool, ou NULL se não conseguir
+ * \param datesPerBlock Quantidade de objetos Date reservados de cada vez
+ *      (0 para o padrão)
+ */
+DatePool* createDatePool(size_t datesPerBlock){
+    DatePool* pool;
+
+    // o tamanho de um bloco precisa caber em size_t
+    if(datesPerBlock > (SIZE_MAX - sizeof(struct poolBlock)) / sizeof(struct poolSlot))
+        return NULL;
+
+    pool = malloc(sizeof(DatePool));
+    if(pool == NULL)
+        return NULL;
+
+    pool->blocks = NULL;
+    pool->datesPerBlock = (datesPerBlock > 0) ? datesPerBlock : DEFAULT_DATES_PER_BLOCK;
+    // força a reserva de um bloco no primeiro pedido
+    pool->used = pool->datesPerBlock;
+    pool->freeList = NULL;
+
+    return pool;
+}
+
+/**
+ * Desaloca o pool e todos os objetos Date criados por ele
+ * \return NULL
+ * \param pool Ponteiro para objeto DatePool a ser desalocado
+ */
+DatePool* destroyDatePool(DatePool* pool){
+    if(pool == NULL)
+        return NULL;
+
+    while(pool->blocks != NULL){
+        struct poolBlock* next = pool->blocks->next;
+        free(pool->blocks);
+        pool->blocks = next;
+    }
+    free(pool);
+
+    return NULL;
+}
+
+/**
+ * Cria um objeto Date a partir do pool<BR>
+ * Não lê o relógio: a data inicial é 1/1/1970 00:00:00 UTC, no fuso local.
+ * O objeto pode ser devolvido ao pool com destroyDate()
+ * \return Ponteiro para objeto Date, ou NULL se não conseguir
+ * \param pool Ponteiro para objeto DatePool
+ */
+Date* createPoolDate(DatePool* pool){
+    struct poolSlot* slot;
+    Date* date;
+
+    // reaproveita primeiro os objetos devolvidos
+    if(pool->freeList != NULL){
+        date = pool->freeList;
+        pool->freeList = date->nextFree;
+    }
+    else{
+        if(pool->used == pool->datesPerBlock){
+            struct poolBlock* block = malloc(sizeof(struct poolBlock)
+                    + pool->datesPerBlock * sizeof(struct poolSlot));
+            if(block == NULL)
+                return NULL;
+            block->next = pool->blocks;
+            pool->blocks = block;
+            pool->used = 0;
+        }
+        slot = &pool->blocks->slots[pool->used++];
+        slot->pool = pool;
+        date = &slot->date;
+    }
+
+    initDate(date);
+    date->storage = DATE_STORAGE_POOL;
+
+    return date;
+}
+
+/**
+ * Devolve ao pool um objeto Date criado por ele (usada por destroyDate())
+ * \param date Ponteiro para objeto Date
+ */
+void releasePoolDate(Date* date){
+    struct poolSlot* slot = (struct poolSlot*) ((char*) date - offsetof(struct poolSlot, date));
+    DatePool* pool = slot->pool;
+
+    // o objeto livre não tem componentes memorizados: nextFree ocupa o lugar deles
+    date->decomposed = false;
+    date->nextFree = pool->freeList;
+    pool->freeList = date;
+}
@@ -0,0 +1,415 @@
+/**
+ * \file dateRecurrence.c
+ * Implementação do arquivo dateRecurrence.h
+ */
+
+#include "../h_files/dateRecurrence.h"
+#include "../h_files/dateCivil.h"
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Máscara com todos os dias da semana
+ */
+#define ALL_WEEK_DAYS 0x7Fu
+
+/**
+ * Quantidade máxima de períodos (dias ou meses) testados na busca de uma
+ * ocorrência antes de concluir que a regra não tem mais ocorrências. Cobre o
+ * ciclo de 400 anos do calendário para as regras mensais
+ */
+#define MAX_SEARCH_STEPS 5000
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Divisão inteira com arredondamento para baixo (também para negativos)
+ * \return Quociente arredondado para menos infinito
+ * \param value Dividendo
+ * \param divisor Divisor (positivo)
+ */
+static long long floorDiv(long long value, long long divisor){
+    long long quotient = value / divisor;
+    if((value % divisor) < 0)
+        quotient--;
+    return quotient;
+}
+
+/**
+ * Verifica se um dia está entre os dias da semana permitidos pela regra
+ * \return true se o dia for permitido (ou se a regra não restringir)
+ * \param rule Regra de recorrência
+ * \param day Dia desde 1/1/1970
+ */
+static bool allowedWeekDay(const RecurrenceRule* rule, long long day){
+    return rule->weekDays == 0 || (rule->weekDays >> weekDayFromDays(day)) & 1u;
+}
+
+/**
+ * Retorna o horário das ocorrências das regras de dia para cima
+ * \return Segundos desde a meia-noite da data inicial
+ * \param recurrence Estado da recorrência
+ */
+static long long timeOfDay(const DateRecurrence* recurrence){
+    return recurrence->firstLocal
+            - floorDiv(recurrence->firstLocal, SECONDS_PER_DAY) * SECONDS_PER_DAY;
+}
+
+/**
+ * Retorna o primeiro dia de um mês que satisfaz a regra
+ * \return Dia do mês, ou 0 se não houver
+ * \param rule Regra de recorrência
+ * \param year Ano
+ * \param month Mês (1 - 12)
+ * \param from Menor dia do mês aceito
+ */
+static int findMonthDay(const RecurrenceRule* rule, int year, int month, int from){
+    int last = daysInMonth(year, month);
+    int firstWeekDay = weekDayFromDays(daysFromCivil(year, month, 1));
+    unsigned int mask = (rule->weekDays != 0) ? rule->weekDays : ALL_WEEK_DAYS;
+    int day;
+
+    if(rule->position != 0){
+        int matches[31];
+        int count = 0;
+        int index;
+
+        for(day = 1; day <= last; day++){
+            if((mask >> ((firstWeekDay + day - 1) % 7)) & 1u)
+                matches[count++] = day;
+        }
+
+        index = (rule->position > 0) ? rule->position - 1 : count + rule->position;
+        if(index < 0 || index >= count || matches[index] < from)
+            return 0;
+        return matches[index];
+    }
+
+    if(rule->monthDay != 0){
+        day = (rule->monthDay > 0) ? rule->monthDay : last + rule->monthDay + 1;
+        if(day < from || day < 1 || day > last
+                || !((mask >> ((firstWeekDay + day - 1) % 7)) & 1u))
+            return 0;
+        return day;
+    }
+
+    for(day = from; day <= last; day++){
+        if((mask >> ((firstWeekDay + day - 1) % 7)) & 1u)
+            return day;
+    }
+
+    return 0;
+}
+
+/**
+ * Procura a primeira ocorrência de uma regra de minutos ou horas
+ * \return false se a regra não tiver mais ocorrências
+ * \param recurrence Estado da recorrência
+ * \param local Ponteiro onde será guardada a ocorrência, no relógio do fuso
+ */
+static bool findClockOccurrence(const DateRecurrence* recurrence, long long* local){
+    const RecurrenceRule* rule = &recurrence->rule;
+    long long step = (long long) rule->interval * (rule->frequency == RECUR_MINUTELY ? 60 : 3600);
+    bool windowed = rule->windowUntil != 0;
+    long long target = recurrence->candidate;
+    int search;
+
+    for(search = 0; search < MAX_SEARCH_STEPS; search++){
+        // as ocorrências ficam em firstLocal + k * step
+        long long moment = recurrence->firstLocal
+                + (target - recurrence->firstLocal + step - 1) / step * step;
+        long long day = floorDiv(moment, SECONDS_PER_DAY);
+        long long second = moment - day * SECONDS_PER_DAY;
+
+        if(!allowedWeekDay(rule, day) || (windowed && second >= rule->windowUntil))
+            target = (day + 1) * SECONDS_PER_DAY + (windowed ? rule->windowFrom : 0);
+        else if(windowed && second < rule->windowFrom)
+            target = day * SECONDS_PER_DAY + rule->windowFrom;
+        else{
+            *local = moment;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Procura a primeira ocorrência de uma regra diária
+ * \return false se a regra não tiver mais ocorrências
+ * \param recurrence Estado da recorrência
+ * \param local Ponteiro onde será guardada a ocorrência, no relógio do fuso
+ */
+static bool findDailyOccurrence(const DateRecurrence* recurrence, long long* local){
+    long long day = floorDiv(recurrence->candidate, SECONDS_PER_DAY);
+    int search;
+
+    // o dia da semana se repete em no máximo 7 períodos
+    for(search = 0; search < 7; search++){
+        if(allowedWeekDay(&recurrence->rule, day)){
+            *local = day * SECONDS_PER_DAY + timeOfDay(recurrence);
+            return true;
+        }
+        day += recurrence->rule.interval;
+    }
+
+    return false;
+}
+
+/**
+ * Procura a primeira ocorrência de uma regra semanal
+ * \return false se a regra não tiver mais ocorrências
+ * \param recurrence Estado da recorrência
+ * \param local Ponteiro onde será guardada a ocorrência, no relógio do fuso
+ */
+static bool findWeeklyOccurrence(const DateRecurrence* recurrence, long long* local){
+    long long span = 7LL * recurrence->rule.interval;
+    long long day = floorDiv(recurrence->candidate, SECONDS_PER_DAY);
+    int search;
+
+    for(search = 0; search < 2; search++){
+        // segunda-feira da semana do período que contém o dia
+        long long week = recurrence->period + (day - recurrence->period) / span * span;
+        long long offset;
+
+        for(offset = day - week; offset < 7; offset++){
+            if((recurrence->rule.weekDays >> ((MONDAY + offset) % 7)) & 1u){
+                *local = (week + offset) * SECONDS_PER_DAY + timeOfDay(recurrence);
+                return true;
+            }
+        }
+        day = week + span;
+    }
+
+    return false;
+}
+
+/**
+ * Procura a primeira ocorrência de uma regra mensal ou anual
+ * \return false se a regra não tiver mais ocorrências
+ * \param recurrence Estado da recorrência
+ * \param local Ponteiro onde será guardada a ocorrência, no relógio do fuso
+ */
+static bool findMonthlyOccurrence(const DateRecurrence* recurrence, long long* local){
+    const RecurrenceRule* rule = &recurrence->rule;
+    long long step = (long long) rule->interval * (rule->frequency == RECUR_YEARLY ? 12 : 1);
+    long long monthIndex;
+    int year, month, day;
+    int search;
+
+    civilFromDays(floorDiv(recurrence->candidate, SECONDS_PER_DAY), &year, &month, &day);
+    monthIndex = (long long) year * 12 + (month - 1);
+
+    for(search = 0; search < MAX_SEARCH_STEPS; search++){
+        long long skipped = (monthIndex - recurrence->period) % step;
+        int found;
+
+        // meses fora da regra começam a busca no primeiro período seguinte
+        if(monthIndex < recurrence->period){
+            monthIndex = recurrence->period;
+            day = 1;
+        }
+        else if(skipped != 0){
+            monthIndex += step - skipped;
+            day = 1;
+        }
+
+        year = (int) floorDiv(monthIndex, 12);
+        month = (int) (monthIndex - (long long) year * 12) + 1;
+        found = findMonthDay(rule, year, month, day);
+        if(found != 0){
+            *local = daysFromCivil(year, month, found) * SECONDS_PER_DAY + timeOfDay(recurrence);
+            return true;
+        }
+
+        monthIndex += step;
+        day = 1;
+    }
+
+    return false;
+}
+
+/**
+ * Converte uma ocorrência do relógio do fuso para UTC<BR>
+ * O deslocamento da última conversão é reaproveitado enquanto o instante
+ * estiver a mais de um dia das mudanças de deslocamento (onde o horário
+ * local é único)
+ * \return Segundos desde 1970
+ * \param recurrence Estado da recorrência
+ * \param local Ocorrência no relógio do fuso
+ */
+static time_t localToTime(DateRecurrence* recurrence, long long local){
+    time_t seconds = (time_t) (local - recurrence->offset);
+
+    if(seconds - SECONDS_PER_DAY >= recurrence->windowFrom
+            && seconds + SECONDS_PER_DAY <= recurrence->windowUntil)
+        return seconds;
+
+    seconds = zoneLocalSecondsToTime(recurrence->zone, local);
+    recurrence->offset = getZoneUtcOffsetWindow(recurrence->zone, seconds,
+            &recurrence->windowFrom, &recurrence->windowUntil);
+    return seconds;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Inicia uma recorrência<BR>
+ * A primeira ocorrência é a primeira data maior ou igual a start que
+ * satisfaz a regra
+ * \return false se a regra for inválida
+ * \param recurrence Estado a ser preenchido
+ * \param rule Regra de recorrência (é copiada)
+ * \param start Data inicial em segundos desde 1970
+ * \param zone Fuso da regra (NULL para o fuso local). O fuso deve continuar
+ *      carregado enquanto a recorrência for usada
+ */
+bool startDateRecurrence(DateRecurrence* recurrence, const RecurrenceRule* rule,
+        time_t start, const TimeZone* zone){
+    long long firstDay;
+    int year, month, day;
+
+    if(recurrence == NULL || rule == NULL || rule->frequency < RECUR_MINUTELY
+            || rule->frequency > RECUR_YEARLY || (rule->weekDays & ~ALL_WEEK_DAYS) != 0
+            || rule->monthDay < -31 || rule->monthDay > 31 || rule->position < -31
+            || rule->position > 31 || rule->month < 0 || rule->month > 12
+            || rule->windowFrom < 0 || rule->windowUntil < 0
+            || rule->windowUntil > SECONDS_PER_DAY
+            || (rule->windowUntil != 0 && rule->windowFrom >= rule->windowUntil)
+            || rule->count < 0)
+        return false;
+
+    memset(recurrence, 0, sizeof(DateRecurrence));
+    recurrence->rule = *rule;
+    recurrence->zone = zone;
+    // nenhum deslocamento memorizado ainda
+    recurrence->windowFrom = 1;
+    recurrence->windowUntil = 0;
+
+    recurrence->firstLocal = (long long) start + getZoneUtcOffset(zone, start);
+    recurrence->candidate = recurrence->firstLocal;
+    firstDay = floorDiv(recurrence->firstLocal, SECONDS_PER_DAY);
+    civilFromDays(firstDay, &year, &month, &day);
+
+    // preenche os valores padrão a partir da data inicial
+    if(recurrence->rule.interval == 0)
+        recurrence->rule.interval = 1;
+
+    switch(rule->frequency){
+    case RECUR_DAILY:
+        recurrence->period = firstDay;
+        break;
+    case RECUR_WEEKLY:
+        if(recurrence->rule.weekDays == 0)
+            recurrence->rule.weekDays = RECURRENCE_DAY(weekDayFromDays(firstDay));
+        recurrence->period = firstDay - (weekDayFromDays(firstDay) + 6) % 7;
+        break;
+    case RECUR_MONTHLY:
+    case RECUR_YEARLY:
+        if(rule->monthDay == 0 && rule->position == 0 && rule->weekDays == 0)
+            recurrence->rule.monthDay = day;
+        recurrence->period = (long long) year * 12 + (month - 1);
+        if(rule->frequency == RECUR_YEARLY){
+            if(recurrence->rule.month == 0)
+                recurrence->rule.month = month;
+            // o mês da regra pode já ter passado no ano inicial
+            recurrence->period = (long long) year * 12 + (recurrence->rule.month - 1);
+            if(recurrence->rule.month < month)
+                recurrence->period += 12;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+/**
+ * Gera a próxima ocorrência<BR>
+ * As ocorrências são sempre crescentes: horários locais que a mudança de
+ * horário de verão leva para um instante já gerado são pulados
+ * \return false se não houver mais ocorrências
+ * \param recurrence Estado iniciado por startDateRecurrence()
+ * \param seconds Ponteiro onde será guardada a ocorrência em segundos desde
+ *      1970
+ */
+bool nextDateRecurrence(DateRecurrence* recurrence, time_t* seconds){
+    const RecurrenceRule* rule;
+
+    if(recurrence == NULL || seconds == NULL)
+        return false;
+    rule = &recurrence->rule;
+
+    while(!recurrence->finished){
+        long long local, advance;
+        bool found;
+        time_t occurrence;
+
+        if(rule->count > 0 && recurrence->produced >= rule->count)
+            break;
+
+        switch(rule->frequency){
+        case RECUR_MINUTELY:
+        case RECUR_HOURLY:
+            found = findClockOccurrence(recurrence, &local);
+            advance = 1;
+            break;
+        case RECUR_DAILY:
+            found = findDailyOccurrence(recurrence, &local);
+            advance = (long long) rule->interval * SECONDS_PER_DAY;
+            break;
+        case RECUR_WEEKLY:
+            found = findWeeklyOccurrence(recurrence, &local);
+            advance = SECONDS_PER_DAY;
+            break;
+        default:
+            found = findMonthlyOccurrence(recurrence, &local);
+            advance = SECONDS_PER_DAY;
+        }
+        if(!found)
+            break;
+        // a próxima busca começa depois desta ocorrência
+        recurrence->candidate = local + advance;
+
+        occurrence = localToTime(recurrence, local);
+        if(recurrence->produced > 0 && occurrence <= recurrence->last)
+            continue;
+        if(rule->hasUntil && occurrence > rule->until)
+            break;
+
+        recurrence->produced++;
+        recurrence->last = occurrence;
+        *seconds = occurrence;
+        return true;
+    }
+
+    recurrence->finished = true;
+    return false;
+}
+
+/**
+ * Gera várias ocorrências de uma vez
+ * \return Quantidade de ocorrências geradas (menor que capacity só quando
+ *      não há mais ocorrências)
+ * \param recurrence Estado iniciado por startDateRecurrence()
+ * \param seconds Vetor onde serão guardadas as ocorrências
+ * \param capacity Tamanho do vetor
+ */
+size_t fillDateRecurrence(DateRecurrence* recurrence, time_t* seconds, size_t capacity){
+    size_t filled = 0;
+
+    if(seconds == NULL)
+        return 0;
+
+    while(filled < capacity && nextDateRecurrence(recurrence, seconds + filled))
+        filled++;
+
+    return filled;
+}
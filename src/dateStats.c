@@ -0,0 +1,390 @@
+/**
+ * \file dateStats.c
+ * Implementação do arquivo dateStats.h
+ */
+
+#include "../h_files/dateStats.h"
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Nomes dos pontos instrumentados, na ordem de enum DateStat
+ */
+static const char* const STAT_NAMES[DATE_STAT_COUNT] = {
+    "createDate",
+    "setDateToday",
+    "setDatePartial",
+    "setDateComplete",
+    "setDateOfSeconds",
+    "getDateComponent",
+    "getDateCivilTime",
+    "getStringDate",
+    "getStringWeekDay",
+    "addComponentDate",
+    "addDaysDate",
+    "addMonthsDate",
+    "diffDaysDate",
+    "diffMonthsDate",
+    "printDate",
+    "printWeekDate",
+    "validateDate",
+    "parse",
+    "decompose",
+    "decompose_cached",
+    "makeDate",
+    "makeDate_failure",
+    "validateDate_failure",
+    "getStringDate_failure",
+    "parse_failure"
+};
+
+#ifdef DATE_STATS
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Contadores de uma thread<BR>
+ * Somente a thread dona escreve nos contadores (leitura e escrita relaxadas,
+ * sem instruções de travamento); as outras threads apenas leem ou zeram
+ */
+struct statsSlot{
+    // chamadas de cada ponto
+    _Atomic unsigned long long calls[DATE_STAT_COUNT];
+    // tempo total de cada ponto
+    _Atomic unsigned long long nanoseconds[DATE_STAT_COUNT];
+    // histograma de cada ponto
+    _Atomic unsigned long long latency[DATE_STAT_COUNT][DATE_STATS_BUCKETS];
+    // se alguma thread está usando os contadores
+    _Atomic bool inUse;
+    // próximo da lista de todos os contadores
+    struct statsSlot* next;
+};
+
+/******************************************************************************
+ * Variáveis do módulo
+ ******************************************************************************/
+
+/**
+ * Lista de contadores de todas as threads (os de threads encerradas são
+ * reaproveitados, mantendo os valores)
+ */
+static struct statsSlot* slots = NULL;
+
+/**
+ * Protege a lista de contadores
+ */
+static pthread_mutex_t slotsLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Chave usada para liberar os contadores quando a thread termina
+ */
+static pthread_key_t slotKey;
+
+/**
+ * Garante que a chave seja criada uma única vez
+ */
+static pthread_once_t slotKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Contadores da thread atual
+ */
+static _Thread_local struct statsSlot* threadSlot = NULL;
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Libera os contadores de uma thread encerrada para outra thread
+ * \param slot Contadores da thread
+ */
+static void releaseSlot(void* slot){
+    atomic_store(&((struct statsSlot*) slot)->inUse, false);
+}
+
+/**
+ * Cria a chave de liberação dos contadores
+ */
+static void createSlotKey(void){
+    pthread_key_create(&slotKey, releaseSlot);
+}
+
+/**
+ * Retorna os contadores da thread atual, escolhendo-os no primeiro uso
+ * \return Contadores da thread, ou NULL se faltar memória
+ */
+static struct statsSlot* getThreadSlot(void){
+    struct statsSlot* slot;
+
+    if(threadSlot != NULL)
+        return threadSlot;
+
+    pthread_once(&slotKeyOnce, createSlotKey);
+    pthread_mutex_lock(&slotsLock);
+    for(slot = slots; slot != NULL; slot = slot->next){
+        if(!atomic_load(&slot->inUse))
+            break;
+    }
+    if(slot == NULL){
+        slot = calloc(1, sizeof(struct statsSlot));
+        if(slot != NULL){
+            slot->next = slots;
+            slots = slot;
+        }
+    }
+    if(slot != NULL)
+        atomic_store(&slot->inUse, true);
+    pthread_mutex_unlock(&slotsLock);
+
+    if(slot != NULL)
+        pthread_setspecific(slotKey, slot);
+    threadSlot = slot;
+    return slot;
+}
+
+/**
+ * Soma um valor a um contador da thread
+ * \param counter Contador
+ * \param value Valor
+ */
+static void addCounter(_Atomic unsigned long long* counter, unsigned long long value){
+    atomic_store_explicit(counter,
+            atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+/**
+ * Lê o relógio monotônico
+ * \return Nanossegundos
+ */
+static long long nowNanoseconds(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Retorna a faixa do histograma de uma latência
+ * \return Faixa (0 - DATE_STATS_BUCKETS - 1)
+ * \param nanoseconds Latência
+ */
+static int latencyBucket(unsigned long long nanoseconds){
+    int bucket = (nanoseconds == 0) ? 0 : 64 - __builtin_clzll(nanoseconds);
+    return (bucket < DATE_STATS_BUCKETS) ? bucket : DATE_STATS_BUCKETS - 1;
+}
+
+#endif /* DATE_STATS */
+
+/**
+ * Retorna o limite superior de uma faixa do histograma
+ * \return Latência em nanossegundos
+ * \param bucket Faixa
+ */
+static unsigned long long bucketLimit(int bucket){
+    return (bucket == 0) ? 0 : (1ULL << bucket) - 1;
+}
+
+/**
+ * Retorna a latência abaixo da qual está uma fração das chamadas
+ * \return Limite superior da faixa que contém o percentil
+ * \param histogram Histograma
+ * \param calls Total de chamadas
+ * \param fraction Fração (0.5 para a mediana)
+ */
+static unsigned long long percentile(const unsigned long long* histogram,
+        unsigned long long calls, double fraction){
+    unsigned long long target = (unsigned long long) (calls * fraction);
+    unsigned long long seen = 0;
+    int bucket;
+
+    for(bucket = 0; bucket < DATE_STATS_BUCKETS; bucket++){
+        seen += histogram[bucket];
+        if(seen > target)
+            return bucketLimit(bucket);
+    }
+
+    return bucketLimit(DATE_STATS_BUCKETS - 1);
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Verifica se a biblioteca foi compilada com a instrumentação
+ * \return true se DATE_STATS estava definido
+ */
+bool isDateStatsEnabled(void){
+#ifdef DATE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Copia as estatísticas de todas as threads<BR>
+ * Os contadores são lidos sem parar as outras threads, então chamadas em
+ * andamento podem ou não estar incluídas
+ * \param snapshot Ponteiro onde serão guardadas as estatísticas
+ */
+void getDateStats(DateStatsSnapshot* snapshot){
+    if(snapshot == NULL)
+        return;
+
+    memset(snapshot, 0, sizeof(DateStatsSnapshot));
+
+#ifdef DATE_STATS
+    struct statsSlot* slot;
+    int stat, bucket;
+
+    pthread_mutex_lock(&slotsLock);
+    for(slot = slots; slot != NULL; slot = slot->next){
+        for(stat = 0; stat < DATE_STAT_COUNT; stat++){
+            snapshot->calls[stat] += atomic_load_explicit(&slot->calls[stat], memory_order_relaxed);
+            snapshot->nanoseconds[stat] += atomic_load_explicit(&slot->nanoseconds[stat],
+                    memory_order_relaxed);
+            for(bucket = 0; bucket < DATE_STATS_BUCKETS; bucket++)
+                snapshot->latency[stat][bucket] += atomic_load_explicit(
+                        &slot->latency[stat][bucket], memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&slotsLock);
+#endif
+}
+
+/**
+ * Zera as estatísticas de todas as threads
+ */
+void resetDateStats(void){
+#ifdef DATE_STATS
+    struct statsSlot* slot;
+    int stat, bucket;
+
+    pthread_mutex_lock(&slotsLock);
+    for(slot = slots; slot != NULL; slot = slot->next){
+        for(stat = 0; stat < DATE_STAT_COUNT; stat++){
+            atomic_store_explicit(&slot->calls[stat], 0, memory_order_relaxed);
+            atomic_store_explicit(&slot->nanoseconds[stat], 0, memory_order_relaxed);
+            for(bucket = 0; bucket < DATE_STATS_BUCKETS; bucket++)
+                atomic_store_explicit(&slot->latency[stat][bucket], 0, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&slotsLock);
+#endif
+}
+
+/**
+ * Escreve as estatísticas em um arquivo, uma linha por ponto instrumentado
+ * com chamadas, separando as colunas por tabulação: nome, chamadas, tempo
+ * médio, p50 e p99 (limites superiores das faixas do histograma, em ns). Os
+ * eventos, que não têm latência, mostram '-' nas três últimas colunas
+ * \param file Arquivo de saída (stdout, stderr ...)
+ */
+void dumpDateStats(FILE* file){
+    DateStatsSnapshot* snapshot;
+    int stat;
+
+    if(file == NULL)
+        return;
+
+    if(!isDateStatsEnabled()){
+        fprintf(file, "# estatísticas desativadas (compile com DATE_STATS)\n");
+        return;
+    }
+
+    // a cópia é grande demais para a pilha de threads pequenas
+    snapshot = malloc(sizeof(DateStatsSnapshot));
+    if(snapshot == NULL)
+        return;
+    getDateStats(snapshot);
+
+    fprintf(file, "name\tcalls\tmean_ns\tp50_ns\tp99_ns\n");
+    for(stat = 0; stat < DATE_STAT_COUNT; stat++){
+        unsigned long long calls = snapshot->calls[stat];
+        unsigned long long timed = 0;
+        int bucket;
+
+        if(calls == 0)
+            continue;
+
+        // eventos só são contados, sem latência
+        for(bucket = 0; bucket < DATE_STATS_BUCKETS; bucket++)
+            timed += snapshot->latency[stat][bucket];
+        if(timed == 0){
+            fprintf(file, "%s\t%llu\t-\t-\t-\n", STAT_NAMES[stat], calls);
+            continue;
+        }
+
+        fprintf(file, "%s\t%llu\t%.1f\t%llu\t%llu\n", STAT_NAMES[stat], calls,
+                (double) snapshot->nanoseconds[stat] / (double) timed,
+                percentile(snapshot->latency[stat], timed, 0.5),
+                percentile(snapshot->latency[stat], timed, 0.99));
+    }
+
+    free(snapshot);
+}
+
+/**
+ * Retorna o nome de um ponto instrumentado
+ * \return Nome (NULL se o ponto não existir)
+ * \param stat Ponto instrumentado
+ */
+const char* getDateStatName(enum DateStat stat){
+    if(stat < 0 || stat >= DATE_STAT_COUNT)
+        return NULL;
+
+    return STAT_NAMES[stat];
+}
+
+#ifdef DATE_STATS
+
+/**
+ * Inicia a medição de uma chamada
+ * \return Medição em andamento
+ * \param stat Ponto instrumentado
+ */
+struct dateStatTimer startDateStatTimer(enum DateStat stat){
+    struct dateStatTimer timer;
+
+    timer.stat = stat;
+    timer.start = nowNanoseconds();
+    return timer;
+}
+
+/**
+ * Termina a medição de uma chamada (chamada automaticamente no fim do escopo)
+ * \param timer Medição em andamento
+ */
+void stopDateStatTimer(struct dateStatTimer* timer){
+    unsigned long long elapsed = (unsigned long long) (nowNanoseconds() - timer->start);
+    struct statsSlot* slot = getThreadSlot();
+
+    if(slot == NULL)
+        return;
+
+    addCounter(&slot->calls[timer->stat], 1);
+    addCounter(&slot->nanoseconds[timer->stat], elapsed);
+    addCounter(&slot->latency[timer->stat][latencyBucket(elapsed)], 1);
+}
+
+/**
+ * Conta um evento
+ * \param stat Ponto instrumentado
+ */
+void countDateStat(enum DateStat stat){
+    struct statsSlot* slot = getThreadSlot();
+
+    if(slot != NULL)
+        addCounter(&slot->calls[stat], 1);
+}
+
+#endif /* DATE_STATS */
@@ -0,0 +1,648 @@
+/**
+ * \file dateThreadPool.c
+ * Implementação do arquivo dateThreadPool.h
+ */
+
+// necessário para sched_getaffinity() e pthread_attr_setaffinity_np()
+#define _GNU_SOURCE
+
+#include "../h_files/dateThreadPool.h"
+#include "../h_files/dateParse.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Tamanho padrão dos blocos de um laço paralelo (múltiplo de 64, para que os
+ * blocos da validação em lote ocupem palavras inteiras do mapa de bits)
+ */
+#define DEFAULT_GRAIN 4096
+
+/**
+ * Tamanho da linha de cache, para que as partes de threads diferentes não
+ * compartilhem linhas
+ */
+#define CACHE_LINE 64
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Parte de um laço paralelo reservada a uma thread
+ */
+struct threadSlot{
+    // blocos ainda não processados: primeiro nos 32 bits baixos e seguinte
+    // ao último nos 32 bits altos (a dona tira do início, as outras do fim)
+    _Alignas(CACHE_LINE) _Atomic uint64_t blocks;
+    // thread trabalhadora (não usada pela parte 0, que é da thread que chama)
+    pthread_t thread;
+    // pool ao qual a parte pertence
+    DateThreadPool* pool;
+    // posição da parte no pool
+    unsigned int index;
+};
+
+/**
+ * Pool de threads
+ */
+struct dateThreadPool{
+    // quantidade de threads, contando a que chama os laços
+    unsigned int threadCount;
+    // uma parte por thread
+    struct threadSlot* slots;
+    // protege os campos abaixo
+    pthread_mutex_t lock;
+    // sinaliza um laço novo ou o fim do pool às trabalhadoras
+    pthread_cond_t wake;
+    // sinaliza que todas as trabalhadoras terminaram o laço
+    pthread_cond_t done;
+    // garante que um laço seja executado de cada vez
+    pthread_mutex_t runLock;
+    // número do laço atual
+    unsigned long generation;
+    // trabalhadoras que ainda não terminaram o laço atual
+    unsigned int running;
+    // se as trabalhadoras devem terminar
+    bool stopping;
+    // função do laço atual
+    DateRangeFunction function;
+    // contexto do laço atual
+    void* context;
+    // quantidade de índices do laço atual
+    size_t count;
+    // tamanho dos blocos do laço atual
+    size_t grain;
+};
+
+/**
+ * Contexto de touchDateThreadPool()
+ */
+struct touchJob{
+    char* buffer;
+    size_t itemSize;
+};
+
+/**
+ * Contexto da decomposição em paralelo
+ */
+struct componentsJob{
+    const TimeZone* zone;
+    const time_t* seconds;
+    const DateComponentArrays* components;
+};
+
+/**
+ * Contexto da validação em paralelo
+ */
+struct validateJob{
+    const DateFieldArrays* fields;
+    uint64_t* validMask;
+    _Atomic size_t total;
+};
+
+/**
+ * Contexto da leitura em paralelo
+ */
+struct parseJob{
+    const char* const* texts;
+    const size_t* lengths;
+    // formato dos textos, ou -1 para ISO-8601
+    int dateString;
+    const TimeZone* zone;
+    time_t* seconds;
+    bool* valid;
+    _Atomic size_t total;
+};
+
+/**
+ * Contexto da formatação em paralelo
+ */
+struct formatJob{
+    const DateFormatPlan* plan;
+    const TimeZone* zone;
+    const time_t* seconds;
+    char* texts;
+    size_t stride;
+    size_t* lengths;
+    _Atomic size_t total;
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Retira o primeiro bloco da parte de uma thread
+ * \return false se a parte estiver vazia
+ * \param slot Parte
+ * \param block Ponteiro onde será guardado o bloco retirado
+ */
+static bool takeFirstBlock(struct threadSlot* slot, size_t* block){
+    uint64_t blocks = atomic_load_explicit(&slot->blocks, memory_order_relaxed);
+
+    while((uint32_t) blocks < (uint32_t) (blocks >> 32)){
+        if(atomic_compare_exchange_weak_explicit(&slot->blocks, &blocks, blocks + 1,
+                memory_order_relaxed, memory_order_relaxed)){
+            *block = (uint32_t) blocks;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Retira o último bloco da parte de outra thread
+ * \return false se a parte estiver vazia
+ * \param slot Parte
+ * \param block Ponteiro onde será guardado o bloco retirado
+ */
+static bool stealLastBlock(struct threadSlot* slot, size_t* block){
+    uint64_t blocks = atomic_load_explicit(&slot->blocks, memory_order_relaxed);
+
+    while((uint32_t) blocks < (uint32_t) (blocks >> 32)){
+        if(atomic_compare_exchange_weak_explicit(&slot->blocks, &blocks,
+                blocks - (UINT64_C(1) << 32), memory_order_relaxed, memory_order_relaxed)){
+            *block = (uint32_t) (blocks >> 32) - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Executa um bloco do laço atual
+ * \param pool Ponteiro para objeto DateThreadPool
+ * \param block Bloco
+ */
+static void runBlock(DateThreadPool* pool, size_t block){
+    size_t begin = block * pool->grain;
+    size_t end = (pool->count - begin > pool->grain) ? begin + pool->grain : pool->count;
+
+    pool->function(pool->context, begin, end);
+}
+
+/**
+ * Processa a parte de uma thread e depois rouba blocos das outras partes
+ * \param slot Parte da thread
+ */
+static void workSlot(struct threadSlot* slot){
+    DateThreadPool* pool = slot->pool;
+    unsigned int other;
+    size_t block;
+
+    while(takeFirstBlock(slot, &block))
+        runBlock(pool, block);
+
+    // as outras partes, a partir da vizinha, enquanto tiverem blocos
+    for(other = 1; other < pool->threadCount; other++){
+        struct threadSlot* victim = &pool->slots[(slot->index + other) % pool->threadCount];
+        while(stealLastBlock(victim, &block))
+            runBlock(pool, block);
+    }
+}
+
+/**
+ * Laço das threads trabalhadoras: espera um laço novo, processa e avisa
+ * \return NULL
+ * \param argument Ponteiro para a parte da thread
+ */
+static void* workerLoop(void* argument){
+    struct threadSlot* slot = argument;
+    DateThreadPool* pool = slot->pool;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for(;;){
+        while(!pool->stopping && pool->generation == seen)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if(pool->stopping)
+            break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        workSlot(slot);
+
+        pthread_mutex_lock(&pool->lock);
+        if(--pool->running == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * Retorna as CPUs que o processo pode usar
+ * \return Quantidade de CPUs guardadas em cpus
+ * \param cpus Vetor onde serão guardados os números das CPUs (CPU_SETSIZE
+ *      posições)
+ */
+static unsigned int allowedCpus(int* cpus){
+    cpu_set_t set;
+    unsigned int count = 0;
+    int cpu;
+
+    if(sched_getaffinity(0, sizeof(set), &set) != 0)
+        return 0;
+
+    for(cpu = 0; cpu < CPU_SETSIZE; cpu++){
+        if(CPU_ISSET(cpu, &set))
+            cpus[count++] = cpu;
+    }
+    return count;
+}
+
+/**
+ * Zera um trecho de um vetor (função de laço de touchDateThreadPool())
+ * \param context Ponteiro para struct touchJob
+ * \param begin Primeiro item
+ * \param end Item seguinte ao último
+ */
+static void touchRange(void* context, size_t begin, size_t end){
+    const struct touchJob* job = context;
+    memset(job->buffer + begin * job->itemSize, 0, (end - begin) * job->itemSize);
+}
+
+/**
+ * Decompõe um trecho (função de laço de getDateComponentsBatchParallel())
+ * \param context Ponteiro para struct componentsJob
+ * \param begin Primeira data
+ * \param end Data seguinte à última
+ */
+static void componentsRange(void* context, size_t begin, size_t end){
+    const struct componentsJob* job = context;
+    const DateComponentArrays* all = job->components;
+    DateComponentArrays part = {
+        (all->mday != NULL) ? all->mday + begin : NULL,
+        (all->yday != NULL) ? all->yday + begin : NULL,
+        (all->wday != NULL) ? all->wday + begin : NULL,
+        (all->month != NULL) ? all->month + begin : NULL,
+        (all->year != NULL) ? all->year + begin : NULL,
+        (all->hour != NULL) ? all->hour + begin : NULL,
+        (all->hourAmPm != NULL) ? all->hourAmPm + begin : NULL,
+        (all->minute != NULL) ? all->minute + begin : NULL,
+        (all->second != NULL) ? all->second + begin : NULL
+    };
+
+    getDateComponentsBatchZone(job->zone, job->seconds + begin, end - begin, &part);
+}
+
+/**
+ * Valida um trecho (função de laço de validateDatesBatchParallel())
+ * \param context Ponteiro para struct validateJob
+ * \param begin Primeira data (múltiplo de 64)
+ * \param end Data seguinte à última
+ */
+static void validateRange(void* context, size_t begin, size_t end){
+    struct validateJob* job = context;
+    const DateFieldArrays* all = job->fields;
+    DateFieldArrays part = {
+        all->day + begin,
+        all->month + begin,
+        all->year + begin,
+        (all->hour != NULL) ? all->hour + begin : NULL,
+        (all->minute != NULL) ? all->minute + begin : NULL,
+        (all->second != NULL) ? all->second + begin : NULL
+    };
+    size_t valid = validateDatesBatch(&part, end - begin, job->validMask + begin / 64);
+
+    atomic_fetch_add_explicit(&job->total, valid, memory_order_relaxed);
+}
+
+/**
+ * Lê um trecho (função de laço das leituras em paralelo)
+ * \param context Ponteiro para struct parseJob
+ * \param begin Primeiro texto
+ * \param end Texto seguinte ao último
+ */
+static void parseRange(void* context, size_t begin, size_t end){
+    struct parseJob* job = context;
+    const size_t* lengths = (job->lengths != NULL) ? job->lengths + begin : NULL;
+    bool* valid = (job->valid != NULL) ? job->valid + begin : NULL;
+    size_t parsed;
+
+    if(job->dateString < 0)
+        parsed = parseIsoDateBatch(job->texts + begin, lengths, end - begin, job->zone,
+                job->seconds + begin, valid);
+    else
+        parsed = parseDateStringBatch(job->texts + begin, lengths, end - begin,
+                (enum DateString) job->dateString, job->zone, job->seconds + begin, valid);
+
+    atomic_fetch_add_explicit(&job->total, parsed, memory_order_relaxed);
+}
+
+/**
+ * Formata um trecho (função de laço de formatDatesBatchPlanParallel())
+ * \param context Ponteiro para struct formatJob
+ * \param begin Primeira data
+ * \param end Data seguinte à última
+ */
+static void formatRange(void* context, size_t begin, size_t end){
+    struct formatJob* job = context;
+    size_t formatted = formatDatesBatchPlan(job->plan, job->zone, job->seconds + begin,
+            end - begin, job->texts + begin * job->stride, job->stride,
+            (job->lengths != NULL) ? job->lengths + begin : NULL);
+
+    atomic_fetch_add_explicit(&job->total, formatted, memory_order_relaxed);
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Cria um pool de threads
+ * \return Ponteiro para objeto DateThreadPool, ou NULL se faltar memória
+ * \param threads Quantidade de threads, contando a que chama os laços (0 para
+ *      uma por processador; 1 executa tudo de modo síncrono)
+ */
+DateThreadPool* createDateThreadPool(unsigned int threads){
+    int cpus[CPU_SETSIZE];
+    DateThreadPool* pool;
+    unsigned int cpuCount, i;
+
+    cpuCount = allowedCpus(cpus);
+    if(threads == 0){
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cpuCount > 0) ? cpuCount : (processors > 0) ? (unsigned int) processors : 1;
+    }
+
+    pool = calloc(1, sizeof(DateThreadPool));
+    if(pool == NULL)
+        return NULL;
+
+    pool->slots = aligned_alloc(CACHE_LINE, threads * sizeof(struct threadSlot));
+    if(pool->slots == NULL){
+        free(pool);
+        return NULL;
+    }
+    memset(pool->slots, 0, threads * sizeof(struct threadSlot));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pthread_mutex_init(&pool->runLock, NULL);
+
+    pool->slots[0].pool = pool;
+    pool->threadCount = 1;
+    // a trabalhadora i fica na i-ésima CPU permitida (a thread que chama os
+    // laços, dona da parte 0, não é presa)
+    for(i = 1; i < threads; i++){
+        struct threadSlot* slot = &pool->slots[i];
+        pthread_attr_t attributes;
+        bool started;
+
+        slot->pool = pool;
+        slot->index = i;
+        pthread_attr_init(&attributes);
+        if(cpuCount > 1){
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[i % cpuCount], &set);
+            pthread_attr_setaffinity_np(&attributes, sizeof(set), &set);
+        }
+        started = pthread_create(&slot->thread, &attributes, workerLoop, slot) == 0;
+        pthread_attr_destroy(&attributes);
+
+        // sem thread, o pool fica com as que já foram criadas
+        if(!started)
+            break;
+        pool->threadCount++;
+    }
+
+    return pool;
+}
+
+/**
+ * Termina as threads e desaloca o pool
+ * \return NULL
+ * \param pool Ponteiro para objeto DateThreadPool a ser desalocado
+ */
+DateThreadPool* destroyDateThreadPool(DateThreadPool* pool){
+    unsigned int i;
+
+    if(pool == NULL)
+        return NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for(i = 1; i < pool->threadCount; i++)
+        pthread_join(pool->slots[i].thread, NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    pthread_mutex_destroy(&pool->runLock);
+    free(pool->slots);
+    free(pool);
+    return NULL;
+}
+
+/**
+ * Retorna a quantidade de threads do pool, contando a que chama os laços
+ * \return Quantidade de threads (1 para pool NULL)
+ * \param pool Ponteiro para objeto DateThreadPool
+ */
+unsigned int getDateThreadPoolSize(const DateThreadPool* pool){
+    return (pool != NULL) ? pool->threadCount : 1;
+}
+
+/**
+ * Executa um laço paralelo sobre os índices [0, count)<BR>
+ * Cada índice é passado uma única vez à função, em intervalos de até grain
+ * índices que começam em múltiplos de grain. Retorna depois que todos os
+ * intervalos forem processados
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para executar na
+ *      própria thread)
+ * \param count Quantidade de índices
+ * \param grain Tamanho dos blocos (0 para o padrão)
+ * \param function Função executada para cada intervalo
+ * \param context Ponteiro repassado à função
+ */
+void runDateThreadPool(DateThreadPool* pool, size_t count, size_t grain,
+        DateRangeFunction function, void* context){
+    size_t blockCount, begin;
+    unsigned int i;
+
+    if(function == NULL || count == 0)
+        return;
+    if(grain == 0)
+        grain = DEFAULT_GRAIN;
+    // os blocos de cada parte são contados em 32 bits
+    if(count / grain >= UINT32_MAX)
+        grain = count / (UINT32_MAX - 1) + 1;
+    blockCount = (count - 1) / grain + 1;
+
+    // execução síncrona
+    if(pool == NULL || pool->threadCount == 1 || blockCount == 1){
+        for(begin = 0; begin < count; begin += grain)
+            function(context, begin, (count - begin > grain) ? begin + grain : count);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->runLock);
+    pthread_mutex_lock(&pool->lock);
+    pool->function = function;
+    pool->context = context;
+    pool->count = count;
+    pool->grain = grain;
+    // a divisão só depende da quantidade de blocos e de threads
+    for(i = 0; i < pool->threadCount; i++){
+        uint64_t first = blockCount * i / pool->threadCount;
+        uint64_t end = blockCount * (i + 1) / pool->threadCount;
+        atomic_store_explicit(&pool->slots[i].blocks, first | (end << 32), memory_order_relaxed);
+    }
+    pool->running = pool->threadCount - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    workSlot(&pool->slots[0]);
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->running > 0)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->runLock);
+}
+
+/**
+ * Zera um vetor dividindo-o entre as threads do mesmo modo que um laço
+ * paralelo com a mesma quantidade de itens, para que cada página seja
+ * tocada pela primeira vez pela thread que vai processá-la
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param buffer Vetor recém-alocado
+ * \param count Quantidade de itens
+ * \param itemSize Tamanho de cada item em bytes
+ */
+void touchDateThreadPool(DateThreadPool* pool, void* buffer, size_t count,
+        size_t itemSize){
+    struct touchJob job = {buffer, itemSize};
+
+    if(buffer != NULL)
+        runDateThreadPool(pool, count, 0, touchRange, &job);
+}
+
+/**
+ * Decompõe um vetor de datas em paralelo (veja getDateComponentsBatchZone()
+ * em dateBatch.h)
+ * \return false se algum ponteiro obrigatório for NULL, true em caso contrário
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas no vetor
+ * \param components Vetores de saída (componentes NULL são ignorados)
+ */
+bool getDateComponentsBatchParallel(DateThreadPool* pool, const TimeZone* zone,
+        const time_t* seconds, size_t count, DateComponentArrays* components){
+    struct componentsJob job = {zone, seconds, components};
+
+    if(components == NULL || (seconds == NULL && count > 0))
+        return false;
+
+    runDateThreadPool(pool, count, 0, componentsRange, &job);
+    return true;
+}
+
+/**
+ * Valida um vetor de datas em paralelo (veja validateDatesBatch() em
+ * dateBatch.h)
+ * \return Quantidade de datas válidas (0 se algum ponteiro obrigatório for
+ *      NULL)
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param fields Vetores de entrada (veja struct dateFieldArrays)
+ * \param count Quantidade de datas
+ * \param validMask Vetor com pelo menos (count + 63) / 64 palavras
+ */
+size_t validateDatesBatchParallel(DateThreadPool* pool, const DateFieldArrays* fields,
+        size_t count, uint64_t* validMask){
+    struct validateJob job = {fields, validMask, 0};
+
+    if(fields == NULL || validMask == NULL || (count > 0 && (fields->day == NULL
+            || fields->month == NULL || fields->year == NULL)))
+        return 0;
+
+    // blocos múltiplos de 64 não dividem palavras do mapa de bits
+    runDateThreadPool(pool, count, DEFAULT_GRAIN, validateRange, &job);
+    return atomic_load(&job.total);
+}
+
+/**
+ * Lê um vetor de datas em paralelo (veja parseDateStringBatch() em
+ * dateParse.h)
+ * \return Quantidade de datas lidas com sucesso
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param texts Vetor de textos
+ * \param lengths Vetor com o tamanho de cada texto (NULL se os textos
+ *      terminarem com '\0')
+ * \param count Quantidade de textos
+ * \param dateString Enumerador que indica o formato dos textos (veja date.h)
+ * \param zone Fuso dos textos (NULL para o fuso local)
+ * \param seconds Vetor onde serão guardadas as datas (0 para as inválidas)
+ * \param valid Vetor onde será guardado se cada texto foi lido (pode ser NULL)
+ */
+size_t parseDateStringBatchParallel(DateThreadPool* pool, const char* const* texts,
+        const size_t* lengths, size_t count, enum DateString dateString,
+        const TimeZone* zone, time_t* seconds, bool* valid){
+    struct parseJob job = {texts, lengths, (int) dateString, zone, seconds, valid, 0};
+
+    runDateThreadPool(pool, count, 0, parseRange, &job);
+    return atomic_load(&job.total);
+}
+
+/**
+ * Lê um vetor de datas ISO-8601/RFC-3339 em paralelo (veja
+ * parseIsoDateBatch() em dateParse.h)
+ * \return Quantidade de datas lidas com sucesso
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param texts Vetor de textos
+ * \param lengths Vetor com o tamanho de cada texto (NULL se os textos
+ *      terminarem com '\0')
+ * \param count Quantidade de textos
+ * \param zone Fuso usado quando o texto não traz deslocamento (NULL para o
+ *      fuso local)
+ * \param seconds Vetor onde serão guardadas as datas (0 para as inválidas)
+ * \param valid Vetor onde será guardado se cada texto foi lido (pode ser NULL)
+ */
+size_t parseIsoDateBatchParallel(DateThreadPool* pool, const char* const* texts,
+        const size_t* lengths, size_t count, const TimeZone* zone, time_t* seconds,
+        bool* valid){
+    struct parseJob job = {texts, lengths, -1, zone, seconds, valid, 0};
+
+    runDateThreadPool(pool, count, 0, parseRange, &job);
+    return atomic_load(&job.total);
+}
+
+/**
+ * Formata um vetor de datas em paralelo (veja formatDatesBatchPlan() em
+ * dateFormat.h)
+ * \return Quantidade de datas formatadas
+ * \param pool Ponteiro para objeto DateThreadPool (NULL para a própria thread)
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param zone Fuso das datas (NULL para o fuso local)
+ * \param seconds Vetor de datas em segundos desde 1970
+ * \param count Quantidade de datas
+ * \param texts Memória com count * stride bytes onde os textos serão escritos
+ * \param stride Espaço de cada texto em bytes
+ * \param lengths Vetor onde será guardado o tamanho de cada texto (pode ser
+ *      NULL)
+ */
+size_t formatDatesBatchPlanParallel(DateThreadPool* pool, const DateFormatPlan* plan,
+        const TimeZone* zone, const time_t* seconds, size_t count, char* texts,
+        size_t stride, size_t* lengths){
+    struct formatJob job = {plan, zone, seconds, texts, stride, lengths, 0};
+
+    if(plan == NULL || texts == NULL || stride == 0 || (seconds == NULL && count > 0))
+        return 0;
+
+    runDateThreadPool(pool, count, 0, formatRange, &job);
+    return atomic_load(&job.total);
+}
@@ -0,0 +1,326 @@
+/**
+ * \file dateWriter.c
+ * Implementação do arquivo dateWriter.h
+ */
+
+#include "../h_files/dateWriter.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/uio.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Tamanho padrão do bloco de um objeto de escrita
+ */
+#define DEFAULT_CAPACITY (64 * 1024)
+
+/**
+ * Tamanho do bloco dos objetos de escrita ligados a stdout (uma linha de
+ * printDate() de cada vez)
+ */
+#define STDOUT_CAPACITY 256
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Objeto de escrita de datas
+ */
+struct dateWriter{
+    // arquivo de destino (NULL se o destino for um descritor)
+    FILE* file;
+    // descritor de destino (usado quando file é NULL)
+    int fd;
+    // textos pendentes
+    char* buffer;
+    // tamanho de buffer em bytes
+    size_t capacity;
+    // bytes pendentes em buffer
+    size_t used;
+};
+
+/******************************************************************************
+ * Variáveis do módulo
+ ******************************************************************************/
+
+/**
+ * Bloco do objeto de escrita ligado a stdout, um por thread
+ */
+static _Thread_local char stdoutBuffer[STDOUT_CAPACITY];
+
+/**
+ * Objeto de escrita ligado a stdout, um por thread
+ */
+static _Thread_local DateWriter stdoutWriter;
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Cria um objeto de escrita
+ * \return Ponteiro para objeto DateWriter, ou NULL se faltar memória
+ * \param file Arquivo de destino (NULL para usar fd)
+ * \param fd Descritor de destino
+ * \param capacity Tamanho do bloco em bytes (0 para o padrão)
+ */
+static DateWriter* newWriter(FILE* file, int fd, size_t capacity){
+    DateWriter* writer = malloc(sizeof(DateWriter));
+
+    if(writer == NULL)
+        return NULL;
+
+    if(capacity == 0)
+        capacity = DEFAULT_CAPACITY;
+    // uma data de enum DateString sempre cabe em um bloco vazio
+    if(capacity < DATE_STRING_SIZE)
+        capacity = DATE_STRING_SIZE;
+
+    writer->buffer = malloc(capacity);
+    if(writer->buffer == NULL){
+        free(writer);
+        return NULL;
+    }
+    writer->file = file;
+    writer->fd = fd;
+    writer->capacity = capacity;
+    writer->used = 0;
+    return writer;
+}
+
+/**
+ * Escreve todos os trechos em um descritor, repetindo writev() em escritas
+ * parciais e interrupções
+ * \return false se houver erro de escrita
+ * \param fd Descritor de destino
+ * \param parts Trechos (são alterados)
+ * \param count Quantidade de trechos
+ */
+static bool writeAll(int fd, struct iovec* parts, int count){
+    while(count > 0){
+        ssize_t written = writev(fd, parts, count);
+
+        if(written < 0){
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+
+        // descarta os trechos já escritos e avança no trecho parcial
+        while(count > 0 && (size_t) written >= parts->iov_len){
+            written -= (ssize_t) parts->iov_len;
+            parts++;
+            count--;
+        }
+        if(count > 0){
+            parts->iov_base = (char*) parts->iov_base + written;
+            parts->iov_len -= (size_t) written;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Entrega os textos pendentes seguidos de um texto extra
+ * \return false se houver erro de escrita
+ * \param writer Ponteiro para objeto DateWriter
+ * \param extra Texto entregue depois dos pendentes (pode ser NULL)
+ * \param extraLength Tamanho do texto extra em bytes
+ */
+static bool deliver(DateWriter* writer, const char* extra, size_t extraLength){
+    size_t used = writer->used;
+    bool ok;
+
+    writer->used = 0;
+    if(writer->file != NULL){
+        ok = fwrite(writer->buffer, 1, used, writer->file) == used
+                && (extraLength == 0
+                || fwrite(extra, 1, extraLength, writer->file) == extraLength);
+    }
+    else{
+        struct iovec parts[2];
+        int count = 0;
+
+        if(used > 0){
+            parts[count].iov_base = writer->buffer;
+            parts[count++].iov_len = used;
+        }
+        if(extraLength > 0){
+            parts[count].iov_base = (void*) extra;
+            parts[count++].iov_len = extraLength;
+        }
+        ok = writeAll(writer->fd, parts, count);
+    }
+
+    return ok;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Cria um objeto de escrita que entrega os textos a um FILE*<BR>
+ * Os blocos passam pelo FILE* (a ordem em relação a outras escritas no mesmo
+ * FILE* é a ordem das chamadas a flushDateWriter())
+ * \return Ponteiro para objeto DateWriter, ou NULL se file for NULL ou faltar
+ *      memória
+ * \param file Arquivo de destino (não é fechado por destroyDateWriter())
+ * \param capacity Tamanho do bloco em bytes (0 para o padrão)
+ */
+DateWriter* createDateWriter(FILE* file, size_t capacity){
+    if(file == NULL)
+        return NULL;
+
+    return newWriter(file, -1, capacity);
+}
+
+/**
+ * Cria um objeto de escrita que entrega os textos a um descritor de arquivo
+ * com write()/writev()
+ * \return Ponteiro para objeto DateWriter, ou NULL se fd for inválido ou
+ *      faltar memória
+ * \param fd Descritor de destino (não é fechado por destroyDateWriter())
+ * \param capacity Tamanho do bloco em bytes (0 para o padrão)
+ */
+DateWriter* createDateWriterFd(int fd, size_t capacity){
+    if(fd < 0)
+        return NULL;
+
+    return newWriter(NULL, fd, capacity);
+}
+
+/**
+ * Entrega os textos pendentes e desaloca o objeto de escrita
+ * \return NULL
+ * \param writer Ponteiro para objeto DateWriter a ser desalocado
+ */
+DateWriter* destroyDateWriter(DateWriter* writer){
+    if(writer == NULL)
+        return NULL;
+
+    flushDateWriter(writer);
+    free(writer->buffer);
+    free(writer);
+    return NULL;
+}
+
+/**
+ * Retorna o objeto de escrita da thread atual ligado a stdout<BR>
+ * É usado por printDate() e printWeekDate() e não deve ser desalocado
+ * \return Ponteiro para objeto DateWriter
+ */
+DateWriter* getStdoutDateWriter(void){
+    if(stdoutWriter.buffer == NULL){
+        stdoutWriter.file = stdout;
+        stdoutWriter.fd = -1;
+        stdoutWriter.buffer = stdoutBuffer;
+        stdoutWriter.capacity = STDOUT_CAPACITY;
+        stdoutWriter.used = 0;
+    }
+
+    return &stdoutWriter;
+}
+
+/**
+ * Entrega os textos pendentes ao destino
+ * \return false se houver erro de escrita (veja errno; os textos pendentes
+ *      são descartados)
+ * \param writer Ponteiro para objeto DateWriter
+ */
+bool flushDateWriter(DateWriter* writer){
+    if(writer == NULL)
+        return false;
+    if(writer->used == 0)
+        return true;
+
+    return deliver(writer, NULL, 0);
+}
+
+/**
+ * Acrescenta um texto qualquer
+ * \return false se houver erro de escrita (veja errno)
+ * \param writer Ponteiro para objeto DateWriter
+ * \param text Texto
+ * \param length Tamanho do texto em bytes
+ */
+bool writeDateText(DateWriter* writer, const char* text, size_t length){
+    if(writer == NULL || (text == NULL && length > 0))
+        return false;
+
+    // sem espaço, o texto vai junto com o bloco pendente, sem cópia
+    if(length > writer->capacity - writer->used)
+        return deliver(writer, text, length);
+
+    memcpy(writer->buffer + writer->used, text, length);
+    writer->used += length;
+    return true;
+}
+
+/**
+ * Acrescenta uma data em um dos formatos de enum DateString (o mesmo texto
+ * de formatDate() em dateFormat.h)
+ * \return false se o formato for inválido ou houver erro de escrita
+ * \param writer Ponteiro para objeto DateWriter
+ * \param date Ponteiro para objeto Date
+ * \param dateString Enumerador que indica qual o formato da string
+ *      a ser utilizado (veja date.h)
+ * \param weekDayName Se o nome do dia da semana deve constar no final da string
+ */
+bool writeDate(DateWriter* writer, Date** date, enum DateString dateString,
+        bool weekDayName){
+    size_t length;
+
+    if(writer == NULL)
+        return false;
+    if(writer->capacity - writer->used < DATE_STRING_SIZE && !deliver(writer, NULL, 0))
+        return false;
+
+    // formata direto no bloco (o '\0' final é sobrescrito pelo próximo texto)
+    length = formatDate(date, dateString, weekDayName, writer->buffer + writer->used,
+            writer->capacity - writer->used);
+    writer->used += length;
+    return length > 0;
+}
+
+/**
+ * Acrescenta uma data formatada com um plano de formatação (o mesmo texto de
+ * formatDatePlan() em dateFormat.h)
+ * \return false se houver erro de escrita ou faltar memória
+ * \param writer Ponteiro para objeto DateWriter
+ * \param plan Ponteiro para objeto DateFormatPlan
+ * \param date Ponteiro para objeto Date
+ */
+bool writeDatePlan(DateWriter* writer, const DateFormatPlan* plan, Date** date){
+    size_t needed, length;
+    char* text;
+    bool ok;
+
+    if(writer == NULL || plan == NULL)
+        return false;
+
+    needed = getDateFormatPlanMaxLength(plan) + 1;
+    if(writer->capacity - writer->used < needed && !deliver(writer, NULL, 0))
+        return false;
+
+    if(needed <= writer->capacity){
+        writer->used += formatDatePlan(plan, date, writer->buffer + writer->used,
+                writer->capacity - writer->used);
+        return true;
+    }
+
+    // padrão maior que o bloco: formata em memória temporária
+    text = malloc(needed);
+    if(text == NULL)
+        return false;
+    length = formatDatePlan(plan, date, text, needed);
+    ok = deliver(writer, text, length);
+    free(text);
+    return ok;
+}
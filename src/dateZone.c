@@ -0,0 +1,963 @@
+/**
+ * \file dateZone.c
+ * Implementação do arquivo dateZone.h
+ */
+
+#include "../h_files/dateZone.h"
+#include "../h_files/dateCivil.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Distância entre duas sondagens ao procurar mudanças de deslocamento
+ */
+#define PROBE_STEP (7L * SECONDS_PER_DAY)
+
+/**
+ * Quantidade máxima de sondagens em cada sentido
+ */
+#define PROBE_STEPS 4
+
+/**
+ * Diretório padrão do banco de fusos
+ */
+#define ZONEINFO_DIR "/usr/share/zoneinfo"
+
+/**
+ * Arquivo do fuso local quando a variável TZ não está definida
+ */
+#define LOCALTIME_FILE "/etc/localtime"
+
+/**
+ * Tamanho máximo do nome de um fuso (incluindo o '\0')
+ */
+#define ZONE_NAME_SIZE 256
+
+/**
+ * Tamanho do cabeçalho de um arquivo TZif
+ */
+#define TZIF_HEADER_SIZE 44
+
+/**
+ * Maior valor aceito para cada contador de um cabeçalho TZif (os arquivos
+ * reais têm poucos milhares de transições). Com esse limite, o tamanho de
+ * um bloco de dados cabe em size_t mesmo com 32 bits
+ */
+#define TZIF_MAX_COUNT (1UL << 20)
+
+/**
+ * Menor e maior instante representáveis
+ */
+#define TIME_MIN ((time_t) LLONG_MIN)
+#define TIME_MAX ((time_t) LLONG_MAX)
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Intervalo de tempo em que o deslocamento do fuso é constante
+ */
+struct offsetWindow{
+    // início do intervalo (inclusivo)
+    time_t from;
+    // fim do intervalo (inclusivo)
+    time_t until;
+    // deslocamento em segundos em relação ao UTC
+    long offset;
+    // se o intervalo já foi calculado
+    bool valid;
+};
+
+/**
+ * Enumerador das formas de indicar o dia de uma regra POSIX
+ */
+enum RuleDateKind{
+    RULE_JULIAN, ///< Jn: 1 - 365, 29 de fevereiro nunca é contado
+    RULE_ZERO_BASED, ///< n: 0 - 365, contando 29 de fevereiro
+    RULE_MONTH_WEEK_DAY ///< Mm.w.d: dia d da semana w do mês m
+};
+
+/**
+ * Dia e hora de uma mudança de horário em uma regra POSIX
+ */
+struct ruleDate{
+    enum RuleDateKind kind;
+    int day;
+    int week;
+    int month;
+    // horário local da mudança em segundos (pode ser negativo ou > 24h)
+    long time;
+};
+
+/**
+ * Regra POSIX usada após a última transição da tabela
+ */
+struct zoneRule{
+    // se a regra existe
+    bool present;
+    // se a regra possui horário de verão
+    bool hasDst;
+    // deslocamento padrão e de verão (positivos a leste de Greenwich)
+    long stdOffset;
+    long dstOffset;
+    // início e fim do horário de verão
+    struct ruleDate start;
+    struct ruleDate end;
+};
+
+/**
+ * Estrutura do objeto fuso horário
+ */
+struct timeZone{
+    // nome com que o fuso foi carregado
+    char name[ZONE_NAME_SIZE];
+    // instantes das transições em ordem crescente
+    long long* transitions;
+    // índice do tipo em vigor a partir de cada transição
+    unsigned char* transitionTypes;
+    size_t transitionCount;
+    // deslocamento de cada tipo
+    long* typeOffsets;
+    size_t typeCount;
+    // regra após a última transição
+    struct zoneRule rule;
+};
+
+/**
+ * Contadores do cabeçalho de um arquivo TZif
+ */
+struct tzifCounts{
+    uint32_t isUtCount;
+    uint32_t isStdCount;
+    uint32_t leapCount;
+    uint32_t timeCount;
+    uint32_t typeCount;
+    uint32_t charCount;
+};
+
+/******************************************************************************
+ * Variáveis do módulo
+ ******************************************************************************/
+
+/**
+ * Último intervalo calculado pela biblioteca C para o fuso local<BR>
+ * Usado somente quando o fuso local não pode ser lido de um arquivo TZif.
+ * Cada thread tem o seu, assim as consultas não precisam de trava
+ */
+static _Thread_local struct offsetWindow localWindow;
+
+/**
+ * Fuso local carregado na primeira consulta (NULL se não foi possível)
+ */
+static TimeZone* localZone = NULL;
+
+/**
+ * Garante que o fuso local seja carregado uma única vez no processo
+ */
+static pthread_once_t localZoneOnce = PTHREAD_ONCE_INIT;
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Consulta a biblioteca C sobre o deslocamento do fuso local em um instante
+ * \return Deslocamento em segundos (0 se não conseguir)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ */
+static long probeOffset(time_t seconds){
+    struct tm tm;
+
+    if(localtime_r(&seconds, &tm) == NULL)
+        return 0;
+
+    return tm.tm_gmtoff;
+}
+
+/**
+ * Busca binária pela fronteira entre dois deslocamentos
+ * \return Último instante, a partir de same, com o deslocamento offset
+ * \param same Instante que possui o deslocamento offset
+ * \param other Instante que possui outro deslocamento
+ * \param offset Deslocamento em same
+ */
+static time_t findTransition(time_t same, time_t other, long offset){
+    // mantém probeOffset(same) == offset e probeOffset(other) != offset
+    while(same - other > 1 || other - same > 1){
+        time_t middle = same + (other - same) / 2;
+        if(probeOffset(middle) == offset)
+            same = middle;
+        else
+            other = middle;
+    }
+
+    return same;
+}
+
+/**
+ * Calcula o intervalo em torno de um instante em que o deslocamento é constante
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ * \param window Ponteiro para o intervalo a ser preenchido
+ */
+static void fillWindow(time_t seconds, struct offsetWindow* window){
+    long offset = probeOffset(seconds);
+    time_t until = seconds;
+    time_t from = seconds;
+    int step;
+
+    // avança enquanto o deslocamento não mudar
+    for(step = 0; step < PROBE_STEPS; step++){
+        time_t next = until + PROBE_STEP;
+        if(probeOffset(next) != offset){
+            until = findTransition(until, next, offset);
+            break;
+        }
+        until = next;
+    }
+
+    // recua enquanto o deslocamento não mudar
+    for(step = 0; step < PROBE_STEPS; step++){
+        time_t previous = from - PROBE_STEP;
+        if(probeOffset(previous) != offset){
+            from = findTransition(from, previous, offset);
+            break;
+        }
+        from = previous;
+    }
+
+    window->from = from;
+    window->until = until;
+    window->offset = offset;
+    window->valid = true;
+}
+
+/**
+ * Carrega o fuso local (chamada uma única vez por pthread_once())
+ */
+static void loadLocalZone(void){
+    // a sondagem pela biblioteca C, usada se a carga falhar, depende de tzset()
+    tzset();
+    localZone = loadTimeZone(NULL);
+}
+
+/**
+ * Lê um inteiro de 32 bits com sinal em big-endian
+ * \return Valor lido
+ * \param bytes Ponteiro para os 4 bytes
+ */
+static long readInt32(const unsigned char* bytes){
+    unsigned long value = ((unsigned long) bytes[0] << 24) | ((unsigned long) bytes[1] << 16)
+            | ((unsigned long) bytes[2] << 8) | bytes[3];
+    return (long) (int32_t) value;
+}
+
+/**
+ * Lê um inteiro de 32 bits sem sinal em big-endian
+ * \return Valor lido
+ * \param bytes Ponteiro para os 4 bytes
+ */
+static uint32_t readUint32(const unsigned char* bytes){
+    return ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16)
+            | ((uint32_t) bytes[2] << 8) | bytes[3];
+}
+
+/**
+ * Lê um inteiro de 64 bits com sinal em big-endian
+ * \return Valor lido
+ * \param bytes Ponteiro para os 8 bytes
+ */
+static long long readInt64(const unsigned char* bytes){
+    unsigned long long value = 0;
+    int i;
+
+    for(i = 0; i < 8; i++)
+        value = (value << 8) | bytes[i];
+
+    return (long long) value;
+}
+
+/**
+ * Lê os contadores de um cabeçalho TZif
+ * \return false se o cabeçalho não for válido
+ * \param header Ponteiro para o cabeçalho
+ * \param counts Ponteiro para os contadores a serem preenchidos
+ */
+static bool readTzifCounts(const unsigned char* header, struct tzifCounts* counts){
+    if(memcmp(header, "TZif", 4) != 0)
+        return false;
+
+    counts->isUtCount = readUint32(header + 20);
+    counts->isStdCount = readUint32(header + 24);
+    counts->leapCount = readUint32(header + 28);
+    counts->timeCount = readUint32(header + 32);
+    counts->typeCount = readUint32(header + 36);
+    counts->charCount = readUint32(header + 40);
+
+    // contadores absurdos fariam os tamanhos abaixo transbordarem
+    if(counts->isUtCount > TZIF_MAX_COUNT || counts->isStdCount > TZIF_MAX_COUNT
+            || counts->leapCount > TZIF_MAX_COUNT || counts->timeCount > TZIF_MAX_COUNT
+            || counts->charCount > TZIF_MAX_COUNT)
+        return false;
+
+    return counts->typeCount > 0 && counts->typeCount <= 256;
+}
+
+/**
+ * Calcula o tamanho do bloco de dados que segue um cabeçalho TZif
+ * \return Tamanho em bytes
+ * \param counts Contadores do cabeçalho
+ * \param timeSize Tamanho de um instante (4 na versão 1, 8 nas demais)
+ */
+static size_t tzifDataSize(const struct tzifCounts* counts, size_t timeSize){
+    // não transborda: cada contador vale no máximo TZIF_MAX_COUNT (veja
+    // readTzifCounts), o que limita o total a cerca de 2^25 bytes
+    return (size_t) counts->timeCount * timeSize + counts->timeCount
+            + (size_t) counts->typeCount * 6 + counts->charCount
+            + (size_t) counts->leapCount * (timeSize + 4)
+            + counts->isStdCount + counts->isUtCount;
+}
+
+/**
+ * Lê o nome de um fuso em uma regra POSIX ("BRT" ou "<-03>")
+ * \return Ponteiro para o primeiro caractere após o nome, ou NULL
+ * \param text Regra POSIX
+ */
+static const char* parseRuleName(const char* text){
+    const char* start = text;
+
+    if(*text == '<'){
+        while(*text != '\0' && *text != '>')
+            text++;
+        return (*text == '>') ? text + 1 : NULL;
+    }
+
+    while((*text >= 'a' && *text <= 'z') || (*text >= 'A' && *text <= 'Z'))
+        text++;
+
+    return (text - start >= 3) ? text : NULL;
+}
+
+/**
+ * Lê um número decimal sem sinal
+ * \return Ponteiro para o primeiro caractere após o número, ou NULL
+ * \param text Texto
+ * \param value Ponteiro onde será guardado o número
+ */
+static const char* parseRuleNumber(const char* text, long* value){
+    const char* start = text;
+
+    *value = 0;
+    while(*text >= '0' && *text <= '9' && text - start < 6){
+        *value = *value * 10 + (*text - '0');
+        text++;
+    }
+
+    return (text > start) ? text : NULL;
+}
+
+/**
+ * Lê um horário em uma regra POSIX ([+-]hh[:mm[:ss]])
+ * \return Ponteiro para o primeiro caractere após o horário, ou NULL
+ * \param text Texto
+ * \param seconds Ponteiro onde será guardado o horário em segundos
+ */
+static const char* parseRuleClock(const char* text, long* seconds){
+    long sign = 1;
+    long hours, minutes = 0, secs = 0;
+
+    if(*text == '+' || *text == '-'){
+        sign = (*text == '-') ? -1 : 1;
+        text++;
+    }
+
+    text = parseRuleNumber(text, &hours);
+    if(text != NULL && *text == ':'){
+        text = parseRuleNumber(text + 1, &minutes);
+        if(text != NULL && *text == ':')
+            text = parseRuleNumber(text + 1, &secs);
+    }
+
+    if(text != NULL)
+        *seconds = sign * (hours * 3600 + minutes * 60 + secs);
+
+    return text;
+}
+
+/**
+ * Lê o dia (e o horário opcional) de uma mudança em uma regra POSIX
+ * \return Ponteiro para o primeiro caractere após a data, ou NULL
+ * \param text Texto
+ * \param date Ponteiro para a data a ser preenchida
+ */
+static const char* parseRuleDate(const char* text, struct ruleDate* date){
+    long value;
+
+    if(*text == 'M'){
+        long week, day;
+        date->kind = RULE_MONTH_WEEK_DAY;
+        text = parseRuleNumber(text + 1, &value);
+        if(text == NULL || *text != '.') return NULL;
+        text = parseRuleNumber(text + 1, &week);
+        if(text == NULL || *text != '.') return NULL;
+        text = parseRuleNumber(text + 1, &day);
+        if(text == NULL || value < 1 || value > 12 || week < 1 || week > 5 || day > 6)
+            return NULL;
+        date->month = (int) value;
+        date->week = (int) week;
+        date->day = (int) day;
+    }
+    else if(*text == 'J'){
+        date->kind = RULE_JULIAN;
+        text = parseRuleNumber(text + 1, &value);
+        if(text == NULL || value < 1 || value > 365) return NULL;
+        date->day = (int) value;
+    }
+    else{
+        date->kind = RULE_ZERO_BASED;
+        text = parseRuleNumber(text, &value);
+        if(text == NULL || value > 365) return NULL;
+        date->day = (int) value;
+    }
+
+    // horário padrão da mudança: 02:00:00
+    date->time = 7200;
+    if(*text == '/')
+        text = parseRuleClock(text + 1, &date->time);
+
+    return text;
+}
+
+/**
+ * Interpreta uma regra POSIX (formato da variável TZ)
+ * \return false se a regra não for válida
+ * \param text Regra POSIX
+ * \param rule Ponteiro para a regra a ser preenchida
+ */
+static bool parseZoneRule(const char* text, struct zoneRule* rule){
+    long offset;
+
+    memset(rule, 0, sizeof(struct zoneRule));
+
+    text = parseRuleName(text);
+    if(text == NULL) return false;
+    text = parseRuleClock(text, &offset);
+    if(text == NULL) return false;
+
+    // no formato POSIX o deslocamento é positivo a oeste de Greenwich
+    rule->stdOffset = -offset;
+    rule->dstOffset = rule->stdOffset;
+    rule->present = true;
+
+    if(*text == '\0')
+        return true;
+
+    text = parseRuleName(text);
+    if(text == NULL) return false;
+
+    rule->hasDst = true;
+    rule->dstOffset = rule->stdOffset + 3600;
+    if(*text != '\0' && *text != ','){
+        text = parseRuleClock(text, &offset);
+        if(text == NULL) return false;
+        rule->dstOffset = -offset;
+    }
+
+    // sem datas de mudança, usa as regras atuais dos Estados Unidos
+    if(*text == '\0')
+        text = ",M3.2.0,M11.1.0";
+
+    if(*text != ',') return false;
+    text = parseRuleDate(text + 1, &rule->start);
+    if(text == NULL || *text != ',') return false;
+    text = parseRuleDate(text + 1, &rule->end);
+
+    return text != NULL && *text == '\0';
+}
+
+/**
+ * Calcula o horário local de uma mudança de uma regra POSIX em um ano
+ * \return Segundos locais desde 1/1/1970 00:00:00
+ * \param date Data da mudança
+ * \param year Ano
+ */
+static long long ruleDateToLocal(const struct ruleDate* date, int year){
+    long long days;
+
+    switch(date->kind){
+    case RULE_JULIAN:
+        // 29 de fevereiro nunca é contado
+        days = daysFromCivil(year, 1, 1) + date->day - 1
+                + (isLeapYear(year) && date->day >= 60);
+        break;
+    case RULE_ZERO_BASED:
+        days = daysFromCivil(year, 1, 1) + date->day;
+        break;
+    default:{
+        long long first = daysFromCivil(year, date->month, 1);
+        int lastDay = daysInMonth(year, date->month);
+        int delta = (date->day - weekDayFromDays(first) + 7) % 7;
+        int mday = 1 + delta + (date->week - 1) * 7;
+        // semana 5 significa a última ocorrência do dia no mês
+        while(mday > lastDay)
+            mday -= 7;
+        days = first + mday - 1;
+    }
+    }
+
+    return days * SECONDS_PER_DAY + date->time;
+}
+
+/**
+ * Calcula o deslocamento de uma regra POSIX e o intervalo em que ele vale
+ * \return Deslocamento em segundos
+ * \param rule Regra POSIX
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ * \param from Ponteiro onde será guardado o início do intervalo
+ * \param until Ponteiro onde será guardado o fim do intervalo
+ */
+static long ruleOffsetWindow(const struct zoneRule* rule, time_t seconds,
+        time_t* from, time_t* until){
+    long long instants[6];
+    long offsets[6];
+    int count = 0;
+    int year, month, day;
+    int i, j;
+
+    if(!rule->hasDst){
+        *from = TIME_MIN;
+        *until = TIME_MAX;
+        return rule->stdOffset;
+    }
+
+    civilFromDays((long long) seconds / SECONDS_PER_DAY, &year, &month, &day);
+
+    // mudanças do ano anterior, do atual e do seguinte, em UTC
+    for(i = year - 1; i <= year + 1; i++){
+        instants[count] = ruleDateToLocal(&rule->start, i) - rule->stdOffset;
+        offsets[count++] = rule->dstOffset;
+        instants[count] = ruleDateToLocal(&rule->end, i) - rule->dstOffset;
+        offsets[count++] = rule->stdOffset;
+    }
+
+    // ordena as mudanças (inserção, são só seis)
+    for(i = 1; i < count; i++){
+        for(j = i; j > 0 && instants[j - 1] > instants[j]; j--){
+            long long instant = instants[j];
+            long offset = offsets[j];
+            instants[j] = instants[j - 1];
+            offsets[j] = offsets[j - 1];
+            instants[j - 1] = instant;
+            offsets[j - 1] = offset;
+        }
+    }
+
+    // última mudança até o instante procurado
+    for(i = count - 1; i > 0 && instants[i] > seconds; i--)
+        ;
+
+    if(instants[i] > seconds){
+        // antes de todas as mudanças calculadas: vale o contrário da primeira
+        *from = TIME_MIN;
+        *until = (time_t) instants[0] - 1;
+        return (offsets[0] == rule->dstOffset) ? rule->stdOffset : rule->dstOffset;
+    }
+
+    *from = (time_t) instants[i];
+    *until = (i + 1 < count) ? (time_t) instants[i + 1] - 1 : TIME_MAX;
+    return offsets[i];
+}
+
+/**
+ * Calcula o deslocamento de um fuso carregado e o intervalo em que ele vale
+ * \return Deslocamento em segundos
+ * \param zone Fuso horário
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ * \param from Ponteiro onde será guardado o início do intervalo
+ * \param until Ponteiro onde será guardado o fim do intervalo
+ */
+static long zoneOffsetWindow(const TimeZone* zone, time_t seconds,
+        time_t* from, time_t* until){
+    size_t count = zone->transitionCount;
+    size_t low, high;
+
+    // antes da primeira transição vale o primeiro tipo
+    if(count > 0 && seconds < zone->transitions[0]){
+        *from = TIME_MIN;
+        *until = (time_t) zone->transitions[0] - 1;
+        return zone->typeOffsets[0];
+    }
+
+    // depois da última transição vale a regra POSIX, se houver
+    if(count == 0 || seconds >= zone->transitions[count - 1]){
+        time_t last = (count > 0) ? (time_t) zone->transitions[count - 1] : TIME_MIN;
+        long offset;
+
+        if(zone->rule.present){
+            offset = ruleOffsetWindow(&zone->rule, seconds, from, until);
+            if(*from < last)
+                *from = last;
+            return offset;
+        }
+
+        *from = last;
+        *until = TIME_MAX;
+        return zone->typeOffsets[(count > 0) ? zone->transitionTypes[count - 1] : 0];
+    }
+
+    // busca binária pela última transição até o instante
+    low = 0;
+    high = count - 1;
+    while(high - low > 1){
+        size_t middle = low + (high - low) / 2;
+        if(zone->transitions[middle] <= seconds)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    *from = (time_t) zone->transitions[low];
+    *until = (time_t) zone->transitions[low + 1] - 1;
+    return zone->typeOffsets[zone->transitionTypes[low]];
+}
+
+/**
+ * Monta um fuso a partir do conteúdo de um arquivo TZif
+ * \return false se o conteúdo não for válido
+ * \param data Conteúdo do arquivo
+ * \param size Tamanho do conteúdo
+ * \param zone Fuso a ser preenchido
+ */
+static bool parseTzif(const unsigned char* data, size_t size, TimeZone* zone){
+    struct tzifCounts counts;
+    const unsigned char* block;
+    const unsigned char* end = data + size;
+    size_t timeSize = 4;
+    size_t i;
+
+    if(size < TZIF_HEADER_SIZE || !readTzifCounts(data, &counts))
+        return false;
+
+    block = data + TZIF_HEADER_SIZE;
+
+    // a partir da versão 2 usa o segundo bloco, com instantes de 64 bits;
+    // os tamanhos são comparados com o que resta antes de mover o ponteiro
+    if(data[4] >= '2'){
+        size_t skip = tzifDataSize(&counts, 4);
+        if(skip > (size_t) (end - block) || (size_t) (end - block) - skip < TZIF_HEADER_SIZE)
+            return false;
+        block += skip;
+        if(!readTzifCounts(block, &counts))
+            return false;
+        block += TZIF_HEADER_SIZE;
+        timeSize = 8;
+    }
+
+    if(tzifDataSize(&counts, timeSize) > (size_t) (end - block))
+        return false;
+
+    zone->transitionCount = counts.timeCount;
+    zone->typeCount = counts.typeCount;
+    zone->transitions = malloc(((size_t) counts.timeCount + 1) * sizeof(long long));
+    zone->transitionTypes = malloc((size_t) counts.timeCount + 1);
+    zone->typeOffsets = malloc((size_t) counts.typeCount * sizeof(long));
+    if(zone->transitions == NULL || zone->transitionTypes == NULL || zone->typeOffsets == NULL)
+        return false;
+
+    // instantes das transições
+    for(i = 0; i < counts.timeCount; i++){
+        zone->transitions[i] = (timeSize == 8) ? readInt64(block + i * 8)
+                : (long long) readInt32(block + i * 4);
+    }
+    block += counts.timeCount * timeSize;
+
+    // tipo em vigor após cada transição
+    for(i = 0; i < counts.timeCount; i++){
+        if(block[i] >= counts.typeCount)
+            return false;
+        zone->transitionTypes[i] = block[i];
+    }
+    block += counts.timeCount;
+
+    // deslocamento de cada tipo (os outros campos de ttinfo não são usados)
+    for(i = 0; i < counts.typeCount; i++)
+        zone->typeOffsets[i] = readInt32(block + i * 6);
+    block += counts.typeCount * 6;
+
+    // regra POSIX no rodapé ("\n<regra>\n"), a partir da versão 2
+    block += counts.charCount + (size_t) counts.leapCount * (timeSize + 4)
+            + counts.isStdCount + counts.isUtCount;
+    if(timeSize == 8 && block < end && *block == '\n'){
+        char footer[ZONE_NAME_SIZE];
+        size_t length = 0;
+        block++;
+        while(block + length < end && block[length] != '\n' && length < ZONE_NAME_SIZE - 1)
+            length++;
+        memcpy(footer, block, length);
+        footer[length] = '\0';
+        if(length > 0 && !parseZoneRule(footer, &zone->rule))
+            memset(&zone->rule, 0, sizeof(struct zoneRule));
+    }
+
+    return true;
+}
+
+/**
+ * Carrega um arquivo TZif, mapeando-o em memória durante a leitura
+ * \return false se não conseguir
+ * \param path Caminho do arquivo
+ * \param zone Fuso a ser preenchido
+ */
+static bool loadTzifFile(const char* path, TimeZone* zone){
+    struct stat status;
+    void* data;
+    bool loaded;
+    int file = open(path, O_RDONLY | O_CLOEXEC);
+
+    if(file < 0)
+        return false;
+
+    if(fstat(file, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0){
+        close(file);
+        return false;
+    }
+
+    data = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if(data == MAP_FAILED)
+        return false;
+
+    loaded = parseTzif(data, (size_t) status.st_size, zone);
+    munmap(data, (size_t) status.st_size);
+
+    return loaded;
+}
+
+/**
+ * Monta o caminho do arquivo TZif de um fuso
+ * \return false se o nome não puder ser usado como caminho
+ * \param name Nome do fuso
+ * \param path Vetor onde o caminho será guardado
+ * \param size Tamanho do vetor
+ */
+static bool buildZonePath(const char* name, char* path, size_t size){
+    const char* directory = getenv("TZDIR");
+    int length;
+
+    if(name[0] == '/')
+        length = snprintf(path, size, "%s", name);
+    else{
+        // impede que o nome saia do diretório do banco
+        if(strstr(name, "..") != NULL)
+            return false;
+        if(directory == NULL || directory[0] == '\0')
+            directory = ZONEINFO_DIR;
+        length = snprintf(path, size, "%s/%s", directory, name);
+    }
+
+    return length > 0 && (size_t) length < size;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Carrega um fuso horário<BR>
+ * O nome pode ser um identificador do banco de fusos ("America/Sao_Paulo"),
+ * o caminho absoluto de um arquivo TZif ou uma regra POSIX ("EST5EDT",
+ * "<-03>3"). Se o nome for NULL, carrega o fuso local (variável TZ ou
+ * /etc/localtime). O diretório do banco pode ser trocado pela variável TZDIR
+ * \return Ponteiro para objeto TimeZone, ou NULL se não conseguir
+ * \param name Nome do fuso
+ */
+TimeZone* loadTimeZone(const char* name){
+    char path[ZONE_NAME_SIZE * 2];
+    bool loaded = false;
+    TimeZone* zone;
+
+    // fuso local: mesma convenção da biblioteca C
+    if(name == NULL){
+        name = getenv("TZ");
+        if(name == NULL)
+            name = LOCALTIME_FILE;
+        else if(name[0] == '\0')
+            name = "UTC0";
+        else if(name[0] == ':')
+            name++;
+    }
+
+    if(strlen(name) >= ZONE_NAME_SIZE)
+        return NULL;
+
+    zone = calloc(1, sizeof(TimeZone));
+    if(zone == NULL)
+        return NULL;
+    strcpy(zone->name, name);
+
+    if(buildZonePath(name, path, sizeof(path)))
+        loaded = loadTzifFile(path, zone);
+
+    // se não houver arquivo, tenta interpretar o nome como regra POSIX
+    if(!loaded){
+        free(zone->transitions);
+        free(zone->transitionTypes);
+        free(zone->typeOffsets);
+        memset(zone, 0, sizeof(TimeZone));
+        strcpy(zone->name, name);
+
+        zone->typeOffsets = malloc(sizeof(long));
+        if(zone->typeOffsets == NULL || !parseZoneRule(name, &zone->rule))
+            return destroyTimeZone(zone);
+        zone->typeOffsets[0] = zone->rule.stdOffset;
+        zone->typeCount = 1;
+    }
+
+    return zone;
+}
+
+/**
+ * Desaloca objeto TimeZone
+ * \return NULL
+ * \param zone Ponteiro para objeto TimeZone a ser desalocado
+ */
+TimeZone* destroyTimeZone(TimeZone* zone){
+    if(zone != NULL){
+        free(zone->transitions);
+        free(zone->transitionTypes);
+        free(zone->typeOffsets);
+        free(zone);
+    }
+    return NULL;
+}
+
+/**
+ * Retorna o nome com que o fuso foi carregado
+ * \return Nome do fuso
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ */
+const char* getTimeZoneName(const TimeZone* zone){
+    if(zone == NULL){
+        pthread_once(&localZoneOnce, loadLocalZone);
+        zone = localZone;
+    }
+
+    return (zone != NULL) ? zone->name : "localtime";
+}
+
+/**
+ * Retorna o deslocamento de um fuso em relação ao UTC em um instante
+ * \return Deslocamento em segundos (positivo a leste de Greenwich)
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ */
+long getZoneUtcOffset(const TimeZone* zone, time_t seconds){
+    return getZoneUtcOffsetWindow(zone, seconds, NULL, NULL);
+}
+
+/**
+ * Retorna o deslocamento de um fuso e o intervalo em que ele é válido
+ * \return Deslocamento em segundos (positivo a leste de Greenwich)
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ * \param validFrom Ponteiro onde será guardado o início do intervalo
+ *      (inclusivo). Pode ser NULL
+ * \param validUntil Ponteiro onde será guardado o fim do intervalo
+ *      (inclusivo). Pode ser NULL
+ */
+long getZoneUtcOffsetWindow(const TimeZone* zone, time_t seconds,
+        time_t* validFrom, time_t* validUntil){
+    time_t from, until;
+    long offset;
+
+    if(zone == NULL){
+        pthread_once(&localZoneOnce, loadLocalZone);
+        zone = localZone;
+    }
+
+    if(zone != NULL)
+        offset = zoneOffsetWindow(zone, seconds, &from, &until);
+    else{
+        // sem arquivo do fuso local: consulta a biblioteca C só quando sair do
+        // intervalo conhecido
+        if(!localWindow.valid || seconds < localWindow.from || seconds > localWindow.until)
+            fillWindow(seconds, &localWindow);
+        from = localWindow.from;
+        until = localWindow.until;
+        offset = localWindow.offset;
+    }
+
+    if(validFrom != NULL)
+        *validFrom = from;
+    if(validUntil != NULL)
+        *validUntil = until;
+
+    return offset;
+}
+
+/**
+ * Converte segundos do relógio de um fuso em segundos desde 1/1/1970 UTC<BR>
+ * Horários inexistentes ou ambíguos (mudança de horário de verão) são
+ * resolvidos com um dos deslocamentos vizinhos à mudança, como em mktime()
+ * \return Segundos desde 1/1/1970 UTC
+ * \param zone Ponteiro para objeto TimeZone (NULL para o fuso local)
+ * \param localSeconds Segundos desde 1/1/1970 00:00:00 no relógio do fuso
+ */
+time_t zoneLocalSecondsToTime(const TimeZone* zone, long long localSeconds){
+    // primeira aproximação usa o deslocamento do próprio valor local
+    time_t guess = (time_t) (localSeconds - getZoneUtcOffset(zone, (time_t) localSeconds));
+    long offset = getZoneUtcOffset(zone, guess);
+    time_t seconds = (time_t) (localSeconds - offset);
+
+    // se a correção caiu em outro deslocamento, usa o deste novo instante
+    if(getZoneUtcOffset(zone, seconds) != offset)
+        seconds = (time_t) (localSeconds - getZoneUtcOffset(zone, seconds));
+
+    return seconds;
+}
+
+/**
+ * Retorna o deslocamento do fuso local em relação ao UTC em um instante
+ * \return Deslocamento em segundos (positivo a leste de Greenwich)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ */
+long getUtcOffset(time_t seconds){
+    return getZoneUtcOffsetWindow(NULL, seconds, NULL, NULL);
+}
+
+/**
+ * Retorna o deslocamento do fuso local e o intervalo em que ele é válido
+ * \return Deslocamento em segundos (positivo a leste de Greenwich)
+ * \param seconds Instante em segundos desde 1/1/1970 UTC
+ * \param validFrom Ponteiro onde será guardado o início do intervalo
+ *      (inclusivo). Pode ser NULL
+ * \param validUntil Ponteiro onde será guardado o fim do intervalo
+ *      (inclusivo). Pode ser NULL
+ */
+long getUtcOffsetWindow(time_t seconds, time_t* validFrom, time_t* validUntil){
+    return getZoneUtcOffsetWindow(NULL, seconds, validFrom, validUntil);
+}
+
+/**
+ * Converte segundos do relógio local em segundos desde 1/1/1970 UTC<BR>
+ * Horários inexistentes ou ambíguos (mudança de horário de verão) são
+ * resolvidos com um dos deslocamentos vizinhos à mudança, como em mktime()
+ * \return Segundos desde 1/1/1970 UTC
+ * \param localSeconds Segundos desde 1/1/1970 00:00:00 no relógio local
+ */
+time_t localSecondsToTime(long long localSeconds){
+    return zoneLocalSecondsToTime(NULL, localSeconds);
+}
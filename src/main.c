@@ -0,0 +1,669 @@
+/**
+ * \file main.c
+ * Conversor de datas em arquivos de texto<BR>
+ * Lê um arquivo mapeado em memória, divide-o em blocos de linhas entre
+ * várias threads, converte a data de uma coluna para outro formato e escreve
+ * o resultado na ordem original, em blocos grandes
+ */
+
+#include "../h_files/date.h"
+#include "../h_files/dateFormat.h"
+#include "../h_files/dateParse.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Tamanho aproximado de cada bloco de linhas do arquivo de entrada
+ */
+#define CHUNK_SIZE (8u << 20)
+
+/**
+ * Quantos blocos cada thread pode ter convertidos e ainda não escritos
+ */
+#define CHUNKS_AHEAD_PER_THREAD 2
+
+/**
+ * Quantidade máxima de threads
+ */
+#define MAX_THREADS 256
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Formatos aceitos na entrada e na saída
+ */
+enum ConverterFormat{
+    FORMAT_DATE_STRING, ///< um dos formatos de enum DateString
+    FORMAT_ISO, ///< ISO-8601 (somente entrada)
+    FORMAT_EPOCH ///< segundos desde 1970
+};
+
+/**
+ * Formato de uma coluna
+ */
+struct columnFormat{
+    enum ConverterFormat kind;
+    // usado quando kind é FORMAT_DATE_STRING
+    enum DateString dateString;
+};
+
+/**
+ * Opções da linha de comando
+ */
+struct options{
+    const char* input;
+    const char* output;
+    // coluna da data (começando em 1)
+    size_t column;
+    char delimiter;
+    struct columnFormat from;
+    struct columnFormat to;
+    bool weekDayName;
+    size_t threads;
+    const TimeZone* zone;
+};
+
+/**
+ * Bloco de linhas do arquivo de entrada e o seu resultado
+ */
+struct chunk{
+    const char* begin;
+    const char* end;
+    char* output;
+    size_t outputLength;
+    bool done;
+    bool failed;
+};
+
+/**
+ * Estado compartilhado entre as threads de conversão e a de escrita
+ */
+struct job{
+    const struct options* options;
+    struct chunk* chunks;
+    size_t chunkCount;
+    // próximo bloco a ser convertido
+    size_t nextChunk;
+    // blocos já escritos
+    size_t writtenChunks;
+    // limite de blocos convertidos e não escritos
+    size_t window;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+/**
+ * Texto de saída que cresce conforme necessário
+ */
+struct outputBuffer{
+    char* data;
+    size_t length;
+    size_t capacity;
+};
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Imprime o modo de uso do programa
+ * \param program Nome do programa
+ */
+static void printUsage(const char* program){
+    fprintf(stderr,
+        "uso: %s -i entrada [-o saida] [-c coluna] [-d delimitador]\n"
+        "        [-f formato_entrada] [-t formato_saida] [-j threads] [-z fuso] [-w]\n"
+        "\n"
+        "  -i  arquivo de entrada (obrigatório, é mapeado em memória)\n"
+        "  -o  arquivo de saída (padrão: saída padrão; não pode ser o arquivo de entrada)\n"
+        "  -c  coluna com a data, começando em 1 (padrão: 1)\n"
+        "  -d  delimitador das colunas (padrão: ',')\n"
+        "  -f  formato de entrada (padrão: iso)\n"
+        "  -t  formato de saída (padrão: epoch)\n"
+        "  -j  quantidade de threads (padrão: número de processadores)\n"
+        "  -z  fuso horário das datas (padrão: fuso local)\n"
+        "  -w  acrescenta o nome do dia da semana na saída\n"
+        "\n"
+        "formatos: iso (somente entrada), epoch, dmy, ymd, hms, hms_ampm,\n"
+        "          dmy_hms, ymd_hms, dmy_hms_ampm, ymd_hms_ampm\n"
+        "          (hms e hms_ampm na entrada só convertem para hms, hms_ampm ou epoch,\n"
+        "          que então conta os segundos desde a meia-noite)\n",
+        program);
+}
+
+/**
+ * Interpreta o nome de um formato
+ * \return false se o nome não for conhecido
+ * \param name Nome do formato
+ * \param format Formato a ser preenchido
+ */
+static bool parseFormatName(const char* name, struct columnFormat* format){
+    static const char* const names[] = {"dmy", "ymd", "hms", "hms_ampm", "dmy_hms",
+        "ymd_hms", "dmy_hms_ampm", "ymd_hms_ampm"};
+    static const enum DateString layouts[] = {DATE_DMY, DATE_YMD, DATE_HMS,
+        DATE_HMS_AMPM, DATE_DMY_HMS, DATE_YMD_HMS, DATE_DMY_HMS_AMPM, DATE_YMD_HMS_AMPM};
+    size_t i;
+
+    if(strcmp(name, "iso") == 0){
+        format->kind = FORMAT_ISO;
+        return true;
+    }
+    if(strcmp(name, "epoch") == 0){
+        format->kind = FORMAT_EPOCH;
+        return true;
+    }
+
+    for(i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++){
+        if(strcmp(name, names[i]) == 0){
+            format->kind = FORMAT_DATE_STRING;
+            format->dateString = layouts[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Informa se um formato contém apenas o horário, sem a data
+ * \return true se o formato for hms ou hms_ampm
+ * \param format Formato
+ */
+static bool isTimeOfDay(const struct columnFormat* format){
+    return format->kind == FORMAT_DATE_STRING
+            && (format->dateString == DATE_HMS || format->dateString == DATE_HMS_AMPM);
+}
+
+/**
+ * Garante espaço livre no texto de saída
+ * \return false se não conseguir alocar memória
+ * \param buffer Texto de saída
+ * \param extra Quantidade de bytes que serão acrescentados
+ */
+static bool reserveOutput(struct outputBuffer* buffer, size_t extra){
+    if(buffer->length + extra > buffer->capacity){
+        size_t capacity = buffer->capacity * 2 + extra;
+        char* data = realloc(buffer->data, capacity);
+        if(data == NULL)
+            return false;
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    return true;
+}
+
+/**
+ * Lê segundos desde 1970 ([-]dígitos)
+ * \return false se o texto não for um número
+ * \param text Texto
+ * \param length Tamanho do texto
+ * \param seconds Ponteiro onde serão guardados os segundos
+ */
+static bool parseEpoch(const char* text, size_t length, time_t* seconds){
+    bool negative = length > 0 && text[0] == '-';
+    long long value = 0;
+    size_t i = negative;
+
+    if(i >= length || length - i > 18)
+        return false;
+
+    for(; i < length; i++){
+        if(text[i] < '0' || text[i] > '9')
+            return false;
+        value = value * 10 + (text[i] - '0');
+    }
+
+    *seconds = (time_t) (negative ? -value : value);
+    return true;
+}
+
+/**
+ * Escreve segundos desde 1970 em decimal
+ * \return Quantidade de caracteres escritos
+ * \param out Memória onde o número será escrito (pelo menos 21 bytes)
+ * \param seconds Segundos
+ */
+static size_t writeEpoch(char* out, time_t seconds){
+    char digits[24];
+    size_t count = 0;
+    size_t length = 0;
+    unsigned long long magnitude = (seconds < 0) ? 0ull - (unsigned long long) seconds
+            : (unsigned long long) seconds;
+
+    do{
+        digits[count++] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    }while(magnitude > 0);
+
+    if(seconds < 0)
+        out[length++] = '-';
+    while(count > 0)
+        out[length++] = digits[--count];
+
+    return length;
+}
+
+/**
+ * Converte o campo de data de uma linha
+ * \return Quantidade de caracteres escritos em out, ou 0 se o campo não
+ *      puder ser convertido
+ * \param options Opções da linha de comando
+ * \param field Campo com a data
+ * \param length Tamanho do campo
+ * \param out Memória onde o campo convertido será escrito
+ */
+static size_t convertField(const struct options* options, const char* field,
+        size_t length, char* out){
+    time_t seconds;
+    bool parsed;
+
+    switch(options->from.kind){
+    case FORMAT_ISO:
+        parsed = parseIsoDate(field, length, options->zone, &seconds);
+        break;
+    case FORMAT_EPOCH:
+        parsed = parseEpoch(field, length, &seconds);
+        break;
+    default:
+        parsed = parseDateString(field, length, options->from.dateString,
+                options->zone, &seconds);
+    }
+
+    if(!parsed)
+        return 0;
+
+    if(options->to.kind == FORMAT_EPOCH)
+        return writeEpoch(out, seconds);
+    else{
+        CivilTime civil;
+        // um horário sem data já vem em segundos desde a meia-noite local
+        long long offset = isTimeOfDay(&options->from) ? 0
+                : getZoneUtcOffset(options->zone, seconds);
+        civilTimeFromSeconds((long long) seconds + offset, &civil);
+        return formatCivilTime(&civil, options->to.dateString, options->weekDayName,
+                out, DATE_STRING_SIZE);
+    }
+}
+
+/**
+ * Converte todas as linhas de um bloco
+ * \param options Opções da linha de comando
+ * \param chunk Bloco a ser convertido
+ */
+static void convertChunk(const struct options* options, struct chunk* chunk){
+    struct outputBuffer buffer = {NULL, 0, 0};
+    const char* line = chunk->begin;
+
+    // a saída costuma ter o tamanho da entrada
+    if(!reserveOutput(&buffer, (size_t) (chunk->end - chunk->begin) + DATE_STRING_SIZE * 2)){
+        chunk->failed = true;
+        return;
+    }
+
+    while(line < chunk->end){
+        const char* lineEnd = memchr(line, '\n', (size_t) (chunk->end - line));
+        const char* fieldBegin = line;
+        const char* fieldEnd;
+        size_t column = 1;
+        size_t converted = 0;
+        char field[DATE_STRING_SIZE * 2];
+
+        if(lineEnd == NULL)
+            lineEnd = chunk->end;
+
+        // procura o início da coluna
+        while(column < options->column){
+            const char* next = memchr(fieldBegin, options->delimiter, (size_t) (lineEnd - fieldBegin));
+            if(next == NULL)
+                break;
+            fieldBegin = next + 1;
+            column++;
+        }
+
+        fieldEnd = memchr(fieldBegin, options->delimiter, (size_t) (lineEnd - fieldBegin));
+        if(fieldEnd == NULL){
+            fieldEnd = lineEnd;
+            // ignora o '\r' de finais de linha no padrão Windows
+            if(fieldEnd > fieldBegin && fieldEnd[-1] == '\r')
+                fieldEnd--;
+        }
+
+        if(column == options->column)
+            converted = convertField(options, fieldBegin, (size_t) (fieldEnd - fieldBegin), field);
+
+        if(!reserveOutput(&buffer, (size_t) (lineEnd - line) + sizeof(field) + 1)){
+            chunk->failed = true;
+            break;
+        }
+
+        // linhas que não puderam ser convertidas são copiadas sem mudança
+        if(converted > 0){
+            memcpy(buffer.data + buffer.length, line, (size_t) (fieldBegin - line));
+            buffer.length += (size_t) (fieldBegin - line);
+            memcpy(buffer.data + buffer.length, field, converted);
+            buffer.length += converted;
+            memcpy(buffer.data + buffer.length, fieldEnd, (size_t) (lineEnd - fieldEnd));
+            buffer.length += (size_t) (lineEnd - fieldEnd);
+        }
+        else{
+            memcpy(buffer.data + buffer.length, line, (size_t) (lineEnd - line));
+            buffer.length += (size_t) (lineEnd - line);
+        }
+
+        if(lineEnd < chunk->end)
+            buffer.data[buffer.length++] = '\n';
+
+        line = lineEnd + 1;
+    }
+
+    chunk->output = buffer.data;
+    chunk->outputLength = buffer.length;
+}
+
+/**
+ * Thread de conversão: pega blocos em ordem até acabarem
+ * \return NULL
+ * \param argument Ponteiro para o estado compartilhado (struct job)
+ */
+static void* convertWorker(void* argument){
+    struct job* job = argument;
+
+    for(;;){
+        size_t index;
+
+        pthread_mutex_lock(&job->lock);
+        // não se adianta demais em relação à escrita, para limitar a memória
+        while(job->nextChunk < job->chunkCount
+                && job->nextChunk >= job->writtenChunks + job->window)
+            pthread_cond_wait(&job->changed, &job->lock);
+        if(job->nextChunk >= job->chunkCount){
+            pthread_mutex_unlock(&job->lock);
+            break;
+        }
+        index = job->nextChunk++;
+        pthread_mutex_unlock(&job->lock);
+
+        convertChunk(job->options, &job->chunks[index]);
+
+        pthread_mutex_lock(&job->lock);
+        job->chunks[index].done = true;
+        pthread_cond_broadcast(&job->changed);
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * Escreve todo o conteúdo em um descritor de arquivo
+ * \return false se houver erro de escrita
+ * \param file Descritor de arquivo
+ * \param data Conteúdo
+ * \param length Tamanho do conteúdo
+ */
+static bool writeAll(int file, const char* data, size_t length){
+    while(length > 0){
+        ssize_t written = write(file, data, length);
+        if(written < 0){
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+        data += written;
+        length -= (size_t) written;
+    }
+    return true;
+}
+
+/**
+ * Divide o arquivo em blocos que terminam em fim de linha
+ * \return Quantidade de blocos (0 se não conseguir alocar memória)
+ * \param data Conteúdo do arquivo
+ * \param size Tamanho do arquivo
+ * \param chunks Ponteiro onde será guardado o vetor de blocos
+ */
+static size_t splitChunks(const char* data, size_t size, struct chunk** chunks){
+    size_t capacity = size / CHUNK_SIZE + 1;
+    size_t count = 0;
+    const char* begin = data;
+    const char* end = data + size;
+
+    *chunks = calloc(capacity, sizeof(struct chunk));
+    if(*chunks == NULL)
+        return 0;
+
+    while(begin < end){
+        const char* limit = (size_t) (end - begin) > CHUNK_SIZE ? begin + CHUNK_SIZE : end;
+        const char* lineEnd = (limit < end) ? memchr(limit, '\n', (size_t) (end - limit)) : NULL;
+        const char* chunkEnd = (lineEnd != NULL) ? lineEnd + 1 : end;
+
+        (*chunks)[count].begin = begin;
+        (*chunks)[count].end = chunkEnd;
+        count++;
+        begin = chunkEnd;
+    }
+
+    return count;
+}
+
+/**
+ * Converte o arquivo de entrada e escreve o resultado
+ * \return Código de saída do programa
+ * \param options Opções da linha de comando
+ * \param data Conteúdo do arquivo de entrada
+ * \param size Tamanho do arquivo de entrada
+ * \param output Descritor do arquivo de saída
+ */
+static int convertFile(const struct options* options, const char* data, size_t size,
+        int output){
+    pthread_t threads[MAX_THREADS];
+    struct job job;
+    size_t started = 0;
+    size_t i;
+    int status = EXIT_SUCCESS;
+
+    memset(&job, 0, sizeof(job));
+    job.options = options;
+    job.window = options->threads * CHUNKS_AHEAD_PER_THREAD;
+    job.chunkCount = splitChunks(data, size, &job.chunks);
+    if(job.chunks == NULL){
+        fprintf(stderr, "erro: memória insuficiente\n");
+        return EXIT_FAILURE;
+    }
+
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.changed, NULL);
+
+    for(i = 0; i < options->threads && i < job.chunkCount; i++){
+        if(pthread_create(&threads[i], NULL, convertWorker, &job) != 0)
+            break;
+        started++;
+    }
+
+    // sem threads, converte tudo na própria thread de escrita
+    if(started == 0){
+        job.window = job.chunkCount;
+        convertWorker(&job);
+    }
+
+    // escreve os blocos na ordem original assim que ficarem prontos
+    for(i = 0; i < job.chunkCount; i++){
+        struct chunk* chunk = &job.chunks[i];
+
+        pthread_mutex_lock(&job.lock);
+        while(!chunk->done)
+            pthread_cond_wait(&job.changed, &job.lock);
+        pthread_mutex_unlock(&job.lock);
+
+        if(status == EXIT_SUCCESS && (chunk->failed
+                || !writeAll(output, chunk->output, chunk->outputLength))){
+            fprintf(stderr, "erro: %s\n", chunk->failed ? "memória insuficiente"
+                    : strerror(errno));
+            status = EXIT_FAILURE;
+        }
+        free(chunk->output);
+        chunk->output = NULL;
+
+        pthread_mutex_lock(&job.lock);
+        job.writtenChunks++;
+        pthread_cond_broadcast(&job.changed);
+        pthread_mutex_unlock(&job.lock);
+    }
+
+    for(i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    pthread_cond_destroy(&job.changed);
+    pthread_mutex_destroy(&job.lock);
+    free(job.chunks);
+
+    return status;
+}
+
+/****************************************************************************
+ * Função principal
+ ****************************************************************************/
+
+/**
+ * Função principal
+ * \return Código de saída do programa
+ * \param argc Quantidade de argumentos
+ * \param argv Argumentos
+ */
+int main(int argc, char** argv){
+    struct options options;
+    TimeZone* zone = NULL;
+    struct stat status;
+    struct stat outputStatus;
+    const char* data = NULL;
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int input, output = STDOUT_FILENO;
+    int option;
+    int result;
+
+    memset(&options, 0, sizeof(options));
+    options.column = 1;
+    options.delimiter = ',';
+    options.from.kind = FORMAT_ISO;
+    options.to.kind = FORMAT_EPOCH;
+    options.threads = (processors > 0) ? (size_t) processors : 1;
+
+    while((option = getopt(argc, argv, "i:o:c:d:f:t:j:z:wh")) != -1){
+        switch(option){
+        case 'i':
+            options.input = optarg;
+            break;
+        case 'o':
+            options.output = optarg;
+            break;
+        case 'c':
+            options.column = (size_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'd':
+            options.delimiter = (strcmp(optarg, "\\t") == 0) ? '\t' : optarg[0];
+            break;
+        case 'f':
+            if(!parseFormatName(optarg, &options.from)){
+                fprintf(stderr, "erro: formato desconhecido '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 't':
+            if(!parseFormatName(optarg, &options.to) || options.to.kind == FORMAT_ISO){
+                fprintf(stderr, "erro: formato de saída inválido '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'j':
+            options.threads = (size_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'z':
+            zone = loadTimeZone(optarg);
+            if(zone == NULL){
+                fprintf(stderr, "erro: fuso desconhecido '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'w':
+            options.weekDayName = true;
+            break;
+        default:
+            printUsage(argv[0]);
+            return (option == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if(options.input == NULL || options.column == 0 || options.delimiter == '\0'
+            || options.delimiter == '\n'){
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if(isTimeOfDay(&options.from) && options.to.kind == FORMAT_DATE_STRING
+            && !isTimeOfDay(&options.to)){
+        fprintf(stderr, "erro: um horário sem data só converte para hms, hms_ampm ou epoch\n");
+        return EXIT_FAILURE;
+    }
+    if(options.threads == 0)
+        options.threads = 1;
+    if(options.threads > MAX_THREADS)
+        options.threads = MAX_THREADS;
+    options.zone = zone;
+
+    input = open(options.input, O_RDONLY);
+    if(input < 0 || fstat(input, &status) != 0){
+        fprintf(stderr, "erro: %s: %s\n", options.input, strerror(errno));
+        if(input >= 0)
+            close(input);
+        return EXIT_FAILURE;
+    }
+
+    // truncar a saída antes de ler a entrada apagaria o próprio arquivo lido
+    if(options.output != NULL && stat(options.output, &outputStatus) == 0
+            && outputStatus.st_dev == status.st_dev && outputStatus.st_ino == status.st_ino){
+        fprintf(stderr, "erro: %s: a saída não pode ser o arquivo de entrada\n", options.output);
+        close(input);
+        return EXIT_FAILURE;
+    }
+
+    if(status.st_size > 0){
+        data = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, input, 0);
+        if(data == MAP_FAILED){
+            fprintf(stderr, "erro: %s: %s\n", options.input, strerror(errno));
+            close(input);
+            return EXIT_FAILURE;
+        }
+        // o arquivo é lido uma única vez, do início ao fim
+        madvise((void*) data, (size_t) status.st_size, MADV_SEQUENTIAL);
+    }
+    close(input);
+
+    if(options.output != NULL){
+        output = open(options.output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(output < 0){
+            fprintf(stderr, "erro: %s: %s\n", options.output, strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    result = (data != NULL) ? convertFile(&options, data, (size_t) status.st_size, output)
+            : EXIT_SUCCESS;
+
+    if(data != NULL)
+        munmap((void*) data, (size_t) status.st_size);
+    if(options.output != NULL && close(output) != 0)
+        result = EXIT_FAILURE;
+    destroyTimeZone(zone);
+
+    return result;
+}
@@ -0,0 +1,589 @@
+/**
+ * \file bench.c
+ * Benchmark das funções públicas de date.h<BR>
+ * Para cada caso mede o tempo por operação, a vazão e, quando o kernel
+ * permite (perf_event_open), ciclos e instruções por operação. As funções
+ * de formatação e leitura são comparadas com strftime() e strptime() da
+ * glibc. O resultado é impresso na tela e gravado em um arquivo com colunas
+ * separadas por tabulação, que pode ser comparado entre versões<BR>
+ * Uso: bench [arquivo de saída]
+ */
+
+#define _GNU_SOURCE
+#include "../h_files/date.h"
+#include "../h_files/dateFormat.h"
+#include "../h_files/dateParse.h"
+#include "../h_files/dateWriter.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Tempo mínimo de cada medição em nanossegundos
+ */
+#define MIN_RUN_NANOSECONDS 200000000LL
+
+/**
+ * Quantidade de datas diferentes usadas como entrada (potência de 2)
+ */
+#define INPUT_COUNT 4096
+
+/**
+ * Arquivo de saída padrão
+ */
+#define DEFAULT_OUTPUT "bench_output.txt"
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Um caso de benchmark
+ */
+struct benchCase{
+    // nome do caso (sem espaços, usado no arquivo de saída)
+    const char* name;
+    // executa a operação a quantidade de vezes informada
+    void (*run)(size_t iterations);
+};
+
+/**
+ * Resultado de um caso
+ */
+struct benchResult{
+    // nanossegundos por operação
+    double nanoseconds;
+    // operações por segundo
+    double throughput;
+    // ciclos por operação (negativo se não disponível)
+    double cycles;
+    // instruções por operação (negativo se não disponível)
+    double instructions;
+};
+
+/**
+ * Contadores de hardware de um caso
+ */
+struct perfCounters{
+    // descritor do líder do grupo (ciclos), -1 se não disponível
+    int leader;
+    // descritor das instruções
+    int instructions;
+};
+
+/******************************************************************************
+ * Variáveis do módulo
+ ******************************************************************************/
+
+/**
+ * Datas de entrada em segundos desde 1970
+ */
+static time_t inputSeconds[INPUT_COUNT];
+
+/**
+ * Datas de entrada no formato DATE_DMY_HMS
+ */
+static char inputTexts[INPUT_COUNT][DATE_STRING_SIZE];
+
+/**
+ * Tamanho de cada texto de entrada
+ */
+static size_t inputLengths[INPUT_COUNT];
+
+/**
+ * Objeto Date usado pelos casos
+ */
+static Date* benchDate;
+
+/**
+ * Plano de formatação equivalente ao padrão de benchStrftime()
+ */
+static DateFormatPlan* benchPlan;
+
+/**
+ * Acumula resultados para que o compilador não descarte as operações
+ */
+static volatile long long sink;
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Lê o relógio monotônico
+ * \return Nanossegundos
+ */
+static long long nowNanoseconds(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Abre um contador de hardware
+ * \return Descritor do contador, ou -1 se não disponível
+ * \param config Evento (PERF_COUNT_HW_*)
+ * \param group Líder do grupo (-1 para criar um grupo novo)
+ */
+static int openCounter(unsigned long long config, int group){
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = (group == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/**
+ * Abre os contadores de ciclos e instruções
+ * \param counters Contadores a serem abertos
+ */
+static void openCounters(struct perfCounters* counters){
+    counters->instructions = -1;
+    counters->leader = openCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if(counters->leader < 0)
+        return;
+
+    counters->instructions = openCounter(PERF_COUNT_HW_INSTRUCTIONS, counters->leader);
+    if(counters->instructions < 0){
+        close(counters->leader);
+        counters->leader = -1;
+    }
+}
+
+/**
+ * Fecha os contadores de ciclos e instruções
+ * \param counters Contadores a serem fechados
+ */
+static void closeCounters(struct perfCounters* counters){
+    if(counters->leader < 0)
+        return;
+
+    close(counters->instructions);
+    close(counters->leader);
+}
+
+/**
+ * Lê os contadores do grupo
+ * \return false se a leitura falhar
+ * \param counters Contadores abertos
+ * \param cycles Ponteiro onde serão guardados os ciclos
+ * \param instructions Ponteiro onde serão guardadas as instruções
+ */
+static bool readCounters(const struct perfCounters* counters, unsigned long long* cycles,
+        unsigned long long* instructions){
+    // formato do grupo: quantidade de contadores seguida dos valores
+    unsigned long long values[3];
+
+    if(counters->leader < 0 || read(counters->leader, values, sizeof(values)) != sizeof(values))
+        return false;
+
+    *cycles = values[1];
+    *instructions = values[2];
+    return true;
+}
+
+/**
+ * Executa um caso, dobrando a quantidade de operações até que a medição
+ * dure pelo menos MIN_RUN_NANOSECONDS
+ * \param benchCase Caso a ser executado
+ * \param result Ponteiro onde será guardado o resultado
+ */
+static void runCase(const struct benchCase* benchCase, struct benchResult* result){
+    struct perfCounters counters;
+    unsigned long long cycles = 0, instructions = 0;
+    size_t iterations = 1024;
+    long long elapsed;
+
+    // aquece caches e preditores
+    benchCase->run(iterations);
+
+    for(;;){
+        elapsed = nowNanoseconds();
+        benchCase->run(iterations);
+        elapsed = nowNanoseconds() - elapsed;
+        if(elapsed >= MIN_RUN_NANOSECONDS / 4)
+            break;
+        iterations *= 2;
+    }
+
+    // medição final, com os contadores de hardware quando disponíveis
+    iterations = (size_t) ((double) iterations * MIN_RUN_NANOSECONDS / (double) elapsed) + 1;
+    openCounters(&counters);
+    if(counters.leader >= 0){
+        ioctl(counters.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(counters.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    elapsed = nowNanoseconds();
+    benchCase->run(iterations);
+    elapsed = nowNanoseconds() - elapsed;
+    if(counters.leader >= 0)
+        ioctl(counters.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    result->nanoseconds = (double) elapsed / (double) iterations;
+    result->throughput = 1e9 / result->nanoseconds;
+    result->cycles = -1;
+    result->instructions = -1;
+    if(readCounters(&counters, &cycles, &instructions)){
+        result->cycles = (double) cycles / (double) iterations;
+        result->instructions = (double) instructions / (double) iterations;
+    }
+    closeCounters(&counters);
+}
+
+/**
+ * Gera as datas de entrada (1970 - 2037, no fuso local)
+ */
+static void prepareInputs(void){
+    unsigned long long state = 88172645463325252ULL;
+    size_t i;
+
+    for(i = 0; i < INPUT_COUNT; i++){
+        // xorshift: sequência fixa para que as execuções sejam comparáveis
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        inputSeconds[i] = (time_t) (state % 2145916800ULL);
+
+        setDateOfSeconds(&benchDate, inputSeconds[i]);
+        getStringDate(&benchDate, DATE_DMY_HMS, false, inputTexts[i]);
+        inputLengths[i] = strlen(inputTexts[i]);
+    }
+}
+
+/*****************************************************************************
+ * Casos
+ *****************************************************************************/
+
+/**
+ * createDate() seguido de destroyDate()
+ * \param iterations Quantidade de operações
+ */
+static void benchCreateDate(size_t iterations){
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        Date* date = createDate();
+        sink += getDateInSeconds(&date);
+        destroyDate(date);
+    }
+}
+
+/**
+ * setDateToday()
+ * \param iterations Quantidade de operações
+ */
+static void benchSetDateToday(size_t iterations){
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        setDateToday(&benchDate);
+        sink += getDateInSeconds(&benchDate);
+    }
+}
+
+/**
+ * setDateComplete() com datas diferentes
+ * \param iterations Quantidade de operações
+ */
+static void benchSetDateComplete(size_t iterations){
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        sink += setDateComplete(&benchDate, (int) (i % 28) + 1, (int) (i % 12) + 1,
+                1970 + (int) (i % 67), (int) (i % 24), (int) (i % 60), (int) (i % 59));
+    }
+}
+
+/**
+ * getDateComponent() logo após mudar a data (decomposição completa)
+ * \param iterations Quantidade de operações
+ */
+static void benchGetDateComponent(size_t iterations){
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        setDateOfSeconds(&benchDate, inputSeconds[i & (INPUT_COUNT - 1)]);
+        sink += getDateComponent(&benchDate, YEAR);
+    }
+}
+
+/**
+ * getDateComponent() repetido na mesma data (componentes memorizados)
+ * \param iterations Quantidade de operações
+ */
+static void benchGetDateComponentCached(size_t iterations){
+    size_t i;
+    setDateOfSeconds(&benchDate, inputSeconds[0]);
+    for(i = 0; i < iterations; i++)
+        sink += getDateComponent(&benchDate, (enum DateComponent) (i % 9));
+}
+
+/**
+ * getStringDate() no formato DATE_DMY_HMS
+ * \param iterations Quantidade de operações
+ */
+static void benchGetStringDate(size_t iterations){
+    char text[DATE_STRING_SIZE];
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        setDateOfSeconds(&benchDate, inputSeconds[i & (INPUT_COUNT - 1)]);
+        getStringDate(&benchDate, DATE_DMY_HMS, false, text);
+        sink += text[0];
+    }
+}
+
+/**
+ * Referência: localtime_r() e strftime() no formato equivalente
+ * \param iterations Quantidade de operações
+ */
+static void benchStrftime(size_t iterations){
+    char text[DATE_STRING_SIZE];
+    struct tm civil;
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        localtime_r(&inputSeconds[i & (INPUT_COUNT - 1)], &civil);
+        strftime(text, sizeof(text), "%d/%m/%Y %H:%M:%S", &civil);
+        sink += text[0];
+    }
+}
+
+/**
+ * formatDatePlan() com o padrão de benchStrftime(), compilado uma única vez
+ * \param iterations Quantidade de operações
+ */
+static void benchFormatDatePlan(size_t iterations){
+    char text[DATE_STRING_SIZE];
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        setDateOfSeconds(&benchDate, inputSeconds[i & (INPUT_COUNT - 1)]);
+        formatDatePlan(benchPlan, &benchDate, text, sizeof(text));
+        sink += text[0];
+    }
+}
+
+/**
+ * formatSecondsCached() no formato DATE_DMY_HMS com datas crescentes, várias
+ * por segundo (como as linhas de um log)
+ * \param iterations Quantidade de operações
+ */
+static void benchFormatSecondsCached(size_t iterations){
+    char text[DATE_STRING_SIZE];
+    DateFormatCache cache;
+    size_t i;
+
+    startDateFormatCache(&cache, NULL, DATE_DMY_HMS, false);
+    for(i = 0; i < iterations; i++){
+        formatSecondsCached(&cache, inputSeconds[0] + (time_t) (i / 8), text, sizeof(text));
+        sink += text[0];
+    }
+}
+
+/**
+ * parseDateString() no formato DATE_DMY_HMS
+ * \param iterations Quantidade de operações
+ */
+static void benchParseDateString(size_t iterations){
+    time_t seconds = 0;
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        size_t index = i & (INPUT_COUNT - 1);
+        parseDateString(inputTexts[index], inputLengths[index], DATE_DMY_HMS, NULL, &seconds);
+        sink += seconds;
+    }
+}
+
+/**
+ * Referência: strptime() e mktime() no formato equivalente
+ * \param iterations Quantidade de operações
+ */
+static void benchStrptime(size_t iterations){
+    struct tm civil;
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        memset(&civil, 0, sizeof(civil));
+        strptime(inputTexts[i & (INPUT_COUNT - 1)], "%d/%m/%Y %H:%M:%S", &civil);
+        civil.tm_isdst = -1;
+        sink += mktime(&civil);
+    }
+}
+
+/**
+ * addComponentDate() somando um dia
+ * \param iterations Quantidade de operações
+ */
+static void benchAddComponentDate(size_t iterations){
+    size_t i;
+    setDateOfSeconds(&benchDate, inputSeconds[0]);
+    for(i = 0; i < iterations; i++){
+        // alterna soma e subtração para a data não sair da faixa
+        sink += addComponentDate(&benchDate, MDAY, 1, (i & 1) == 0);
+    }
+}
+
+/**
+ * addMonthsDate() somando um mês
+ * \param iterations Quantidade de operações
+ */
+static void benchAddMonthsDate(size_t iterations){
+    size_t i;
+    setDateOfSeconds(&benchDate, inputSeconds[0]);
+    for(i = 0; i < iterations; i++)
+        sink += addMonthsDate(&benchDate, (i & 1) ? -1 : 1, MONTH_CLAMP);
+}
+
+/**
+ * diffMonthsDate() entre datas diferentes
+ * \param iterations Quantidade de operações
+ */
+static void benchDiffMonthsDate(size_t iterations){
+    Date other;
+    Date* otherDate = &other;
+    size_t i;
+
+    initDate(&other);
+    for(i = 0; i < iterations; i++){
+        setDateOfSeconds(&benchDate, inputSeconds[i & (INPUT_COUNT - 1)]);
+        setDateOfSeconds(&otherDate, inputSeconds[(i + 1) & (INPUT_COUNT - 1)]);
+        sink += diffMonthsDate(&benchDate, &otherDate);
+    }
+}
+
+/**
+ * validateDate() com datas válidas e inválidas
+ * \param iterations Quantidade de operações
+ */
+static void benchValidateDate(size_t iterations){
+    size_t i;
+    for(i = 0; i < iterations; i++){
+        sink += validateDate((int) (i % 32), (int) (i % 13), 1900 + (int) (i % 200),
+                (int) (i % 24), (int) (i % 60), (int) (i % 60));
+    }
+}
+
+/**
+ * printDate() com a saída padrão redirecionada para /dev/null
+ * \param iterations Quantidade de operações
+ */
+static void benchPrintDate(size_t iterations){
+    int saved, null;
+    size_t i;
+
+    fflush(stdout);
+    saved = dup(STDOUT_FILENO);
+    null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+
+    for(i = 0; i < iterations; i++){
+        setDateOfSeconds(&benchDate, inputSeconds[i & (INPUT_COUNT - 1)]);
+        printDate(&benchDate, DATE_DMY_HMS, true);
+    }
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+/**
+ * writeDate() em um objeto de escrita ligado a /dev/null
+ * \param iterations Quantidade de operações
+ */
+static void benchWriteDate(size_t iterations){
+    int null = open("/dev/null", O_WRONLY);
+    DateWriter* writer = createDateWriterFd(null, 0);
+    size_t i;
+
+    for(i = 0; i < iterations; i++){
+        setDateOfSeconds(&benchDate, inputSeconds[i & (INPUT_COUNT - 1)]);
+        writeDate(writer, &benchDate, DATE_DMY_HMS, true);
+        writeDateText(writer, "\n", 1);
+    }
+
+    destroyDateWriter(writer);
+    close(null);
+}
+
+/**
+ * Todos os casos, na ordem em que são executados
+ */
+static const struct benchCase CASES[] = {
+    {"createDate", benchCreateDate},
+    {"setDateToday", benchSetDateToday},
+    {"setDateComplete", benchSetDateComplete},
+    {"getDateComponent", benchGetDateComponent},
+    {"getDateComponent_cached", benchGetDateComponentCached},
+    {"getStringDate", benchGetStringDate},
+    {"baseline_strftime", benchStrftime},
+    {"formatDatePlan", benchFormatDatePlan},
+    {"formatSecondsCached", benchFormatSecondsCached},
+    {"parseDateString", benchParseDateString},
+    {"baseline_strptime", benchStrptime},
+    {"addComponentDate", benchAddComponentDate},
+    {"addMonthsDate", benchAddMonthsDate},
+    {"diffMonthsDate", benchDiffMonthsDate},
+    {"validateDate", benchValidateDate},
+    {"printDate", benchPrintDate},
+    {"writeDate", benchWriteDate}
+};
+
+/****************************************************************************
+ * Função principal
+ ****************************************************************************/
+
+/**
+ * Executa todos os casos e grava o resultado
+ * \return 0 em caso de sucesso
+ * \param argc Quantidade de argumentos
+ * \param argv Argumentos (o primeiro, opcional, é o arquivo de saída)
+ */
+int main(int argc, char** argv){
+    const char* outputName = (argc > 1) ? argv[1] : DEFAULT_OUTPUT;
+    size_t caseCount = sizeof(CASES) / sizeof(CASES[0]);
+    FILE* output;
+    size_t i;
+
+    output = fopen(outputName, "w");
+    if(output == NULL){
+        fprintf(stderr, "bench: não foi possível criar %s\n", outputName);
+        return 1;
+    }
+
+    benchDate = createDate();
+    benchPlan = compileDateFormat("%d/%m/%Y %H:%M:%S");
+    prepareInputs();
+
+    fprintf(output, "name\tns_per_op\tops_per_sec\tcycles_per_op\tinstructions_per_op\n");
+    printf("%-26s %12s %14s %12s %12s\n", "caso", "ns/op", "op/s", "ciclos/op", "instr/op");
+
+    for(i = 0; i < caseCount; i++){
+        struct benchResult result;
+
+        runCase(&CASES[i], &result);
+
+        fprintf(output, "%s\t%.3f\t%.0f\t%.2f\t%.2f\n", CASES[i].name, result.nanoseconds,
+                result.throughput, result.cycles, result.instructions);
+        if(result.cycles >= 0)
+            printf("%-26s %12.2f %14.0f %12.1f %12.1f\n", CASES[i].name, result.nanoseconds,
+                    result.throughput, result.cycles, result.instructions);
+        else
+            printf("%-26s %12.2f %14.0f %12s %12s\n", CASES[i].name, result.nanoseconds,
+                    result.throughput, "-", "-");
+        fflush(stdout);
+    }
+
+    destroyDate(benchDate);
+    destroyDateFormatPlan(benchPlan);
+    fclose(output);
+    printf("resultado gravado em %s\n", outputName);
+
+    return 0;
+}
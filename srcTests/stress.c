@@ -0,0 +1,300 @@
+/**
+ * \file stress.c
+ * Teste de estresse da API reentrante de date.h<BR>
+ * Executa as mesmas operações (decomposição, formatação, leitura e
+ * aritmética de calendário) em 1, 2, 4 ... threads, cada uma com os seus
+ * próprios objetos Date, todas no fuso local e em um fuso carregado
+ * compartilhado. Os resultados de cada thread são comparados com os de uma
+ * execução em uma única thread, e a vazão de cada quantidade de threads é
+ * impressa com a eficiência em relação à escala linear<BR>
+ * Uso: stress [threads] (padrão: número de processadores; a saída é 0 se
+ * todos os resultados conferirem)
+ */
+
+#include "../h_files/date.h"
+#include "../h_files/dateFormat.h"
+#include "../h_files/dateParse.h"
+#include "../h_files/dateZone.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/******************************************************************************
+ * Constantes
+ ******************************************************************************/
+
+/**
+ * Quantidade de datas diferentes usadas como entrada
+ */
+#define INPUT_COUNT 4096
+
+/**
+ * Quantas vezes cada thread percorre as entradas
+ */
+#define ROUNDS 64
+
+/**
+ * Quantidade máxima de threads
+ */
+#define MAX_THREADS 256
+
+/**
+ * Fuso carregado compartilhado entre as threads
+ */
+#define SHARED_ZONE "America/Sao_Paulo"
+
+/******************************************************************************
+ * Estruturas
+ ******************************************************************************/
+
+/**
+ * Trabalho de uma thread
+ */
+struct worker{
+    pthread_t thread;
+    // posição da thread (define a primeira entrada percorrida)
+    size_t index;
+    // quantidade de resultados diferentes da execução de referência
+    size_t mismatches;
+};
+
+/******************************************************************************
+ * Variáveis
+ ******************************************************************************/
+
+/**
+ * Datas de entrada em segundos desde 1970
+ */
+static time_t inputSeconds[INPUT_COUNT];
+
+/**
+ * Resultado de referência de cada entrada, calculado em uma única thread
+ */
+static unsigned long long expected[INPUT_COUNT];
+
+/**
+ * Fuso carregado compartilhado (NULL se não estiver disponível)
+ */
+static const TimeZone* sharedZone;
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Lê o relógio monotônico
+ * \return Nanossegundos
+ */
+static long long nowNanoseconds(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Mistura um valor em um resumo (FNV-1a de 64 bits)
+ * \return Novo resumo
+ * \param hash Resumo atual
+ * \param value Valor a ser misturado
+ */
+static unsigned long long mix(unsigned long long hash, long long value){
+    return (hash ^ (unsigned long long) value) * 1099511628211ULL;
+}
+
+/**
+ * Executa as operações sobre uma data e resume os resultados
+ * \return Resumo dos resultados
+ * \param date Ponteiro para objeto Date da thread
+ * \param other Ponteiro para outro objeto Date da thread
+ * \param seconds Data em segundos desde 1970
+ */
+static unsigned long long runOperations(Date** date, Date** other, time_t seconds){
+    unsigned long long hash = 14695981039346656037ULL;
+    char text[DATE_STRING_SIZE];
+    time_t parsed;
+    int zoneIndex;
+
+    for(zoneIndex = 0; zoneIndex < 2; zoneIndex++){
+        const TimeZone* zone = (zoneIndex == 0) ? NULL : sharedZone;
+
+        setDateTimeZone(date, zone);
+        setDateTimeZone(other, zone);
+        setDateOfSeconds(date, seconds);
+
+        // decomposição
+        hash = mix(hash, getDateComponent(date, YEAR));
+        hash = mix(hash, getDateComponent(date, MONTH));
+        hash = mix(hash, getDateComponent(date, MDAY));
+        hash = mix(hash, getDateComponent(date, WDAY));
+        hash = mix(hash, getDateComponent(date, HOUR));
+        hash = mix(hash, getDateComponent(date, SECOND));
+
+        // formatação e leitura de volta
+        if(!getStringDate(date, DATE_YMD_HMS, true, text)
+                || !parseDateString(text, strlen(text), DATE_YMD_HMS, zone, &parsed))
+            parsed = -1;
+        hash = mix(hash, (long long) parsed);
+
+        // aritmética de calendário
+        setDateOfSeconds(other, seconds);
+        addMonthsDate(other, 13, MONTH_CLAMP);
+        addDaysDate(other, -45);
+        hash = mix(hash, (long long) getDateInSeconds(other));
+        hash = mix(hash, diffDaysDate(date, other));
+        hash = mix(hash, diffMonthsDate(date, other));
+    }
+
+    return hash;
+}
+
+/**
+ * Gera as datas de entrada (1970 - 2037)
+ */
+static void prepareInputs(void){
+    unsigned long long state = 88172645463325252ULL;
+    size_t i;
+
+    for(i = 0; i < INPUT_COUNT; i++){
+        // xorshift: sequência fixa para que as execuções sejam comparáveis
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        inputSeconds[i] = (time_t) (state % 2145916800ULL);
+    }
+}
+
+/**
+ * Calcula os resultados de referência em uma única thread
+ */
+static void prepareExpected(void){
+    Date dateValue, otherValue;
+    Date* date = &dateValue;
+    Date* other = &otherValue;
+    size_t i;
+
+    initDate(date);
+    initDate(other);
+    for(i = 0; i < INPUT_COUNT; i++)
+        expected[i] = runOperations(&date, &other, inputSeconds[i]);
+}
+
+/**
+ * Função de cada thread: percorre as entradas ROUNDS vezes, começando em
+ * uma posição diferente das outras threads
+ * \return NULL
+ * \param argument Ponteiro para struct worker
+ */
+static void* runWorker(void* argument){
+    struct worker* worker = argument;
+    Date dateValue, otherValue;
+    Date* date = &dateValue;
+    Date* other = &otherValue;
+    size_t start = (worker->index * 997) % INPUT_COUNT;
+    size_t round, i;
+
+    initDate(date);
+    initDate(other);
+    for(round = 0; round < ROUNDS; round++){
+        for(i = 0; i < INPUT_COUNT; i++){
+            size_t index = (start + i) % INPUT_COUNT;
+            if(runOperations(&date, &other, inputSeconds[index]) != expected[index])
+                worker->mismatches++;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Executa o teste com uma quantidade de threads
+ * \return Operações por segundo (negativo se não conseguir criar as threads)
+ * \param threads Quantidade de threads
+ * \param mismatches Ponteiro onde será somada a quantidade de resultados
+ *      diferentes da referência
+ */
+static double runThreads(size_t threads, size_t* mismatches){
+    struct worker workers[MAX_THREADS];
+    long long start, elapsed;
+    size_t created, i;
+
+    memset(workers, 0, sizeof(workers));
+    start = nowNanoseconds();
+    for(created = 0; created < threads; created++){
+        workers[created].index = created;
+        if(pthread_create(&workers[created].thread, NULL, runWorker, &workers[created]) != 0)
+            break;
+    }
+    for(i = 0; i < created; i++){
+        pthread_join(workers[i].thread, NULL);
+        *mismatches += workers[i].mismatches;
+    }
+    elapsed = nowNanoseconds() - start;
+
+    if(created < threads)
+        return -1;
+
+    return (double) threads * ROUNDS * INPUT_COUNT * 1e9 / (double) elapsed;
+}
+
+/****************************************************************************
+ * Função principal
+ ****************************************************************************/
+
+/**
+ * Executa o teste com 1, 2, 4 ... threads até o máximo
+ * \return 0 se todos os resultados conferirem
+ * \param argc Quantidade de argumentos
+ * \param argv Argumentos (o primeiro, opcional, é a quantidade máxima de
+ *      threads)
+ */
+int main(int argc, char** argv){
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t maxThreads = (argc > 1) ? (size_t) strtoul(argv[1], NULL, 10)
+            : (processors > 0) ? (size_t) processors : 1;
+    TimeZone* zone = loadTimeZone(SHARED_ZONE);
+    size_t mismatches = 0;
+    double single = 0;
+    size_t threads;
+
+    if(maxThreads == 0)
+        maxThreads = 1;
+    if(maxThreads > MAX_THREADS)
+        maxThreads = MAX_THREADS;
+    if(zone == NULL)
+        fprintf(stderr, "stress: fuso %s indisponível, usando só o fuso local\n", SHARED_ZONE);
+    sharedZone = zone;
+
+    prepareInputs();
+    prepareExpected();
+
+    printf("%8s %14s %14s %11s\n", "threads", "op/s", "op/s/thread", "eficiência");
+    for(threads = 1; threads <= maxThreads; threads *= 2){
+        double throughput;
+
+        // a última medição usa todas as threads, mesmo fora das potências de 2
+        if(threads * 2 > maxThreads)
+            threads = maxThreads;
+        throughput = runThreads(threads, &mismatches);
+
+        if(throughput < 0){
+            fprintf(stderr, "stress: não foi possível criar %zu threads\n", threads);
+            destroyTimeZone(zone);
+            return 1;
+        }
+        if(threads == 1)
+            single = throughput;
+        printf("%8zu %14.0f %14.0f %10.1f%%\n", threads, throughput,
+                throughput / (double) threads,
+                100.0 * throughput / ((double) threads * single));
+        fflush(stdout);
+    }
+
+    destroyTimeZone(zone);
+
+    if(mismatches > 0){
+        fprintf(stderr, "stress: %zu resultados diferentes da execução em uma thread\n",
+                mismatches);
+        return 1;
+    }
+    printf("stress: ok\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * \file testPacked.c
+ * Teste de ida e volta das codificações compactas de datePacked.h<BR>
+ * Codifica e decodifica datas de toda a faixa suportada, inclusive
+ * anteriores a 1970, e confere que os segundos voltam iguais<BR>
+ * Uso: testPacked (a saída é 0 se todas as verificações passarem)
+ */
+
+#include "../h_files/date.h"
+#include "../h_files/datePacked.h"
+
+/******************************************************************************
+ * Variáveis
+ ******************************************************************************/
+
+/**
+ * Quantidade de verificações que falharam
+ */
+static int failures;
+
+/*****************************************************************************
+ * Funções privadas
+ *****************************************************************************/
+
+/**
+ * Registra o resultado de uma verificação
+ * \param ok Resultado da verificação
+ * \param what Descrição da verificação
+ * \param seconds Data verificada em segundos desde 1970
+ */
+static void check(bool ok, const char* what, long long seconds){
+    if(!ok){
+        fprintf(stderr, "falhou: %s (%lld)\n", what, seconds);
+        failures++;
+    }
+}
+
+/**
+ * Confere a ida e volta de um objeto Date pelas duas codificações de 64 bits
+ * \param day Dia
+ * \param month Mês
+ * \param year Ano
+ */
+static void checkDate(int day, int month, int year){
+    Date value;
+    Date* date = &value;
+    Date restoredValue;
+    Date* restored = &restoredValue;
+    PackedDateTime dateTime;
+    PackedCivil civil;
+    time_t seconds;
+
+    initDate(date);
+    initDate(restored);
+    if(!setDateComplete(&date, day, month, year, 13, 45, 30)){
+        check(false, "setDateComplete", 0);
+        return;
+    }
+    seconds = getDateInSeconds(&date);
+
+    check(packDateTime(&date, &dateTime), "packDateTime", (long long) seconds);
+    check(unpackDateTime(&restored, dateTime), "unpackDateTime", (long long) seconds);
+    check(getDateInSeconds(&restored) == seconds, "ida e volta de PackedDateTime",
+            (long long) seconds);
+
+    initDate(restored);
+    check(packDateCivil(&date, &civil), "packDateCivil", (long long) seconds);
+    check(unpackDateCivil(&restored, civil), "unpackDateCivil", (long long) seconds);
+    check(getDateInSeconds(&restored) == seconds, "ida e volta de PackedCivil",
+            (long long) seconds);
+}
+
+/**
+ * Confere a ida e volta dos vetores nos extremos da faixa suportada
+ */
+static void checkBatchLimits(void){
+    const time_t seconds[] = {(time_t) PACKED_MIN_SECONDS, (time_t) PACKED_MIN_SECONDS + 1,
+        -86401, -86400, -1, 0, 1, 86399, 86400, (time_t) PACKED_MAX_SECONDS};
+    size_t count = sizeof(seconds) / sizeof(seconds[0]);
+    PackedDateTime dateTimes[sizeof(seconds) / sizeof(seconds[0])];
+    PackedCivil civils[sizeof(seconds) / sizeof(seconds[0])];
+    time_t restored[sizeof(seconds) / sizeof(seconds[0])];
+    size_t i;
+
+    check(packDateTimesBatch(seconds, count, dateTimes), "packDateTimesBatch", 0);
+    check(unpackDateTimesBatch(dateTimes, count, restored), "unpackDateTimesBatch", 0);
+    for(i = 0; i < count; i++)
+        check(restored[i] == seconds[i], "ida e volta em lote de PackedDateTime",
+                (long long) seconds[i]);
+
+    check(packCivilBatch(seconds, count, civils), "packCivilBatch", 0);
+    check(unpackCivilBatch(civils, count, restored), "unpackCivilBatch", 0);
+    for(i = 0; i < count; i++){
+        check(restored[i] == seconds[i], "ida e volta em lote de PackedCivil",
+                (long long) seconds[i]);
+        // os valores inteiros ordenam as datas
+        if(i > 0)
+            check(civils[i - 1] < civils[i], "ordem de PackedCivil", (long long) seconds[i]);
+    }
+}
+
+/****************************************************************************
+ * Função principal
+ ****************************************************************************/
+
+/**
+ * Executa as verificações
+ * \return 0 se todas passarem
+ */
+int main(void){
+    checkDate(15, 6, 1960);
+    checkDate(1, 1, 1900);
+    checkDate(31, 12, 1969);
+    checkDate(1, 1, 1970);
+    checkDate(29, 2, 2024);
+    checkBatchLimits();
+
+    if(failures > 0){
+        fprintf(stderr, "testPacked: %d verificações falharam\n", failures);
+        return 1;
+    }
+    printf("testPacked: ok\n");
+    return 0;
+}